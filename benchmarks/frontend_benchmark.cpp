@@ -0,0 +1,162 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+#include "vypcomp/parser/indexdriver.h"
+#include "vypcomp/parser/parser.h"
+
+#include "synthetic.h"
+
+using namespace vypcomp;
+
+// ------------------------------
+// Allocation tracking
+// ------------------------------
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> liveBytes{0};
+std::atomic<std::size_t> peakBytes{0};
+
+// Size of each block is stored in front of it so that live heap
+// can be tracked.
+constexpr std::size_t HeaderSize = alignof(std::max_align_t);
+
+void* trackedAlloc(std::size_t size)
+{
+	auto block = static_cast<char*>(std::malloc(size + HeaderSize));
+	if (block == nullptr)
+		throw std::bad_alloc();
+
+	*reinterpret_cast<std::size_t*>(block) = size;
+	allocations++;
+	auto live = liveBytes += size;
+	auto peak = peakBytes.load();
+	while (live > peak && !peakBytes.compare_exchange_weak(peak, live));
+
+	return block + HeaderSize;
+}
+
+void trackedFree(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	auto block = static_cast<char*>(ptr) - HeaderSize;
+	liveBytes -= *reinterpret_cast<std::size_t*>(block);
+	std::free(block);
+}
+
+long peakRssKb()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+}
+
+void* operator new(std::size_t size) { return trackedAlloc(size); }
+void* operator new[](std::size_t size) { return trackedAlloc(size); }
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { trackedFree(ptr); }
+
+// ------------------------------
+// Benchmarks
+// ------------------------------
+
+/**
+ * Runs index and full parser run on synthetic input. First argument
+ * is number of generated functions, second selects IR storage
+ * (0 - heap allocated nodes, 1 - arena).
+ *
+ * Peak RSS is process-wide, run single configuration using
+ * --benchmark_filter to compare it.
+ */
+static void BM_Frontend(benchmark::State& state)
+{
+	auto source = syntheticProgram(state.range(0));
+	bool useArena = state.range(1);
+
+	std::size_t allocs = 0;
+	std::size_t peak = 0;
+	for (auto _ : state) {
+		std::istringstream indexInput(source);
+		std::istringstream input(source);
+
+		allocations = 0;
+		peakBytes = liveBytes.load();
+		auto base = liveBytes.load();
+		{
+			ir::Arena::Ptr arena = useArena ? std::make_shared<ir::Arena>() : nullptr;
+			IndexParserDriver index(arena);
+			index.parse(indexInput);
+			ParserDriver parser(index.table());
+			parser.parse(input);
+		}
+		allocs = allocations;
+		peak = peakBytes - base;
+	}
+
+	state.counters["allocations"] = allocs;
+	state.counters["peak_heap_kb"] = peak / 1024;
+	state.counters["peak_rss_kb"] = peakRssKb();
+	state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+BENCHMARK(BM_Frontend)
+	->ArgsProduct({{100, 1000}, {0, 1}})
+	->Unit(benchmark::kMillisecond);
+
+/**
+ * Scans synthetic program stored in a file into token buffer. First
+ * argument is number of generated functions, second selects how the
+ * file is read (0 - read through stream, 1 - mapped into memory).
+ * Throughput is reported as bytes per second.
+ */
+static void BM_Scanner(benchmark::State& state)
+{
+	auto source = syntheticProgram(state.range(0));
+	bool mapped = state.range(1);
+
+	auto path = std::filesystem::temp_directory_path() / "vypcomp_scanner_benchmark.vl";
+	std::ofstream(path) << source;
+
+	std::size_t tokens = 0;
+	for (auto _ : state) {
+		TokenBuffer buffer;
+		if (mapped) {
+			buffer = Scanner::scanAll(Source::map(path.string()));
+		}
+		else {
+			std::ifstream input(path);
+			buffer = Scanner::scanAll(input);
+		}
+		tokens = buffer.tokens().size();
+		benchmark::DoNotOptimize(buffer);
+	}
+	std::remove(path.string().c_str());
+
+	state.counters["tokens"] = tokens;
+	state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+BENCHMARK(BM_Scanner)
+	->ArgsProduct({{100, 1000}, {0, 1}})
+	->Unit(benchmark::kMillisecond);
@@ -0,0 +1,71 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+
+#include "vypcomp/generator/generator.h"
+#include "vypcomp/parser/indexdriver.h"
+#include "vypcomp/parser/parser.h"
+
+#include "synthetic.h"
+
+using namespace vypcomp;
+
+/**
+ * Generates VYPcode from IR of synthetic input. Argument is number
+ * of generated functions. Parsing is not part of measured time.
+ */
+static void BM_Codegen(benchmark::State& state)
+{
+	auto source = syntheticProgram(state.range(0));
+	std::istringstream indexInput(source);
+	std::istringstream input(source);
+
+	IndexParserDriver index;
+	index.parse(indexInput);
+	ParserDriver parser(index.table());
+	parser.parse(input);
+
+	for (auto _ : state) {
+		Generator generator(std::make_unique<std::ostringstream>(), false);
+		generator.generate(parser.table());
+		benchmark::DoNotOptimize(generator.get_output());
+	}
+}
+
+BENCHMARK(BM_Codegen)
+	->Arg(100)
+	->Arg(1000)
+	->Unit(benchmark::kMillisecond);
+
+/**
+ * Generates VYPcode of program with deeply nested expressions.
+ * Argument is number of operations in each expression.
+ */
+static void BM_CodegenNestedExpressions(benchmark::State& state)
+{
+	auto source = nestedExpressionProgram(state.range(0));
+	std::istringstream indexInput(source);
+	std::istringstream input(source);
+
+	IndexParserDriver index;
+	index.parse(indexInput);
+	ParserDriver parser(index.table());
+	parser.parse(input);
+
+	for (auto _ : state) {
+		Generator generator(std::make_unique<std::ostringstream>(), false);
+		generator.generate(parser.table());
+		benchmark::DoNotOptimize(generator.get_output());
+	}
+}
+
+BENCHMARK(BM_CodegenNestedExpressions)
+	->Arg(100)
+	->Arg(1000)
+	->Arg(4000)
+	->Unit(benchmark::kMillisecond);
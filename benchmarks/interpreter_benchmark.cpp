@@ -0,0 +1,95 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+
+#include "vypcomp/generator/generator.h"
+#include "vypcomp/interpreter/interpreter.h"
+#include "vypcomp/interpreter/program.h"
+#include "vypcomp/parser/indexdriver.h"
+#include "vypcomp/parser/parser.h"
+
+#include "synthetic.h"
+
+using namespace vypcomp;
+
+/**
+ * Executes VYPcode generated for synthetic input. Argument is number
+ * of generated functions. Compilation and loading of the program is
+ * not part of measured time.
+ */
+static void BM_Interpret(benchmark::State& state)
+{
+	auto source = syntheticProgram(state.range(0));
+	std::istringstream indexInput(source);
+	std::istringstream input(source);
+
+	IndexParserDriver index;
+	index.parse(indexInput);
+	ParserDriver parser(index.table());
+	parser.parse(input);
+
+	Generator generator(std::make_unique<std::ostringstream>(), false);
+	generator.generate(parser.table());
+	std::istringstream code(static_cast<const std::ostringstream&>(generator.get_output()).str());
+	auto program = vypcode::Program::load(code);
+
+	std::uint64_t executed = 0;
+	for (auto _ : state) {
+		std::istringstream programInput;
+		std::ostringstream programOutput;
+		vypcode::Interpreter interpreter(program, programInput, programOutput);
+		interpreter.run();
+		executed += interpreter.executed();
+		benchmark::DoNotOptimize(programOutput);
+	}
+
+	state.counters["instructions"] = benchmark::Counter(executed, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_Interpret)
+	->Arg(100)
+	->Arg(1000)
+	->Unit(benchmark::kMillisecond);
+
+/**
+ * Executes VYPcode of program working with strings. Argument is
+ * length of the built string.
+ */
+static void BM_InterpretStrings(benchmark::State& state)
+{
+	auto source = stringProgram(state.range(0));
+	std::istringstream indexInput(source);
+	std::istringstream input(source);
+
+	IndexParserDriver index;
+	index.parse(indexInput);
+	ParserDriver parser(index.table());
+	parser.parse(input);
+
+	Generator generator(std::make_unique<std::ostringstream>(), false);
+	generator.generate(parser.table());
+	std::istringstream code(static_cast<const std::ostringstream&>(generator.get_output()).str());
+	auto program = vypcode::Program::load(code);
+
+	std::uint64_t executed = 0;
+	for (auto _ : state) {
+		std::istringstream programInput;
+		std::ostringstream programOutput;
+		vypcode::Interpreter interpreter(program, programInput, programOutput);
+		interpreter.run();
+		executed = interpreter.executed();
+		benchmark::DoNotOptimize(programOutput);
+	}
+
+	state.counters["instructions"] = executed;
+}
+
+BENCHMARK(BM_InterpretStrings)
+	->Arg(1000)
+	->Arg(4000)
+	->Unit(benchmark::kMillisecond);
@@ -0,0 +1,52 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "vypcomp/ir/instructions.h"
+
+using namespace vypcomp;
+
+/**
+ * Looks up every method of class hierarchy from its most derived
+ * class. First argument is depth of hierarchy, each class declares
+ * 16 methods. Second argument selects whether method tables are
+ * resolved (1) or methods are searched class by class (0).
+ */
+static void BM_MethodLookup(benchmark::State& state)
+{
+	std::size_t depth = state.range(0);
+	bool resolved = state.range(1);
+
+	std::vector<ir::Name> names;
+	ir::Class::Ptr cl = nullptr;
+	for (std::size_t i = 0; i < depth; i++) {
+		auto name = "C" + std::to_string(i);
+		cl = std::make_shared<ir::Class>(name, cl);
+		for (std::size_t m = 0; m < 16; m++) {
+			auto method = name + "m" + std::to_string(m);
+			cl->add(std::make_shared<ir::Function>(ir::Function::Signature{
+				std::nullopt, method, {{ir::Datatype(name), "this"}}
+			}), m % 2 ? ir::Class::Visibility::Public : ir::Class::Visibility::Protected);
+			names.push_back(method);
+		}
+
+		if (resolved)
+			cl->resolveMethods();
+	}
+
+	for (auto _ : state) {
+		for (const auto& name: names)
+			benchmark::DoNotOptimize(cl->getMethod(name, ir::Class::Visibility::Private));
+	}
+
+	state.SetItemsProcessed(state.iterations() * names.size());
+}
+
+BENCHMARK(BM_MethodLookup)
+	->ArgsProduct({{1, 4, 16}, {0, 1}});
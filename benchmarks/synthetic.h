@@ -0,0 +1,111 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <sstream>
+#include <string>
+
+/**
+ * Generates program with given number of classes and functions
+ * exercising expressions, loops, branches and method calls.
+ */
+inline std::string syntheticProgram(std::size_t functions)
+{
+	std::ostringstream out;
+	for (std::size_t i = 0; i < functions; i++) {
+		out << "class C" << i << " : Object {\n"
+		    << "\tint a, b;\n"
+		    << "\tstring s;\n"
+		    << "\tint sum(int x) { return this.a + this.b * x - (x / 3); }\n"
+		    << "\tstring toString(void) { return this.s + (string)(this.sum(2)); }\n"
+		    << "}\n";
+
+		out << "int f" << i << "(int n, string s) {\n"
+		    << "\tint i, acc;\n"
+		    << "\tC" << i << " c;\n"
+		    << "\tc = new C" << i << ";\n"
+		    << "\ti = 0;\n"
+		    << "\twhile (i < n) {\n"
+		    << "\t\tif (i == 2 || (acc > 10 && !(i != 5))) {\n"
+		    << "\t\t\tacc = acc + c.sum(i) * 2;\n"
+		    << "\t\t} else {\n"
+		    << "\t\t\tacc = acc - 1;\n"
+		    << "\t\t}\n"
+		    << "\t\ts = s + (string)(i * 2) + \"x\";\n"
+		    << "\t\ti = i + 1;\n"
+		    << "\t}\n"
+		    << "\treturn acc + length(s);\n"
+		    << "}\n";
+	}
+
+	out << "void main(void) {\n";
+	for (std::size_t i = 0; i < functions; i++)
+		out << "\tprint(f" << i << "(10, \"a\"));\n";
+	out << "}\n";
+
+	return out.str();
+}
+
+/**
+ * Generates program in style of expression_megatest.vl whose
+ * statements are single expressions with given number of operations
+ * nested into each other.
+ */
+inline std::string nestedExpressionProgram(std::size_t depth)
+{
+	static const char* operations[] = {" + x", " * 3", " - y", " * (x - 1)", " + 7"};
+
+	std::ostringstream out;
+	out << "int f(int a) { return a + 1; }\n"
+	    << "void main(void) {\n"
+	    << "\tint x, y;\n"
+	    << "\tx = 1; y = 2;\n";
+
+	out << "\tx = x";
+	for (std::size_t i = 0; i < depth; i++)
+		out << operations[i % 5];
+	out << ";\n";
+
+	out << "\tif (";
+	for (std::size_t i = 0; i < depth; i++)
+		out << "(y" << operations[i % 5] << " + ";
+	out << "x" << std::string(depth, ')') << " > 0) { print(x); }\n";
+
+	out << "\tprint(x";
+	for (std::size_t i = 0; i < depth; i++)
+		out << " + f(y" << operations[i % 5] << ")";
+	out << ");\n"
+	    << "}\n";
+
+	return out.str();
+}
+
+/**
+ * Generates program building string of given length by repeated
+ * concatenation and taking substrings of it.
+ */
+inline std::string stringProgram(std::size_t length)
+{
+	std::ostringstream out;
+	out << "void main(void) {\n"
+	    << "\tstring s, t;\n"
+	    << "\tint i;\n"
+	    << "\ti = 0;\n"
+	    << "\twhile (i < " << length / 2 << ") {\n"
+	    << "\t\ts = s + \"ab\";\n"
+	    << "\t\ti = i + 1;\n"
+	    << "\t}\n"
+	    << "\ti = 1;\n"
+	    << "\twhile (i < " << length << ") {\n"
+	    << "\t\tt = subStr(s, i, 32) + t;\n"
+	    << "\t\tt = subStr(t, 1, 64);\n"
+	    << "\t\ti = i + 1;\n"
+	    << "\t}\n"
+	    << "\tprint(length(s), t);\n"
+	    << "}\n";
+
+	return out.str();
+}
@@ -0,0 +1,38 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vypcomp {
+
+/**
+ * Compiles single input of the batch. Debug output goes to out, error
+ * messages to err. Returns exit code of the compilation.
+ */
+using BatchCompiler = std::function<int(const std::string& input, std::ostream& out, std::ostream& err)>;
+
+/**
+ * Reads inputs listed in manifest, one per line. Empty lines
+ * and lines starting with '#' are skipped.
+ */
+std::vector<std::string> readManifest(const std::string& path);
+
+/**
+ * Compiles all inputs on worker threads, jobs limits number of threads,
+ * 0 uses all hardware threads. Output of every input is printed in order
+ * of inputs followed by its exit code, every line of its error messages
+ * is prefixed by the input. Returns exit code of the first input that
+ * failed.
+ */
+int compileBatch(const std::vector<std::string>& inputs, std::size_t jobs, const BatchCompiler& compile,
+		std::ostream& out, std::ostream& err);
+
+}
@@ -0,0 +1,66 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace vypcomp {
+
+/**
+ * On-disk cache of generated VYPcode.
+ *
+ * Entries are keyed by hash of the source and of the compiler
+ * configuration, which has to identify the compiler binary and all
+ * options affecting generated code. Entries are written to temporary
+ * file unique to the process and thread and renamed, so that concurrent
+ * compilers never read partial entry. When the cache grows over its
+ * limit, least recently used entries are removed. Temporaries left by
+ * compilers that crashed while storing are removed once they are stale.
+ */
+class Cache {
+public:
+	Cache(const std::filesystem::path& directory, std::uintmax_t limit, const std::string& configuration);
+
+	std::string key(std::string_view source) const;
+
+	std::optional<std::string> load(const std::string& key);
+	void store(const std::string& key, const std::string& code);
+
+	std::size_t hits() const;
+	std::size_t misses() const;
+	/// Total size of entries in the cache.
+	std::uintmax_t bytes() const;
+
+	void report(std::ostream& out) const;
+
+	/**
+	 * Hash of the file contents as hexadecimal string.
+	 */
+	static std::string hashFile(const std::filesystem::path& path);
+
+private:
+	std::filesystem::path entry(const std::string& key) const;
+	void evict();
+
+private:
+	std::filesystem::path _directory;
+	std::uintmax_t _limit;
+	std::string _configuration;
+
+	std::atomic<std::size_t> _hits = 0;
+	std::atomic<std::size_t> _misses = 0;
+	std::atomic<std::size_t> _temporaries = 0;
+	std::mutex _evictionMutex;
+};
+
+}
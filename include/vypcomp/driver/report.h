@@ -0,0 +1,69 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vypcomp {
+
+/**
+ * Wall time, CPU time, allocations and peak resident set size of
+ * compilation phases.
+ *
+ * Allocations are counted by replaced global operator new for the
+ * whole process, CPU time is time of the whole process, so phases
+ * running in parallel with other work are not measured precisely.
+ */
+class TimeReport {
+public:
+	struct Measurement {
+		std::string name;
+		double wall = 0.0;
+		double cpu = 0.0;
+		std::size_t allocations = 0;
+		std::size_t allocatedBytes = 0;
+		/// Peak resident set size of the process at the end of phase in KiB.
+		long peakRss = 0;
+	};
+
+	/**
+	 * Measures phase for lifetime of the object.
+	 */
+	class Phase {
+	public:
+		Phase(TimeReport* report, const std::string& name);
+		~Phase();
+
+		Phase(const Phase&) = delete;
+		Phase& operator=(const Phase&) = delete;
+
+	private:
+		TimeReport* _report;
+		Measurement _start;
+		std::chrono::steady_clock::time_point _wallStart;
+		std::clock_t _cpuStart;
+	};
+
+	const std::vector<Measurement>& phases() const;
+	Measurement total() const;
+
+	void print(std::ostream& out) const;
+	void printJson(std::ostream& out) const;
+
+	static std::size_t allocations();
+	static std::size_t allocatedBytes();
+	static long peakRss();
+
+private:
+	std::vector<Measurement> _phases;
+};
+
+}
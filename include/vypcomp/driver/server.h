@@ -0,0 +1,94 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace vypcomp {
+
+/**
+ * Serves compilation requests on unix domain socket.
+ *
+ * Every connection carries single request. Client sends source of the
+ * program and shuts down its side of the connection. Server replies
+ * with exit code of the compilation on the first line followed by
+ * generated VYPcode or by the error message, then closes the
+ * connection. Exit codes are the same as of the command line compiler.
+ *
+ * Connections are served concurrently by fixed number of threads,
+ * further connections wait until one of them is free.
+ *
+ * Memory left behind by requests, such as names interned for the whole
+ * process (see ir::Name), is bounded by the exhausted predicate. When
+ * it is given, connections are served by worker process that stops
+ * accepting once the predicate holds, finishes accepted connections
+ * and is replaced by a fresh one. Connections arriving meanwhile wait
+ * in the backlog of the socket.
+ */
+class Server {
+public:
+	/**
+	 * Compiles source, writes generated code or error message and
+	 * returns exit code.
+	 */
+	using Handler = std::function<int(const std::string& source, std::ostream& code, std::ostream& errors)>;
+	/**
+	 * Tells whether the worker process should be replaced, checked
+	 * after every served connection.
+	 */
+	using Exhausted = std::function<bool()>;
+
+	/**
+	 * Serves at most threads connections at once, 0 means number of
+	 * hardware threads.
+	 */
+	Server(const std::string& path, Handler handler, std::size_t threads = 0, Exhausted exhausted = nullptr);
+	~Server();
+
+	Server(const Server&) = delete;
+	Server& operator=(const Server&) = delete;
+
+	/**
+	 * Accepts connections until the process is terminated or the
+	 * server is stopped.
+	 */
+	void run();
+
+	/**
+	 * Makes run return. Connections accepted before are still served
+	 * before run returns.
+	 */
+	void stop();
+
+private:
+	void acceptConnections();
+	void serveConnections();
+	void serve(int connection) const;
+
+private:
+	std::string _path;
+	Handler _handler;
+	std::size_t _threads;
+	Exhausted _exhausted;
+	int _socket = -1;
+	std::atomic<bool> _stopped = false;
+
+	// accepted connections waiting for serving thread
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::deque<int> _pending;
+	bool _closed = false;
+	// wakes up accepting thread of exhausted worker
+	int _wakeup[2] = {-1, -1};
+};
+
+}
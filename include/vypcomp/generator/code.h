@@ -0,0 +1,83 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace vypcomp
+{
+    /**
+     * Single line of VYPcode. Line without opcode is empty or holds
+     * only a comment.
+     */
+    struct CodeLine
+    {
+        std::string opcode;
+        std::vector<std::string> operands;
+        /// Comment including the leading '#'.
+        std::string comment;
+
+        bool is_instruction() const { return !opcode.empty() && opcode != "LABEL"; }
+        bool is_label() const { return opcode == "LABEL"; }
+
+        std::string str() const;
+    };
+
+    /**
+     * Generated VYPcode kept as list of lines. Generator appends
+     * instructions as they are produced, the text is created only
+     * once when the code is printed.
+     */
+    class Code
+    {
+    public:
+        using Lines = std::vector<CodeLine>;
+
+        /**
+         * Appends instruction. Operands are strings as they should appear
+         * in the code (registers, stack locations, labels, quoted string
+         * constants) or integers.
+         */
+        template <typename... Operands>
+        CodeLine& emit(std::string opcode, const Operands&... operands)
+        {
+            code_lines.push_back({std::move(opcode), {operand(operands)...}, {}});
+            return code_lines.back();
+        }
+
+        CodeLine& label(std::string name);
+        /// Appends line holding only the comment, '#' is prepended.
+        CodeLine& comment(const std::string& text);
+        /// Appends empty line separating parts of the code.
+        void blank();
+        void append(const Code& code);
+        void append(Code&& code);
+
+        /**
+         * Splits VYPcode text into lines. Operands are kept as written,
+         * string constants including quotes.
+         */
+        static Code parse(std::istream& in);
+        static Code parse(const std::string& text);
+        void print(std::ostream& out) const;
+
+        Lines& lines();
+        const Lines& lines() const;
+
+    private:
+        static std::string operand(std::string value) { return value; }
+
+        template <typename Integer, typename = std::enable_if_t<std::is_integral_v<Integer>>>
+        static std::string operand(Integer value) { return std::to_string(value); }
+
+    private:
+        Lines code_lines;
+    };
+}
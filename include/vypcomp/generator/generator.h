@@ -4,6 +4,7 @@
  */
 
 #pragma once
+#include <functional>
 #include <string>
 #include <sstream>
 #include <unordered_map>
@@ -11,6 +12,8 @@
 #include <vypcomp/ir/instructions.h>
 #include <vypcomp/parser/symbol_table.h>
 #include <vypcomp/ir/expression.h>
+#include <vypcomp/generator/code.h>
+#include <vypcomp/generator/register_allocator.h>
 
 namespace vypcomp
 {
@@ -24,8 +27,10 @@ namespace vypcomp
         using ExprRawPtr = vypcomp::ir::Expression*;
         using OffsetMap = std::unordered_map<AllocaRawPtr, std::int64_t>;
         using TempVarMap = std::unordered_map<ExprRawPtr, AllocaRawPtr>;
-        using ClassName = std::string;
-        using MethodName = std::string;
+        using SlotMap = std::unordered_map<AllocaRawPtr, std::size_t>;
+        using RegisterMap = RegisterAllocator::RegisterMap;
+        using ClassName = ir::Name;
+        using MethodName = ir::Name;
         using LabelName = std::string;
         using VtableMapping = std::unordered_map<MethodName, LabelName>;
         using MethodVector = std::vector<MethodName>;
@@ -33,53 +38,108 @@ namespace vypcomp
         using VtableIndexLookupPtr = std::shared_ptr<VtableIndexLookup>;
         using ClassVtableLookup = std::unordered_map<ClassName, VtableIndexLookupPtr>;
         using VtableAddressMapping = std::unordered_map<ClassName, std::uint64_t>;
+        // pre-order id of the class and id of the last class in its subtree
+        using ClassIdRange = std::pair<std::int64_t, std::int64_t>;
+        using ClassIdMapping = std::unordered_map<ClassName, ClassIdRange>;
+        using ClassVtableMapping = std::unordered_map<ClassName, VtableMapping>;
+        // generates one top level symbol into the buffer using the given worker
+        using Job = std::function<void(Generator&, Code&)>;
     public:
-        Generator(std::string out_filename, bool verbose);
-        Generator(std::unique_ptr<std::ostream> out, bool verbose);
+        // threads limits number of threads generating functions, 0 uses all hardware threads
+        Generator(std::string out_filename, bool verbose, bool optimize = false, std::size_t threads = 0);
+        Generator(std::unique_ptr<std::ostream> out, bool verbose, bool optimize = false, std::size_t threads = 0);
 
         void generate(const SymbolTable& symbol_table);
 
         const OutputStream& get_output() const;
     private:
-        void generate_function(vypcomp::ir::Function::Ptr input, std::string label_name, OutputStream& out);
-        void generate_function_body(vypcomp::ir::Function::Ptr input, OutputStream& out, const AllocaVector& args, const AllocaVector& local_variables, TempVarMap& temporary_variables_mapping);
-        void generate_constructor_body(vypcomp::ir::Function::Ptr input, std::string label_name, OutputStream& out);
-        void generate_block(vypcomp::ir::BasicBlock::Ptr in_block, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, OutputStream& out);
-        void generate_instruction(vypcomp::ir::Instruction::Ptr input, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, OutputStream& out);
-        void generate_expression(ir::Expression::ValueType input, DestinationName destination, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, OutputStream& out);
-        void generate_binaryop(ir::BinaryOpExpression::Ptr input, DestinationName destination, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, OutputStream& out);
-        void generate_return(OutputStream& out);
-        void generate_builtin_functions(OutputStream& out);
-        void generate_vtables(const SymbolTable& symbol_table, OutputStream& out);
+        // workers generating function bodies share the program layout, but not the output
+        Generator(const Generator& layout);
+
+        void generate_program(const SymbolTable& symbol_table, Code& out);
+        // runs jobs on worker threads, buffers[i] receives the code of jobs[i]
+        void generate_parallel(const std::vector<Job>& jobs, std::vector<Code>& buffers) const;
+        void generate_function(vypcomp::ir::Function::Ptr input, std::string label_name, Code& out);
+        void generate_function_body(vypcomp::ir::Function::Ptr input, Code& out, const AllocaVector& args, const AllocaVector& local_variables, TempVarMap& temporary_variables_mapping);
+        void generate_constructor_body(vypcomp::ir::Function::Ptr input, std::string label_name, Code& out);
+        void generate_block(vypcomp::ir::BasicBlock::Ptr in_block, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, Code& out);
+        void generate_instruction(vypcomp::ir::Instruction::Ptr input, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, Code& out);
+        void generate_expression(ir::Expression::ValueType input, DestinationName destination, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, Code& out);
+        void generate_binaryop(ir::BinaryOpExpression::Ptr input, DestinationName destination, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, Code& out, bool in_place = false);
+        void generate_return(Code& out);
+        void generate_builtin_functions(const vypcomp::SymbolTable& symbol_table, Code& out);
+        void generate_vtables(const SymbolTable& symbol_table, Code& out);
+        void generate_class_ids(const SymbolTable& symbol_table, Code& out);
+        // finds methods that resolve to the same implementation in the class and all its subclasses
+        void analyze_class_hierarchy();
+        std::optional<LabelName> find_direct_method_label(const ClassName& class_name, const MethodName& method_name) const;
+        // id range of the class, throws if the class has no id
+        ClassIdRange get_class_ids(const ClassName& class_name) const;
         std::string generate_method_label(const ir::Function::Ptr& method);
-        void generate_class(vypcomp::ir::Class::Ptr input, OutputStream& out);
-        void generate_constructor(vypcomp::ir::Class::Ptr input, OutputStream& out);
-        void generate_constructor_chain_invocation(vypcomp::ir::Class::Ptr input, OutputStream& out);
+        // unique suffix of control flow labels within the current function
+        std::string next_label_index();
+        void generate_class(vypcomp::ir::Class::Ptr input, Code& out);
+        void generate_constructor(vypcomp::ir::Class::Ptr input, Code& out);
+        void generate_constructor_chain_invocation(vypcomp::ir::Class::Ptr input, Code& out);
         std::size_t get_object_size(vypcomp::ir::Class::Ptr input);
-        std::size_t get_object_attribute_offset(vypcomp::ir::Class::Ptr class_ptr, const std::string& attribute_name);
+        std::size_t get_object_attribute_offset(vypcomp::ir::Class::Ptr class_ptr, const ir::Name& attribute_name);
 
         // aggregates all alloca instructions from the whole function, these alloca locations are then assigned stack positions in variable_offsets mapping
         AllocaVector get_alloca_instructions(vypcomp::ir::Instruction::Ptr block, TempVarMap& exp_temporary_mapping);
         std::vector<ir::AllocaInstruction::Ptr> get_temporary_allocas(vypcomp::ir::Expression::ValueType expr, TempVarMap& exp_temporary_mapping);
-        std::vector<ir::AllocaInstruction::Ptr> get_required_temporaries(ir::Expression::ValueType expr, TempVarMap& exp_temporary_mapping);
+        // appends temporaries of expr and its subexpressions to result
+        void get_required_temporaries(ir::Expression::ValueType expr, TempVarMap& exp_temporary_mapping, AllocaVector& result);
+        // new temporary holding result of expr, the expression is rendered into its name only in verbose mode
+        ir::AllocaInstruction::Ptr make_temporary(const ir::Datatype& type, ExprRawPtr expr) const;
+        // packs temporaries of operands of expr into the lowest free slots, busy counts values live in each slot while expr is evaluated
+        void assign_temporary_slots(ir::Expression::ValueType expr, TempVarMap& exp_temporary_mapping, std::vector<std::size_t>& busy);
+        // nearest subexpressions of expr whose results are stored in temporaries
+        void get_temporary_operands(ir::Expression::ValueType expr, TempVarMap& exp_temporary_mapping, std::vector<ir::Expression::ValueType>& operands);
+        // assigns frame positions to local variables, temporaries in the same slot share one position, returns size of the frame
+        std::size_t layout_frame(const AllocaVector& local_variables);
 
         bool is_alloca(vypcomp::ir::Instruction::Ptr instr) const;
         bool is_return(vypcomp::ir::Instruction::Ptr instr) const;
-        bool is_builtin_func(std::string func_name) const;
+        bool is_builtin_func(const ir::Name& func_name) const;
 
         std::optional<std::size_t> find_offset(AllocaRawPtr alloca_ptr, OffsetMap& variable_offsets) const;
+        std::optional<DestinationName> find_register(const ir::Expression::ValueType& expr) const;
+        // register assigned to the variable or its current stack position
+        DestinationName get_variable_location(AllocaRawPtr alloca_ptr, OffsetMap& variable_offsets) const;
         std::optional<AllocaRawPtr> find_expr_destination(ExprRawPtr expr, TempVarMap& temporary_variables_mapping) const;
         DestinationName get_expr_destination(ExprRawPtr expr, TempVarMap& temporary_variables_mapping, OffsetMap& variable_offsets) const;
     private:
         std::unique_ptr<std::ostream> _main_out;
         bool verbose = false;
+        // keeps locals and temporaries in registers, see RegisterAllocator
+        bool optimize = false;
+        std::size_t threads = 0;
         // assigns vtable id for each class
         VtableAddressMapping class_vtable_addr_mapping;
+        // class ids stored in objects, subclasses of a class have ids within its range
+        ClassIdMapping class_id_mapping;
+        // stack address of the chunk mapping class ids to class names
+        std::uint64_t class_names_addr = 0;
+        // class names indexed by class id
+        std::vector<ClassName> class_names;
+        // maps class name to labels of methods its vtable points to
+        ClassVtableMapping class_vtable_labels;
+        // methods that can be called directly, without vtable lookup
+        ClassVtableMapping direct_method_labels;
         // maps class name to a table that maps methods to method ids
         ClassVtableLookup class_method_vtable_mapping;
         // These variables are needed when the generator jumps into an instruction stream from generate(function)
         // so that it can properly generate return statements
         std::size_t arg_count = 0;
         std::size_t variable_count = 0;
+        // variables of the current function that live in registers instead of the stack
+        RegisterMap variable_registers;
+        // slot of each temporary within its statement, temporaries of different statements are never live at the same time
+        SlotMap temporary_slots;
+        // frame position of each local variable and temporary kept on the stack, the first one is the deepest
+        SlotMap frame_positions;
+        // labels generated inside the current function are derived from its label
+        LabelName function_label;
+        std::size_t label_counter = 0;
     };
 }
@@ -0,0 +1,84 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vypcomp/generator/code.h>
+
+namespace vypcomp
+{
+    /**
+     * Rewrites short sequences of generated VYPcode into cheaper ones.
+     *
+     * Rules are applied over the whole program until none of them
+     * changes the code:
+     *  - copy forwarding replaces register set by the following
+     *    instruction by the copied value and removes sets of registers
+     *    that are not read afterwards,
+     *  - jump threading retargets jumps to jumps, removes jumps to the
+     *    next instruction and code not reachable from the start of the
+     *    program,
+     *  - labels that are not referenced are removed,
+     *  - adjacent adjustments of $SP are merged.
+     *
+     * Liveness of registers is computed over the whole program. CALL
+     * clobbers all registers (see RegisterAllocator) and RETURN reads
+     * $0 holding the returned value.
+     */
+    class Peephole
+    {
+    public:
+        enum class Rule
+        {
+            CopyForwarding,
+            JumpThreading,
+            RedundantLabels,
+            StackAdjustMerging
+        };
+
+        static constexpr std::array<Rule, 4> RULES = {
+            Rule::CopyForwarding,
+            Rule::JumpThreading,
+            Rule::RedundantLabels,
+            Rule::StackAdjustMerging
+        };
+
+        void run(Code& code);
+
+        /// Number of rewrites done by the rule.
+        std::size_t hits(Rule rule) const;
+        static std::string name(Rule rule);
+
+        /**
+         * Writes hit counts of all rules as VYPcode comments.
+         */
+        void report(std::ostream& out) const;
+
+    private:
+        using Registers = std::uint64_t;
+
+        void compute_liveness(const Code::Lines& lines);
+        bool forward_copies(Code::Lines& lines);
+        bool thread_jumps(Code::Lines& lines);
+        bool remove_unreachable(Code::Lines& lines);
+        bool remove_labels(Code::Lines& lines);
+        bool merge_stack_adjusts(Code::Lines& lines);
+
+        void hit(Rule rule);
+
+    private:
+        std::unordered_map<std::string, std::size_t> label_positions;
+        std::vector<Registers> live_out;
+        std::array<std::size_t, RULES.size()> rule_hits = {};
+    };
+}
@@ -0,0 +1,88 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vypcomp/ir/instructions.h>
+#include <vypcomp/ir/expression.h>
+
+namespace vypcomp
+{
+    /**
+     * Assigns VYPcode registers to local variables, arguments and
+     * temporaries of a single function.
+     *
+     * Function body is linearized in the order in which the generator
+     * emits its code, branches and loops add edges to the otherwise
+     * sequential program points. Liveness of variables is computed over
+     * these points and each variable gets live interval spanning from
+     * its first to its last live point. Every CALL clobbers all registers,
+     * so variables live across a call are left on the stack. Remaining
+     * intervals are assigned registers by linear scan.
+     */
+    class RegisterAllocator
+    {
+    public:
+        using AllocaRawPtr = vypcomp::ir::AllocaInstruction*;
+        using ExprRawPtr = vypcomp::ir::Expression*;
+        using AllocaVector = std::vector<ir::AllocaInstruction::Ptr>;
+        using TempVarMap = std::unordered_map<ExprRawPtr, AllocaRawPtr>;
+        using RegisterMap = std::unordered_map<AllocaRawPtr, std::string>;
+
+        // $0, $1 and $2 are scratch registers of generated expressions
+        static constexpr std::size_t FIRST_REGISTER = 3;
+        static constexpr std::size_t REGISTER_COUNT = 8;
+
+        RegisterAllocator(const TempVarMap& temporary_variables_mapping);
+
+        /**
+         * Checks whether location is one of registers assigned to variables.
+         */
+        static bool is_allocated_register(const std::string& location);
+
+        RegisterMap allocate(const AllocaVector& args, const AllocaVector& local_variables, vypcomp::ir::BasicBlock::Ptr body);
+
+    private:
+        struct Interval
+        {
+            AllocaRawPtr variable;
+            std::size_t start;
+            std::size_t end;
+        };
+
+        // single program point of linearized function
+        struct Point
+        {
+            std::vector<std::size_t> uses;
+            std::vector<std::size_t> defs;
+            std::vector<std::size_t> successors;
+            bool falls_through = true;
+            bool call = false;
+        };
+
+        void visit_block(vypcomp::ir::BasicBlock::Ptr block);
+        void visit_instruction(vypcomp::ir::Instruction::Ptr instr);
+        void visit_expression(const ir::Expression::ValueType& expr);
+        void visit_operand(const ir::Expression::ValueType& expr, bool in_place);
+
+        std::size_t add_point();
+        void use(AllocaRawPtr variable, bool in_place = false);
+        void define(AllocaRawPtr variable);
+        void define_result(const ir::Expression::ValueType& expr);
+        void use_result(const ir::Expression::ValueType& expr);
+        std::vector<std::vector<bool>> compute_liveness() const;
+        RegisterMap linear_scan(std::vector<Interval> intervals) const;
+
+    private:
+        const TempVarMap& temporary_variables_mapping;
+        std::unordered_map<AllocaRawPtr, std::size_t> variable_ids;
+        std::vector<Point> points;
+        std::vector<std::size_t> loads_saved;
+        std::size_t loop_depth = 0;
+    };
+}
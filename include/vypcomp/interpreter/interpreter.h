@@ -0,0 +1,82 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "vypcomp/interpreter/program.h"
+#include "vypcomp/interpreter/value.h"
+
+namespace vypcomp {
+namespace vypcode {
+
+/**
+ * Thrown when executed program performs invalid operation
+ * (invalid chunk access, type mismatch, division by zero, ...).
+ */
+class RuntimeError: public std::exception {
+public:
+	RuntimeError(const std::string& msg);
+	const char * what() const throw() override;
+
+private:
+	std::string msg;
+};
+
+/**
+ * Executes translated VYPcode.
+ *
+ * Stack grows on demand, chunks live on heap addressed by ids
+ * starting with 1 (id 0 is never valid). Strings may be accessed
+ * by GETWORD/SETWORD/GETSIZE/RESIZE/COPY character by character
+ * and chunk of characters is accepted wherever string is expected,
+ * as builtins emitted by Generator rely on both.
+ */
+class Interpreter {
+public:
+	Interpreter(const Program& program, std::istream& in, std::ostream& out);
+
+	void run();
+
+	/**
+	 * Number of instructions executed by the last run.
+	 */
+	std::uint64_t executed() const;
+
+private:
+	struct Chunk {
+		std::vector<Value> words;
+		bool alive = true;
+	};
+
+	const Value& read(const Operand& op);
+	Value& write(const Operand& op);
+	Value& cell(std::int64_t address);
+
+	std::int64_t integer(const Value& v) const;
+	double real(const Value& v) const;
+	const std::string& text(const Value& v, std::string& scratch);
+	Chunk& chunk(const Value& v);
+	std::int64_t callTarget(const Operand& op);
+	std::string readLine();
+
+	const Program& _program;
+	std::istream& _in;
+	std::ostream& _out;
+
+	std::vector<Value> _registers;
+	std::vector<Value> _stack;
+	std::vector<Chunk> _chunks;
+	std::uint64_t _executed = 0;
+};
+
+}
+}
@@ -0,0 +1,154 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "vypcomp/interpreter/value.h"
+
+namespace vypcomp {
+namespace vypcode {
+
+/**
+ * Thrown when VYPcode text cannot be translated into Program.
+ */
+class LoadError: public std::exception {
+public:
+	LoadError(const std::string& msg);
+	const char * what() const throw() override;
+
+private:
+	std::string msg;
+};
+
+enum class Opcode : std::uint8_t {
+	Set,
+	Create,
+	Copy,
+	GetSize,
+	GetWord,
+	SetWord,
+	Resize,
+	Destroy,
+	AddI,
+	SubI,
+	MulI,
+	DivI,
+	AddF,
+	SubF,
+	MulF,
+	DivF,
+	LtI,
+	LtF,
+	LtS,
+	EqI,
+	EqF,
+	EqS,
+	GtI,
+	GtF,
+	GtS,
+	And,
+	Or,
+	Not,
+	Int2Float,
+	Float2Int,
+	Int2String,
+	Float2String,
+	Jump,
+	JumpZ,
+	JumpNZ,
+	Call,
+	Return,
+	ReadI,
+	ReadF,
+	ReadS,
+	WriteI,
+	WriteF,
+	WriteS,
+	// Appended after the last instruction, stops execution.
+	Halt
+};
+
+/**
+ * Operand of translated instruction.
+ *
+ * Register $SP has index 0, register $N has index N+1. Memory
+ * operands address stack cell base+offset where base is value of
+ * register (or 0 for absolute addresses). Labels are resolved to
+ * indexes of instructions at load time.
+ */
+struct Operand {
+	enum class Kind : std::uint8_t {
+		None,
+		Register,
+		Memory,
+		Absolute,
+		Constant,
+		Label
+	};
+
+	Kind kind = Kind::None;
+	std::uint32_t reg = 0;
+	std::int64_t value = 0;
+
+	static constexpr std::uint32_t SP = 0;
+};
+
+struct Instruction {
+	Opcode op;
+	Operand ops[3];
+};
+
+/**
+ * VYPcode translated into array of instructions with constants
+ * moved into a pool.
+ */
+class Program {
+public:
+	/**
+	 * Translates VYPcode as written by Generator.
+	 */
+	static Program load(std::istream& in);
+	static Program load(const std::string& path);
+
+	const std::vector<Instruction>& code() const;
+	const std::vector<Value>& constants() const;
+	std::size_t registers() const;
+
+	/**
+	 * Address of instruction following given label. Used by CALL
+	 * with targets computed at run time (method tables).
+	 */
+	const std::int64_t* address(const std::string& label) const;
+
+private:
+	void parseLine(const std::string& line, std::size_t lineno);
+	Operand parseOperand(const std::string& text, std::size_t lineno);
+	std::uint32_t parseRegister(const std::string& text, std::size_t lineno);
+	void resolveLabels();
+
+	std::vector<Instruction> _code;
+	std::vector<Value> _constants;
+	std::unordered_map<std::string, std::int64_t> _labels;
+	std::size_t _registers = 1;
+
+	// Label operand waiting for the label to be defined.
+	struct Fixup {
+		std::size_t instruction;
+		std::size_t operand;
+		std::string label;
+		std::size_t line;
+	};
+	std::vector<Fixup> _fixups;
+};
+
+}
+}
@@ -0,0 +1,81 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace vypcomp {
+namespace vypcode {
+
+/**
+ * Value stored in register, memory cell or word of a chunk.
+ *
+ * Chunks are referenced by integer ids. Strings are shared between
+ * copies of the value and copied only before they are modified.
+ */
+class Value {
+public:
+	enum class Type : std::uint8_t {
+		Int,
+		Float,
+		String
+	};
+
+	Value(std::int64_t i = 0): _type(Type::Int), _int(i) {}
+	Value(double f): _type(Type::Float), _float(f) {}
+	Value(std::string s):
+		_type(Type::String),
+		_int(0),
+		_string(std::make_shared<std::string>(std::move(s)))
+	{
+	}
+
+	Type type() const { return _type; }
+	bool isInt() const { return _type == Type::Int; }
+	bool isFloat() const { return _type == Type::Float; }
+	bool isString() const { return _type == Type::String; }
+
+	std::int64_t asInt() const { return _int; }
+	double asFloat() const { return _float; }
+	const std::string& asString() const { return *_string; }
+
+	/**
+	 * Provides string that can be modified without affecting other
+	 * copies of the value.
+	 */
+	std::string& mutableString()
+	{
+		if (_string.use_count() > 1)
+			_string = std::make_shared<std::string>(*_string);
+
+		return *_string;
+	}
+
+	bool truthy() const
+	{
+		switch (_type) {
+		case Type::Float:
+			return _float != 0.0;
+		case Type::String:
+			return !_string->empty();
+		default:
+			return _int != 0;
+		}
+	}
+
+private:
+	Type _type;
+	union {
+		std::int64_t _int;
+		double _float;
+	};
+	std::shared_ptr<std::string> _string;
+};
+
+}
+}
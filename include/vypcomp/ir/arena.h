@@ -0,0 +1,124 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace vypcomp {
+namespace ir {
+
+/**
+ * Bump allocator owning IR nodes of single compilation.
+ *
+ * Nodes are placed into large chunks and destroyed all at once
+ * (in reverse order of creation) when arena dies. Arena is
+ * owned by global symbol table.
+ */
+class Arena {
+public:
+	using Ptr = std::shared_ptr<Arena>;
+
+	Arena(std::size_t chunkSize = 64*1024);
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	/**
+	 * Creates object of type T inside arena.
+	 */
+	template<class T, class... Args>
+	T* create(Args&&... args)
+	{
+		auto node = static_cast<Node*>(allocate(
+			objectOffset(alignof(T)) + sizeof(T),
+			alignof(T) > alignof(Node) ? alignof(T) : alignof(Node)
+		));
+		auto mem = reinterpret_cast<char*>(node) + objectOffset(alignof(T));
+		T* object = new (mem) T(std::forward<Args>(args)...);
+
+		node->destroy = [](Node* n) {
+			auto obj = reinterpret_cast<char*>(n) + objectOffset(alignof(T));
+			reinterpret_cast<T*>(obj)->~T();
+		};
+		node->prev = _last;
+		_last = node;
+		_objects++;
+
+		return object;
+	}
+
+	std::size_t objects() const;
+	std::size_t bytes() const;
+	std::size_t chunks() const;
+
+	/**
+	 * Arena used by ir::make in the current thread.
+	 */
+	static Arena* current();
+
+	/**
+	 * Sets current arena for lifetime of the scope.
+	 */
+	class Scope {
+	public:
+		Scope(Arena* arena);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		Arena* _previous;
+	};
+
+private:
+	/**
+	 * Header preceding every object. Forms list of objects
+	 * that have to be destroyed.
+	 */
+	struct Node {
+		void (*destroy)(Node*);
+		Node* prev;
+	};
+
+	void* allocate(std::size_t size, std::size_t align);
+	static constexpr std::size_t objectOffset(std::size_t align)
+	{
+		return (sizeof(Node) + align - 1) / align * align;
+	}
+
+private:
+	std::vector<std::unique_ptr<char[]>> _chunks;
+	std::size_t _chunkSize;
+	char* _cursor = nullptr;
+	char* _end = nullptr;
+
+	Node* _last = nullptr;
+	std::size_t _objects = 0;
+	std::size_t _bytes = 0;
+};
+
+/**
+ * Creates IR node. When arena is set for the current thread node is
+ * placed into it and returned handle does not own it (no reference
+ * counting is performed on copies). Otherwise node is allocated on heap.
+ */
+template<class T, class... Args>
+std::shared_ptr<T> make(Args&&... args)
+{
+	if (auto arena = Arena::current())
+		return std::shared_ptr<T>(std::shared_ptr<void>(), arena->create<T>(std::forward<Args>(args)...));
+
+	return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+}
+}
@@ -7,6 +7,7 @@
 #include <string>
 #include <variant>
 #include <memory>
+#include <vector>
 
 #include "vypcomp/ir/ir.h"
 #include "vypcomp/ir/instructions.h"
@@ -20,12 +21,18 @@ namespace ir
 class DummyExpression : public Expression
 {
 public:
+	virtual Kind kind() const override { return Kind::Dummy; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Dummy; }
+
 	virtual std::string to_string() const override;
 };
 
 class LiteralExpression : public Expression 
 {
 public:
+	virtual Kind kind() const override { return Kind::Literal; }
+	static bool classof(const Expression* e) { return e->kind() >= Kind::Literal && e->kind() <= Kind::NullObject; }
+
 	LiteralExpression(vypcomp::ir::Literal value);
 
 	virtual std::string to_string() const override;
@@ -38,6 +45,9 @@ private:
 class NullObject : public LiteralExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::NullObject; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::NullObject; }
+
 	NullObject(Datatype::ClassName class_name) 
 		: LiteralExpression(Literal(0ull))
 	{
@@ -48,6 +58,9 @@ public:
 class SymbolExpression : public Expression 
 {
 public:
+	virtual Kind kind() const override { return Kind::Symbol; }
+	static bool classof(const Expression* e) { return e->kind() >= Kind::Symbol && e->kind() <= Kind::Super; }
+
 	SymbolExpression(AllocaInstruction::Ptr value);
 
 	virtual std::string to_string() const override;
@@ -60,6 +73,9 @@ protected:
 class SuperExpression : public SymbolExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::Super; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Super; }
+
 	SuperExpression(AllocaInstruction::Ptr value, Class::Ptr child_ptr);
 	Class::Ptr getClass() const;
 private:
@@ -70,6 +86,9 @@ private:
 class ObjectCastExpression : public Expression
 {
 public:
+	virtual Kind kind() const override { return Kind::ObjectCast; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::ObjectCast; }
+
 	ObjectCastExpression(Class::Ptr target_class, ValueType operand);
 	virtual std::string to_string() const override;
 	Class::Ptr getTargetClass() const;
@@ -82,6 +101,9 @@ private:
 class StringCastExpression : public Expression
 {
 public:
+	virtual Kind kind() const override { return Kind::StringCast; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::StringCast; }
+
 	StringCastExpression(ValueType operand);
 	virtual std::string to_string() const override;
 	ValueType getOperand() const;
@@ -96,6 +118,10 @@ class FunctionExpression : public Expression
 {
 public:
 	using ArgExpressions = std::vector<Expression::ValueType>;
+
+	virtual Kind kind() const override { return Kind::Function; }
+	static bool classof(const Expression* e) { return e->kind() >= Kind::Function && e->kind() <= Kind::Method; }
+
 	FunctionExpression(Function::Ptr value);
 	FunctionExpression(Function::Ptr value, ArgExpressions args);
 
@@ -113,6 +139,10 @@ class ConstructorExpression : public FunctionExpression
 {
 public:
 	using ArgExpressions = std::vector<Expression::ValueType>;
+
+	virtual Kind kind() const override { return Kind::Constructor; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Constructor; }
+
 	ConstructorExpression(Class::Ptr class_ptr);
 
 	virtual std::string to_string() const override;
@@ -125,6 +155,9 @@ private:
 class MethodExpression : public FunctionExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::Method; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Method; }
+
 	MethodExpression(Function::Ptr function, ValueType context_object);
 
 	virtual std::string to_string() const override;
@@ -137,6 +170,8 @@ class BinaryOpExpression : public Expression
 {
 public:
 	using Ptr = std::shared_ptr<BinaryOpExpression>;
+
+	static bool classof(const Expression* e) { return e->kind() >= Kind::Add && e->kind() <= Kind::Or; }
 protected:
 	BinaryOpExpression(ValueType op1, ValueType op2);
 	BinaryOpExpression(Datatype dt, ValueType op1, ValueType op2);
@@ -151,6 +186,9 @@ protected:
 class AddExpression : public BinaryOpExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::Add; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Add; }
+
 	AddExpression(ValueType op1, ValueType op2);
 
 	virtual std::string to_string() const override;
@@ -159,6 +197,9 @@ public:
 class SubtractExpression : public BinaryOpExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::Subtract; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Subtract; }
+
 	SubtractExpression(ValueType op1, ValueType op2);
 
 	virtual std::string to_string() const override;
@@ -167,6 +208,9 @@ public:
 class MultiplyExpression : public BinaryOpExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::Multiply; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Multiply; }
+
 	MultiplyExpression(ValueType op1, ValueType op2);
 
 	virtual std::string to_string() const override;
@@ -175,6 +219,9 @@ public:
 class DivideExpression : public BinaryOpExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::Divide; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Divide; }
+
 	DivideExpression(ValueType op1, ValueType op2);
 
 	virtual std::string to_string() const override;
@@ -183,6 +230,9 @@ public:
 class ComparisonExpression : public BinaryOpExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::Comparison; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Comparison; }
+
 	enum Operation : std::uint8_t
 	{
 		GREATER,
@@ -206,6 +256,9 @@ private:
 class AndExpression : public BinaryOpExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::And; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::And; }
+
 	AndExpression(ValueType op1, ValueType op2);
 
 	virtual std::string to_string() const override;
@@ -214,6 +267,9 @@ public:
 class OrExpression : public BinaryOpExpression
 {
 public:
+	virtual Kind kind() const override { return Kind::Or; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Or; }
+
 	OrExpression(ValueType op1, ValueType op2);
 
 	virtual std::string to_string() const override;
@@ -225,6 +281,9 @@ public:
 class NotExpression : public Expression
 {
 public:
+	virtual Kind kind() const override { return Kind::Not; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Not; }
+
 	NotExpression(ValueType operand);
 
 	virtual std::string to_string() const override;
@@ -236,6 +295,9 @@ private:
 class ObjectAttributeExpression : public Expression
 {
 public:
+	virtual Kind kind() const override { return Kind::ObjectAttribute; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::ObjectAttribute; }
+
 	ObjectAttributeExpression(AllocaInstruction::Ptr object, AllocaInstruction::Ptr attribute, Class::Ptr class_ptr);
 
 	AllocaInstruction::Ptr getObject() const;
@@ -248,5 +310,23 @@ private:
 	AllocaInstruction::Ptr _attribute;
 };
 
+// Concatenation of several strings at once. It is not created by the parser,
+// StringConcatenation pass builds it from chains of string + operations.
+class ConcatExpression : public Expression
+{
+public:
+	using Operands = std::vector<Expression::ValueType>;
+
+	virtual Kind kind() const override { return Kind::Concat; }
+	static bool classof(const Expression* e) { return e->kind() == Kind::Concat; }
+
+	ConcatExpression(Operands operands);
+
+	virtual std::string to_string() const override;
+	const Operands& getOperands() const;
+private:
+	Operands _operands;
+};
+
 }
 }
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "vypcomp/ir/ir.h"
+#include "vypcomp/ir/name_map.h"
 
 namespace vypcomp {
 
@@ -41,6 +42,11 @@ public:
 	void addFirst(Instruction::Ptr first);
 	Instruction::Ptr first() const;
 	Instruction::Ptr last() const;
+
+	std::vector<Instruction::Ptr> instructions() const;
+	/// Replaces instructions of the block and links them in given order.
+	void setInstructions(const std::vector<Instruction::Ptr>& instructions);
+
 	std::string str(const std::string& prefix) const;
 
 	std::string name() const;
@@ -54,6 +60,10 @@ private:
 class DummyInstruction : public Instruction {
 public:
 	using Ptr = std::shared_ptr<DummyInstruction>;
+
+	virtual Kind kind() const override { return Kind::Dummy; }
+	static bool classof(const Instruction* i) { return i->kind() == Kind::Dummy; }
+
 	virtual std::string str(const std::string& prefix) const override;
 };
 
@@ -61,6 +71,9 @@ class AllocaInstruction : public Instruction {
 public:
 	using Ptr = std::shared_ptr<AllocaInstruction>;
 
+	virtual Kind kind() const override { return Kind::Alloca; }
+	static bool classof(const Instruction* i) { return i->kind() == Kind::Alloca; }
+
 	/**
 	 * Initial value is stored in form of string.
 	 */
@@ -71,10 +84,10 @@ public:
 
 	void setType(const Datatype& t);
 	Datatype type() const;
-	std::string name() const;
+	const Name& name() const;
 
 private:
-	std::string _varName;
+	Name _varName;
 	std::string _prefix;
 	Datatype _type;
 };
@@ -83,6 +96,9 @@ class Assignment: public Instruction {
 public:
 	using Ptr = std::shared_ptr<Assignment>;
 
+	virtual Kind kind() const override { return Kind::Assignment; }
+	static bool classof(const Instruction* i) { return i->kind() == Kind::Assignment; }
+
 	/**
 	 * Initial value is stored in form of string.
 	 */
@@ -93,6 +109,7 @@ public:
 	virtual std::string str(const std::string& prefix) const override;
 	AllocaInstruction::Ptr getAlloca() const;
 	Expression::ValueType getExpr() const;
+	void setExpr(Expression::ValueType expr);
 private:
 	AllocaInstruction::Ptr _ptr;
 	Expression::ValueType _expr;
@@ -101,11 +118,15 @@ private:
 class ObjectAssignment : public Instruction
 {
 public:
+	virtual Kind kind() const override { return Kind::ObjectAssignment; }
+	static bool classof(const Instruction* i) { return i->kind() == Kind::ObjectAssignment; }
+
 	ObjectAssignment(Expression::ValueType dest_object, Expression::ValueType expr);
 
 	virtual std::string str(const std::string& prefix) const override;
 	Expression::ValueType getTarget() const;
 	Expression::ValueType getExpr() const;
+	void setExpr(Expression::ValueType expr);
 private:
 	Expression::ValueType _dest_object;
 	Expression::ValueType _expr;
@@ -114,7 +135,10 @@ private:
 class Function: public Instruction {
 public:
 	using Ptr = std::shared_ptr<Function>;
-	using Signature = std::tuple<PossibleDatatype, std::string, Arglist>;
+	using Signature = std::tuple<PossibleDatatype, Name, Arglist>;
+
+	virtual Kind kind() const override { return Kind::Function; }
+	static bool classof(const Instruction* i) { return i->kind() == Kind::Function; }
 
 	Function(const Signature& sig);
 	void setSignature(const Signature& sig);
@@ -128,16 +152,17 @@ public:
 
 	bool isVoid() const;
 
-	std::string name() const;
+	const Name& name() const;
 	PossibleDatatype type() const;
 	void setArgs(const std::vector<AllocaInstruction::Ptr>& args);
 	const std::vector<AllocaInstruction::Ptr>& args() const;
 	std::vector<AllocaInstruction::Ptr>& args();
 	std::vector<Datatype> argTypes() const;
+	bool hasArgTypes(const std::vector<Datatype>& types) const;
 
 private:
 	PossibleDatatype _type;
-	std::string _name;
+	Name _name;
 	std::string _prefix;
 	std::vector<AllocaInstruction::Ptr> _args;
 
@@ -148,6 +173,9 @@ class BranchInstruction: public Instruction {
 public:
 	using Ptr = std::shared_ptr<BranchInstruction>;
 
+	virtual Kind kind() const override { return Kind::Branch; }
+	static bool classof(const Instruction* i) { return i->kind() == Kind::Branch; }
+
 	BranchInstruction(
 		Expression::ValueType expr,
 		BasicBlock::Ptr ifBlock,
@@ -157,6 +185,7 @@ public:
 	BasicBlock::Ptr getIf() const;
 	BasicBlock::Ptr getElse() const;
 	Expression::ValueType getExpr() const;
+	void setExpr(Expression::ValueType expr);
 private:
 	Expression::ValueType _expr = nullptr;
 	BasicBlock::Ptr _if = nullptr;
@@ -167,11 +196,15 @@ class Return: public Instruction {
 public:
 	using Ptr = std::shared_ptr<Return>;
 
+	virtual Kind kind() const override { return Kind::Return; }
+	static bool classof(const Instruction* i) { return i->kind() == Kind::Return; }
+
 	Return(Expression::ValueType expr = nullptr);
 	bool isVoid() const;
 
 	virtual std::string str(const std::string& prefix) const override;
 	Expression::ValueType getExpr() const;
+	void setExpr(Expression::ValueType expr);
 private:
 	Expression::ValueType _expr;
 };
@@ -180,6 +213,9 @@ class LoopInstruction: public Instruction {
 public:
 	using Ptr = std::shared_ptr<LoopInstruction>;
 
+	virtual Kind kind() const override { return Kind::Loop; }
+	static bool classof(const Instruction* i) { return i->kind() == Kind::Loop; }
+
 	LoopInstruction(
 		Expression::ValueType expr,
 		BasicBlock::Ptr loop
@@ -187,6 +223,7 @@ public:
 	virtual std::string str(const std::string& prefix) const override;
 	BasicBlock::Ptr getBody() const;
 	Expression::ValueType getExpr() const;
+	void setExpr(Expression::ValueType expr);
 private:
 	Expression::ValueType _expr = nullptr;
 	BasicBlock::Ptr _body = nullptr;
@@ -201,7 +238,10 @@ public:
 	};
 public:
 	using Ptr = std::shared_ptr<Class>;
-	Class(const std::string& name, Class::Ptr base);
+
+	virtual Kind kind() const override { return Kind::Class; }
+	static bool classof(const Instruction* i) { return i->kind() == Kind::Class; }
+	Class(const Name& name, Class::Ptr base);
 
 	Function::Ptr constructor() const;
 
@@ -210,6 +250,7 @@ public:
 	void setBase(Class::Ptr base);
 	Class::Ptr getBase() const;
 	void add(Function::Ptr methods, const Visibility& v = Visibility::Public);
+	void remove(const Function::Ptr& method);
 	void add(AllocaInstruction::Ptr attr, const Visibility& v = Visibility::Public);
 
 	void addImplicit(Instruction::Ptr inst);
@@ -219,24 +260,32 @@ public:
 	//  - Public: method that is available to public
 	//  - Protected/Private: method that is available to the class too.
 	Function::Ptr getMethod(
-		const std::string& name,
+		const Name& name,
 		const std::vector<Datatype>& argtypes,
 		const Visibility& v = Visibility::Public
 	) const;
 	Function::Ptr getMethod(
-		const std::string& name,
+		const Name& name,
 		const Visibility& v = Visibility::Public
 	) const;
 	Function::Ptr getOriginalMethod(
-		const std::string& name,
+		const Name& name,
 		const Visibility& v = Visibility::Public
 	) const;
 
+	/**
+	 * Builds table of all methods visible in this class including
+	 * inherited ones. getMethod then resolves name by single lookup
+	 * in the table until methods of this class or of any of its
+	 * bases change.
+	 */
+	void resolveMethods();
+
 	//
 	// Visibility:
 	//  - Public: attribute that is available to public
 	//  - Protected/Private: attribute that is available to the class too.
-	AllocaInstruction::Ptr getAttribute(const std::string& name, const Visibility& v = Visibility::Public) const;
+	AllocaInstruction::Ptr getAttribute(const Name& name, const Visibility& v = Visibility::Public) const;
 
 	const std::vector<Function::Ptr>& publicMethods() const;
 	const std::vector<Function::Ptr>& privateMethods() const;
@@ -247,7 +296,7 @@ public:
 	const std::vector<AllocaInstruction::Ptr>& protectedAttributes() const;
 	std::size_t getAttributeCount() const;
 
-	std::string name() const;
+	const Name& name() const;
 	virtual std::string str(const std::string& prefix) const override;
 
 	static bool canAssign(Class::Ptr dest_class, Class::Ptr val_class);
@@ -260,6 +309,8 @@ public:
 			current_class = base_class;
 			while (auto parent_class = current_class->getBase())
 				current_class = parent_class.get();
+			// skip classes without methods
+			*this += 0;
 		}
 		MethodIterator() = default;
 		MethodIterator& operator+=(std::int64_t i);
@@ -283,7 +334,7 @@ public:
 	}
 	friend MethodIterator;
 private:
-	std::string _name;
+	Name _name;
 	Class::Ptr _parent;
 	std::vector<Function::Ptr> _publicMethods;
 	std::vector<Function::Ptr> _privateMethods;
@@ -293,6 +344,24 @@ private:
 	std::vector<AllocaInstruction::Ptr> _privateAttrs;
 	std::vector<AllocaInstruction::Ptr> _protectedAttrs;
 	std::vector<Instruction::Ptr> _implicit;
+
+	struct ResolvedMethod {
+		Function::Ptr method;
+		// Least restrictive visibility of lookup that sees the method.
+		Visibility access;
+	};
+
+	struct MethodTable {
+		// Candidates are in order in which getMethod searches them.
+		NameMap<std::vector<ResolvedMethod>> methods;
+		// Versions of this class and its bases the table was built from.
+		std::vector<std::pair<const Class*, std::size_t>> versions;
+	};
+
+	const MethodTable* methodTable() const;
+
+	std::unique_ptr<MethodTable> _methodTable;
+	std::size_t _version = 0;
 };
 
 }
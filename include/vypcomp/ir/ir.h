@@ -9,10 +9,13 @@
 #include <optional>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <variant>
 #include <vector>
 #include <stdexcept>
 
+#include "vypcomp/ir/name.h"
+
 namespace vypcomp {
 namespace ir {
 
@@ -27,7 +30,7 @@ enum class PrimitiveDatatype : int {
 
 class Datatype {
 public:
-	using ClassName = std::string;
+	using ClassName = Name;
 	struct FunctionType {};
 	struct InvalidDatatype {};
 
@@ -62,7 +65,7 @@ private:
 	DT _dt;
 };
 
-using Declaration = std::pair<Datatype, std::string>;
+using Declaration = std::pair<Datatype, Name>;
 using Arglist = std::vector<Declaration>;
 using PossibleDatatype = std::optional<Datatype>;
 
@@ -81,12 +84,17 @@ public:
 	template<PrimitiveDatatype = PrimitiveDatatype::Float>
 	double get() const;
 
+	const Impl& value() const
+	{
+		return _val;
+	}
+
 	std::string string_value() const
 	{
 		if (std::holds_alternative<std::string>(_val)) 
 			return "\"" + std::get<std::string>(_val) + "\"";
 		else if (std::holds_alternative<unsigned long long>(_val))
-			return std::to_string(std::get<unsigned long long>(_val));
+			return std::to_string(static_cast<long long>(std::get<unsigned long long>(_val)));
 		else if (std::holds_alternative<double>(_val))
 			return std::to_string(std::get<double>(_val));
 		else
@@ -100,7 +108,7 @@ public:
 			return "\"" + std::get<std::string>(_val) + "\"";
 		}
 		else if (std::holds_alternative<unsigned long long>(_val))
-			return std::to_string(std::get<unsigned long long>(_val));
+			return std::to_string(static_cast<long long>(std::get<unsigned long long>(_val)));
 		else if (std::holds_alternative<double>(_val))
 		{
 			char buf[64] = { 0 };
@@ -138,9 +146,27 @@ class Instruction {
 public:
 	using Ptr = std::shared_ptr<Instruction>;
 
+	/**
+	 * Identifies concrete type of instruction. Allows dispatching
+	 * on instruction type without RTTI.
+	 */
+	enum class Kind {
+		Dummy,
+		Alloca,
+		Assignment,
+		ObjectAssignment,
+		Function,
+		Branch,
+		Return,
+		Loop,
+		Class
+	};
+
 	Instruction();
 	virtual ~Instruction();
 
+	virtual Kind kind() const = 0;
+
 	void setNext(Instruction::Ptr next);
 	Instruction::Ptr next() const;
 
@@ -153,6 +179,35 @@ protected:
 class Expression {
 public:
 	using ValueType = std::shared_ptr<Expression>;
+
+	/**
+	 * Identifies concrete type of expression. Kinds of derived
+	 * expressions follow kind of their base so that family of
+	 * expressions forms continuous range.
+	 */
+	enum class Kind {
+		Dummy,
+		Literal,
+		NullObject,
+		Symbol,
+		Super,
+		ObjectCast,
+		StringCast,
+		Function,
+		Constructor,
+		Method,
+		Add,
+		Subtract,
+		Multiply,
+		Divide,
+		Comparison,
+		And,
+		Or,
+		Not,
+		ObjectAttribute,
+		Concat
+	};
+
 	Expression()
 		: _type(Datatype::InvalidDatatype())
 	{}
@@ -170,6 +225,7 @@ public:
 		return _type;
 	}
 
+	virtual Kind kind() const = 0;
 	virtual std::string to_string() const = 0;
 	// simple expression means that it can be represented in a single register load
 	virtual bool is_simple() const { return false; }
@@ -177,5 +233,37 @@ protected:
 	Datatype _type;
 };
 
+/**
+ * Checks whether IR node is of type T or derived from it. Type T
+ * provides classof() checking kind of the node.
+ */
+template<class T, class Node>
+bool is(const Node* node)
+{
+	return node != nullptr && T::classof(node);
+}
+
+template<class T, class Node>
+bool is(const std::shared_ptr<Node>& node)
+{
+	return is<T>(node.get());
+}
+
+/**
+ * Casts IR node to type T. Returns null if node is not of type T.
+ */
+template<class T, class Node>
+auto as(Node* node)
+{
+	using Result = std::conditional_t<std::is_const_v<Node>, const T*, T*>;
+	return is<T>(node) ? static_cast<Result>(node) : nullptr;
+}
+
+template<class T, class Node>
+std::shared_ptr<T> as(const std::shared_ptr<Node>& node)
+{
+	return is<T>(node.get()) ? std::static_pointer_cast<T>(node) : nullptr;
+}
+
 }
 }
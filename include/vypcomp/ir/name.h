@@ -0,0 +1,93 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace vypcomp {
+namespace ir {
+
+/**
+ * Interned identifier.
+ *
+ * Each distinct name is stored only once for the whole process and
+ * Name refers to the stored copy. Copying names is cheap and two
+ * names are equal iff they refer to the same copy.
+ */
+class Name {
+public:
+	Name();
+	Name(std::string_view name);
+	Name(const std::string& name);
+	Name(const char* name);
+
+	const std::string& str() const { return *_str; }
+	operator const std::string&() const { return *_str; }
+
+	const char* c_str() const { return _str->c_str(); }
+	std::size_t size() const { return _str->size(); }
+	bool empty() const { return _str->empty(); }
+
+	/**
+	 * Identity of the name, equal names have equal ids.
+	 */
+	std::uintptr_t id() const { return reinterpret_cast<std::uintptr_t>(_str); }
+
+	bool operator==(const Name& other) const { return _str == other._str; }
+	bool operator!=(const Name& other) const { return _str != other._str; }
+
+	/**
+	 * Orders names alphabetically so that containers keyed by
+	 * names iterate in deterministic order.
+	 */
+	bool operator<(const Name& other) const { return _str != other._str && *_str < *other._str; }
+
+	/**
+	 * Number of distinct names interned so far.
+	 */
+	static std::size_t interned();
+
+private:
+	const std::string* _str;
+};
+
+inline bool operator==(const Name& name, const std::string& str) { return name.str() == str; }
+inline bool operator==(const std::string& str, const Name& name) { return name.str() == str; }
+inline bool operator==(const Name& name, const char* str) { return name.str() == str; }
+inline bool operator==(const char* str, const Name& name) { return name.str() == str; }
+inline bool operator!=(const Name& name, const std::string& str) { return name.str() != str; }
+inline bool operator!=(const std::string& str, const Name& name) { return name.str() != str; }
+inline bool operator!=(const Name& name, const char* str) { return name.str() != str; }
+inline bool operator!=(const char* str, const Name& name) { return name.str() != str; }
+
+inline std::string operator+(const Name& name, const std::string& str) { return name.str() + str; }
+inline std::string operator+(const std::string& str, const Name& name) { return str + name.str(); }
+inline std::string operator+(const Name& name, const char* str) { return name.str() + str; }
+inline std::string operator+(const char* str, const Name& name) { return str + name.str(); }
+
+inline std::ostream& operator<<(std::ostream& out, const Name& name)
+{
+	return out << name.str();
+}
+
+}
+}
+
+namespace std {
+
+template<>
+struct hash<vypcomp::ir::Name> {
+	std::size_t operator()(const vypcomp::ir::Name& name) const
+	{
+		return std::hash<std::uintptr_t>()(name.id());
+	}
+};
+
+}
@@ -0,0 +1,165 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "vypcomp/ir/name.h"
+
+namespace vypcomp {
+namespace ir {
+
+/**
+ * Hash map keyed by interned names.
+ *
+ * Uses open addressing with linear probing over power of two
+ * sized table. Names are hashed by their identity so no string
+ * is touched during lookup.
+ */
+template<class Value>
+class NameMap {
+public:
+	const Value* find(const Name& key) const
+	{
+		if (_slots.empty())
+			return nullptr;
+
+		for (auto i = index(key); _slots[i].used; i = (i + 1) & mask()) {
+			if (_slots[i].key == key)
+				return &_slots[i].value;
+		}
+
+		return nullptr;
+	}
+
+	Value* find(const Name& key)
+	{
+		return const_cast<Value*>(std::as_const(*this).find(key));
+	}
+
+	/**
+	 * Returns value stored under key, default constructed value
+	 * is inserted when key is not present.
+	 */
+	Value& operator[](const Name& key)
+	{
+		reserve(_size + 1);
+
+		auto i = index(key);
+		for (; _slots[i].used; i = (i + 1) & mask()) {
+			if (_slots[i].key == key)
+				return _slots[i].value;
+		}
+
+		_slots[i].used = true;
+		_slots[i].key = key;
+		_size++;
+		return _slots[i].value;
+	}
+
+	/**
+	 * Removes entry stored under key. Returns false when key
+	 * is not present.
+	 */
+	bool erase(const Name& key)
+	{
+		if (_slots.empty())
+			return false;
+
+		auto i = index(key);
+		for (; _slots[i].used; i = (i + 1) & mask()) {
+			if (_slots[i].key == key)
+				break;
+		}
+
+		if (!_slots[i].used)
+			return false;
+
+		// Following entries of the cluster are shifted into the hole
+		// unless it lies before their home slot, so lookups do not
+		// stop at it.
+		for (auto j = (i + 1) & mask(); _slots[j].used; j = (j + 1) & mask()) {
+			if (((j - index(_slots[j].key)) & mask()) >= ((j - i) & mask())) {
+				_slots[i] = std::move(_slots[j]);
+				i = j;
+			}
+		}
+
+		_slots[i] = Slot();
+		_size--;
+		return true;
+	}
+
+	std::size_t size() const
+	{
+		return _size;
+	}
+
+	/**
+	 * Calls f(key, value) for every entry. Order of entries
+	 * is not specified.
+	 */
+	template<class F>
+	void forEach(F&& f) const
+	{
+		for (const auto& slot: _slots) {
+			if (slot.used)
+				f(slot.key, slot.value);
+		}
+	}
+
+private:
+	struct Slot {
+		Name key;
+		Value value = Value();
+		bool used = false;
+	};
+
+	std::size_t mask() const
+	{
+		return _slots.size() - 1;
+	}
+
+	std::size_t index(const Name& key) const
+	{
+		// Fibonacci hashing spreads aligned addresses over the table.
+		return static_cast<std::size_t>((std::uint64_t(key.id()) * 0x9E3779B97F4A7C15ull) >> _shift);
+	}
+
+	void reserve(std::size_t size)
+	{
+		// Keep load factor under 3/4.
+		if (size * 4 <= _slots.size() * 3)
+			return;
+
+		std::vector<Slot> old(_slots.empty() ? 16 : _slots.size() * 2);
+		std::swap(old, _slots);
+		_shift = 64;
+		for (auto capacity = _slots.size(); capacity > 1; capacity /= 2)
+			_shift--;
+
+		for (auto& slot: old) {
+			if (!slot.used)
+				continue;
+
+			auto i = index(slot.key);
+			while (_slots[i].used)
+				i = (i + 1) & mask();
+
+			_slots[i] = std::move(slot);
+		}
+	}
+
+private:
+	std::vector<Slot> _slots;
+	std::size_t _size = 0;
+	unsigned _shift = 64;
+};
+
+}
+}
@@ -0,0 +1,53 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <unordered_map>
+
+#include "vypcomp/ir/instructions.h"
+#include "vypcomp/ir/expression.h"
+
+namespace vypcomp {
+
+/**
+ * Constant folding and propagation over body of a single function.
+ *
+ * Literal subtrees of expressions are replaced by their value. Local
+ * variables that are assigned exactly once and whose assigned value
+ * folds into literal are replaced by that literal at every read.
+ * Branches with constant condition are replaced by the taken block
+ * and loops with false condition are removed. Steps are repeated
+ * until nothing changes, as every step may enable the others.
+ */
+class ConstantFolding {
+public:
+	void run(const ir::Function::Ptr& function);
+
+	/**
+	 * Evaluates expression whose operands are literals. Returns the
+	 * expression itself if it cannot be evaluated at compile time.
+	 */
+	static ir::Expression::ValueType fold(const ir::Expression::ValueType& expr);
+
+private:
+	void collectConstants(const ir::Function::Ptr& function);
+	void countAssignments(
+		const ir::BasicBlock::Ptr& block,
+		std::unordered_map<ir::AllocaInstruction*, ir::Assignment*>& assignments,
+		std::unordered_map<ir::AllocaInstruction*, std::size_t>& counts
+	) const;
+
+	void visitBlock(const ir::BasicBlock::Ptr& block);
+	ir::Expression::ValueType visit(const ir::Expression::ValueType& expr);
+	ir::Expression::ValueType foldVisited(const ir::Expression::ValueType& expr);
+
+private:
+	/// Literal value of local variables assigned exactly once.
+	std::unordered_map<ir::AllocaInstruction*, ir::Expression::ValueType> _constants;
+	bool _changed = false;
+};
+
+}
@@ -0,0 +1,49 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <unordered_set>
+
+#include "vypcomp/ir/instructions.h"
+#include "vypcomp/ir/expression.h"
+#include "vypcomp/parser/symbol_table.h"
+
+namespace vypcomp {
+
+/**
+ * Removes code that cannot affect behaviour of the program.
+ */
+class DeadCodeElimination {
+public:
+	/**
+	 * Removes functions and classes that are not reachable from main.
+	 * Methods of remaining classes are removed from classes and their
+	 * vtables if no reachable code calls method of the same name.
+	 */
+	void run(SymbolTable& table);
+
+	/**
+	 * Removes instructions following return, stores to local variables
+	 * that are never read afterwards and declarations of variables that
+	 * are not used at all.
+	 */
+	void run(const ir::Function::Ptr& function);
+
+	/**
+	 * Checks whether evaluation of expression may have observable effect
+	 * other than its value, including runtime errors.
+	 */
+	static bool hasSideEffects(const ir::Expression::ValueType& expr);
+
+private:
+	using Variables = std::unordered_set<ir::AllocaInstruction*>;
+
+	bool removeUnreachable(const ir::BasicBlock::Ptr& block) const;
+	bool removeDeadStores(const ir::BasicBlock::Ptr& block, Variables& live, bool remove) const;
+	void removeUnused(const ir::BasicBlock::Ptr& block, const Variables& used) const;
+};
+
+}
@@ -0,0 +1,71 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+#include "vypcomp/ir/instructions.h"
+#include "vypcomp/ir/expression.h"
+#include "vypcomp/parser/symbol_table.h"
+
+namespace vypcomp {
+
+/**
+ * Replaces calls of small user functions by their bodies.
+ *
+ * Function whose body is a single return is substituted into the
+ * calling expression when its arguments have no side effects. Body
+ * of other small functions is expanded at calls forming whole
+ * statement: call whose result is assigned, returned or discarded.
+ * Parameters and local variables of the callee become fresh local
+ * variables of the caller.
+ *
+ * Recursive functions are never inlined. Functions are processed
+ * callees first, so each call site is expanded at most once.
+ */
+class Inliner {
+public:
+	/// Maximal size of function body that is still inlined.
+	static constexpr std::size_t MaxSize = 32;
+
+	void run(SymbolTable& table);
+
+	/**
+	 * Inlines calls in body of the function. Only functions found
+	 * recursive by the last run over the whole table and the function
+	 * itself are kept called.
+	 */
+	void run(const ir::Function::Ptr& function);
+
+	/**
+	 * Number of instructions and expressions of function body.
+	 */
+	static std::size_t size(const ir::Function::Ptr& function);
+
+private:
+	using Functions = std::unordered_set<ir::Function*>;
+
+	static std::vector<ir::Function::Ptr> callees(const ir::Function::Ptr& function);
+	void order(const ir::Function::Ptr& function, Functions& visited, std::vector<ir::Function::Ptr>& result) const;
+	bool reaches(const ir::Function::Ptr& from, const ir::Function* to, Functions& visited) const;
+
+	bool canInline(const ir::Function::Ptr& callee) const;
+	bool canSubstitute(const ir::FunctionExpression* call) const;
+
+	void visitBlock(const ir::BasicBlock::Ptr& block);
+	ir::Expression::ValueType visit(const ir::Expression::ValueType& expr);
+	bool expand(const ir::Instruction::Ptr& instr, std::vector<ir::Instruction::Ptr>& result);
+
+private:
+	/// Functions calling themselves directly or through other functions.
+	Functions _recursive;
+	/// Function whose body is being modified.
+	ir::Function* _current = nullptr;
+};
+
+}
@@ -0,0 +1,27 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include "vypcomp/ir/instructions.h"
+#include "vypcomp/parser/symbol_table.h"
+
+namespace vypcomp {
+
+/**
+ * Runs IR optimization passes over every function and method of the
+ * program before code is generated. Symbols that are not needed by
+ * the program are removed from the table.
+ */
+class Optimizer {
+public:
+	void run(SymbolTable& table);
+
+private:
+	void run(const ir::Function::Ptr& function);
+	void run(const ir::Class::Ptr& cl);
+};
+
+}
@@ -0,0 +1,37 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include "vypcomp/ir/instructions.h"
+#include "vypcomp/ir/expression.h"
+
+namespace vypcomp {
+
+/**
+ * Replaces chains of string + operations by single concatenation.
+ *
+ * Nested string additions are flattened into ConcatExpression whose
+ * result is allocated once and every operand is copied into it once,
+ * instead of allocating and copying the partial result at each level.
+ * Adjacent literal operands are joined. Chains of two operands are
+ * kept as they are, since addStr handles them just as well.
+ */
+class StringConcatenation {
+public:
+	void run(const ir::Function::Ptr& function);
+
+	/**
+	 * Returns expression with concatenations flattened, or expression
+	 * itself if it has none.
+	 */
+	static ir::Expression::ValueType flatten(const ir::Expression::ValueType& expr);
+
+private:
+	static void visitBlock(const ir::BasicBlock::Ptr& block);
+	static void collectOperands(const ir::Expression::ValueType& expr, ir::ConcatExpression::Operands& operands);
+};
+
+}
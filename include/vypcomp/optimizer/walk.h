@@ -0,0 +1,129 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <stdexcept>
+
+#include "vypcomp/ir/arena.h"
+#include "vypcomp/ir/instructions.h"
+#include "vypcomp/ir/expression.h"
+
+namespace vypcomp {
+
+/**
+ * Calls f for expression and all of its subexpressions, parent
+ * expressions are visited first.
+ */
+template<class F>
+void forEachExpression(const ir::Expression::ValueType& expr, F&& f)
+{
+	if (!expr)
+		return;
+
+	f(expr);
+	if (auto call = ir::as<ir::FunctionExpression>(expr.get())) {
+		// Context object of method call is its first argument.
+		for (auto& arg: call->getArgs())
+			forEachExpression(arg, f);
+	}
+	else if (auto binop = ir::as<ir::BinaryOpExpression>(expr.get())) {
+		forEachExpression(binop->getOp1(), f);
+		forEachExpression(binop->getOp2(), f);
+	}
+	else if (auto notExpr = ir::as<ir::NotExpression>(expr.get())) {
+		forEachExpression(notExpr->getOperand(), f);
+	}
+	else if (auto cast = ir::as<ir::StringCastExpression>(expr.get())) {
+		forEachExpression(cast->getOperand(), f);
+	}
+	else if (auto cast = ir::as<ir::ObjectCastExpression>(expr.get())) {
+		forEachExpression(cast->getOperand(), f);
+	}
+	else if (auto concat = ir::as<ir::ConcatExpression>(expr.get())) {
+		for (auto& operand: concat->getOperands())
+			forEachExpression(operand, f);
+	}
+}
+
+/**
+ * Calls f for every expression evaluated by instruction itself,
+ * instructions of nested blocks are not visited.
+ */
+template<class F>
+void forEachExpression(const ir::Instruction::Ptr& instr, F&& f)
+{
+	if (auto assignment = ir::as<ir::Assignment>(instr.get())) {
+		forEachExpression(assignment->getExpr(), f);
+	}
+	else if (auto assignment = ir::as<ir::ObjectAssignment>(instr.get())) {
+		forEachExpression(assignment->getTarget(), f);
+		forEachExpression(assignment->getExpr(), f);
+	}
+	else if (auto ret = ir::as<ir::Return>(instr.get())) {
+		forEachExpression(ret->getExpr(), f);
+	}
+	else if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+		forEachExpression(branch->getExpr(), f);
+	}
+	else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+		forEachExpression(loop->getExpr(), f);
+	}
+}
+
+/**
+ * Calls f for every instruction of block including instructions
+ * of nested blocks.
+ */
+template<class F>
+void forEachInstruction(const ir::BasicBlock::Ptr& block, F&& f)
+{
+	if (!block)
+		return;
+
+	for (auto instr = block->first(); instr != nullptr; instr = instr->next()) {
+		f(instr);
+		if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+			forEachInstruction(branch->getIf(), f);
+			forEachInstruction(branch->getElse(), f);
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+			forEachInstruction(loop->getBody(), f);
+		}
+	}
+}
+
+/**
+ * Creates copy of binary expression with different operands.
+ */
+inline ir::Expression::ValueType rebuild(
+		const ir::BinaryOpExpression* binop,
+		const ir::Expression::ValueType& op1,
+		const ir::Expression::ValueType& op2)
+{
+	using Kind = ir::Expression::Kind;
+
+	switch (binop->kind()) {
+	case Kind::Add:
+		return ir::make<ir::AddExpression>(op1, op2);
+	case Kind::Subtract:
+		return ir::make<ir::SubtractExpression>(op1, op2);
+	case Kind::Multiply:
+		return ir::make<ir::MultiplyExpression>(op1, op2);
+	case Kind::Divide:
+		return ir::make<ir::DivideExpression>(op1, op2);
+	case Kind::Comparison:
+		return ir::make<ir::ComparisonExpression>(
+			static_cast<const ir::ComparisonExpression*>(binop)->getOperation(), op1, op2);
+	case Kind::And:
+		return ir::make<ir::AndExpression>(op1, op2);
+	case Kind::Or:
+		return ir::make<ir::OrExpression>(op1, op2);
+	default:
+		throw std::runtime_error("Unexpected binary expression: " + binop->to_string());
+	}
+}
+
+}
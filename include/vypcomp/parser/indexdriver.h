@@ -15,11 +15,12 @@ namespace vypcomp {
 class IndexParserDriver : public ParserDriver {
 public:
 	IndexParserDriver();
+	IndexParserDriver(ir::Arena::Ptr arena);
 	IndexParserDriver(const SymbolTable &global);
 
 public:
-	virtual AllocaInstruction::Ptr newDeclaration(const ir::Datatype& t, const std::string& name) override;
-	virtual Class::Ptr newClass(const std::string& name, const std::string& base) const override;
+	virtual AllocaInstruction::Ptr newDeclaration(const ir::Datatype& t, const Name& name) override;
+	virtual Class::Ptr newClass(const Name& name, const Name& base) const override;
 	virtual Function::Ptr newFunction(const ir::Function::Signature& sig) const override;
 	virtual std::vector<Instruction::Ptr> call_func(ir::Expression::ValueType func_expr, std::vector<ir::Expression::ValueType>& args) const override;
 	virtual Return::Ptr createReturn(const ir::Expression::ValueType& val) const override;
@@ -30,15 +31,21 @@ public:
 	virtual Instruction::Ptr createWhile(
 		const ir::Expression::ValueType& val,
 		const ir::BasicBlock::Ptr& block) const override;
-	virtual Datatype customDatatype(const std::string& dt) const override;
-	virtual Instruction::Ptr assign(const std::string& ptr, const ir::Expression::ValueType& val) const override;
+	virtual Datatype customDatatype(const Name& dt) const override;
+	/**
+	 * Only declarations created by index run are part of the final IR
+	 * and are placed into arena. Other nodes are heap allocated so that
+	 * they are released as soon as parser drops them.
+	 */
+	virtual ir::Arena* arena() const override;
+	virtual Instruction::Ptr assign(const Name& ptr, const ir::Expression::ValueType& val) const override;
 	virtual Instruction::Ptr assign(ir::Expression::ValueType dest_expr, const ir::Expression::ValueType& val) const override;
 	virtual Expression::ValueType createCastExpr(const Datatype& dt, Expression::ValueType expr) const override;
 
 
 // Expressions
 public:
-	virtual ir::Expression::ValueType identifierExpr(const std::string& name) const override;
+	virtual ir::Expression::ValueType identifierExpr(const Name& name) const override;
 	virtual ir::Expression::ValueType functionCall(
 		const ir::Expression::ValueType& identifier,
 		std::vector<ir::Expression::ValueType>& args) const override;
@@ -46,7 +53,7 @@ public:
 	virtual ir::Expression::ValueType notExpr(const ir::Expression::ValueType& expr) const override;
 	virtual ir::Expression::ValueType thisExpr() const override;
 	virtual ir::Expression::ValueType superExpr() const override;
-	virtual ir::Expression::ValueType newExpr(const std::string& clas_name) const override;
+	virtual ir::Expression::ValueType newExpr(const Name& clas_name) const override;
 
 	virtual ir::Expression::ValueType addExpr(
 		const ir::Expression::ValueType& e1,
@@ -98,10 +105,14 @@ public:
 
 	virtual ir::Expression::ValueType dotExpr(
 		const ir::Expression::ValueType& e1,
-		const std::string& id) const override;
+		const Name& id) const override;
 
 private:
-	std::vector<vypcomp::SymbolTable> _tables;
+	/**
+	 * Expressions are not needed in index run. All of them
+	 * are represented by single immutable node.
+	 */
+	ir::Expression::ValueType _dummy = std::make_shared<ir::DummyExpression>();
 };
 
 } // namespace vypcomp
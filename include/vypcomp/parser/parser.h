@@ -26,6 +26,11 @@ public:
 	using Ptr = std::unique_ptr<ParserDriver>;
 
 	ParserDriver(const SymbolTable& global);
+	/**
+	 * IR nodes are placed into provided arena. When arena is
+	 * null nodes are allocated on heap.
+	 */
+	ParserDriver(ir::Arena::Ptr arena);
 	ParserDriver();
 
 	virtual ~ParserDriver();
@@ -34,13 +39,24 @@ public:
 	const SymbolTable& table() const;
 
 	/**
-	 * @brief Parse file provided by path as argument.
+	 * @brief Parse file provided by path as argument. File is mapped
+	 * into memory.
 	 */
 	void parse(const std::string &filename);
 	void parse(std::istream &file);
+	void parse(const Source::Ptr &source);
+	/**
+	 * @brief Parse tokens scanned ahead. Same buffer can be parsed
+	 * by index run and full run.
+	 */
+	void parse(const TokenBuffer &tokens);
+	/**
+	 * @brief Scan file provided by path into token buffer.
+	 */
+	static TokenBuffer scan(const std::string &filename);
 	void parseExpression(std::istream& file, bool debug_on = false);
 
-	Class::Ptr getClass(const std::string& name) const;
+	Class::Ptr getClass(const Name& name) const;
 
 	void parseStart(ir::Function::Ptr fun);
 	void parseStart(ir::Class::Ptr cl);
@@ -50,9 +66,9 @@ public:
 	 * for index run. When class exists returns referecne to this class. This is solution
 	 * for not modifying global sybol table after first run and referencing same symbols.
 	 */
-	virtual Class::Ptr newClass(const std::string& name, const std::string& base) const;
+	virtual Class::Ptr newClass(const Name& name, const Name& base) const;
 
-	virtual AllocaInstruction::Ptr newDeclaration(const ir::Datatype& t, const std::string& name);
+	virtual AllocaInstruction::Ptr newDeclaration(const ir::Datatype& t, const Name& name);
 
 	/**
 	 * Creates new function based on provided signature. This function does not perform
@@ -61,9 +77,9 @@ public:
 	 */
 	virtual Function::Ptr newFunction(const ir::Function::Signature& sig) const;
 
-	virtual Datatype customDatatype(const std::string& dt) const;
+	virtual Datatype customDatatype(const Name& dt) const;
 	virtual Instruction::Ptr assign(ir::Expression::ValueType dest_expr, const ir::Expression::ValueType& val) const;
-	virtual Instruction::Ptr assign(const std::string& name, const ir::Expression::ValueType& val) const;
+	virtual Instruction::Ptr assign(const Name& name, const ir::Expression::ValueType& val) const;
 	void checkAssignmentTypes(const Datatype& dest_type, const Datatype& value_type) const;
 	void checkArgTypes(const Function::Ptr& function_ptr, const FunctionExpression::ArgExpressions& real_args) const;
 	virtual std::vector<Instruction::Ptr> call_func(ir::Expression::ValueType func_expr, std::vector<ir::Expression::ValueType>& args) const;
@@ -92,9 +108,14 @@ public:
 
 	Class::Ptr getCurrentClass() const;
 
+	/**
+	 * Arena where IR nodes are placed during parsing.
+	 */
+	virtual ir::Arena* arena() const;
+
 	// Expressions
 
-	virtual ir::Expression::ValueType identifierExpr(const std::string& name) const;
+	virtual ir::Expression::ValueType identifierExpr(const Name& name) const;
 	virtual ir::Expression::ValueType functionCall(
 		const ir::Expression::ValueType& identifier,
 		std::vector<ir::Expression::ValueType>& args) const;
@@ -103,7 +124,7 @@ public:
 	virtual Expression::ValueType createCastExpr(const Datatype& dest_datatype, Expression::ValueType expr) const;
 	virtual ir::Expression::ValueType thisExpr() const;
 	virtual ir::Expression::ValueType superExpr() const;
-	virtual ir::Expression::ValueType newExpr(const std::string& clas_name) const;
+	virtual ir::Expression::ValueType newExpr(const Name& clas_name) const;
 
 	virtual ir::Expression::ValueType addExpr(
 		const ir::Expression::ValueType& e1,
@@ -155,13 +176,13 @@ public:
 
 	virtual ir::Expression::ValueType dotExpr(
 		const ir::Expression::ValueType& e1,
-		const std::string& id) const;
+		const Name& id) const;
 
 private:
 	std::unique_ptr<vypcomp::Parser> _parser;
 	std::unique_ptr<vypcomp::Scanner> _scanner;
 
-	std::vector<vypcomp::SymbolTable> _tables;
+	vypcomp::ScopedSymbolTable _symbols;
 	Class::Ptr _currClass = nullptr;
 	Function::Ptr _currFunction = nullptr;
 };
@@ -9,22 +9,77 @@
 #include <FlexLexer.h>
 #endif
 
+#include <exception>
+#include <vector>
+
 #include "vypcomp/errors/errors.h"
+#include "vypcomp/parser/source.h"
 #include "bison_parser.tab.hpp"
 #include "location.hh"
 
 namespace vypcomp {
 
+/**
+ * Provides tokens of the whole input scanned ahead of parsing.
+ *
+ * Buffer is filled once and can be consumed by multiple parser
+ * runs (index run and full run) without scanning input again.
+ * If scanning fails, exception is stored and rethrown by the
+ * replaying scanner at the position where it originally occured.
+ * String literals of tokens refer to the scanned source, which is
+ * kept alive by the buffer.
+ */
+class TokenBuffer {
+public:
+	struct Entry {
+		int kind;
+		Parser::semantic_type value;
+		Parser::location_type location;
+	};
+
+public:
+	void push(int kind, const Parser::semantic_type& value, const Parser::location_type& location);
+	void setError(std::exception_ptr error);
+	void setSource(Source::Ptr source);
+
+	const std::vector<Entry>& tokens() const;
+	std::exception_ptr error() const;
+
+private:
+	std::vector<Entry> _tokens;
+	std::exception_ptr _error = nullptr;
+	Source::Ptr _source;
+};
+
+/**
+ * Scans tokens of the source. Flex reads the source through
+ * LexerInput, string literals are views of the source text.
+ */
 class Scanner : public yyFlexLexer{
 public:
-	Scanner(std::istream &in) 
-		: yyFlexLexer(&in)
+	Scanner(std::istream &in)
+		: Scanner(Source::read(in))
 	{};
 	Scanner(std::istream &in, Parser::token::token_kind_type start_token)
-		: yyFlexLexer(&in), start_token(start_token), prepend_first_token(true)
+		: Scanner(Source::read(in), start_token)
+	{};
+	Scanner(Source::Ptr source)
+		: yyFlexLexer(nullptr), source(std::move(source))
+	{};
+	Scanner(Source::Ptr source, Parser::token::token_kind_type start_token)
+		: yyFlexLexer(nullptr), start_token(start_token), prepend_first_token(true), source(std::move(source))
+	{};
+	Scanner(const TokenBuffer &buffer, Parser::token::token_kind_type start_token)
+		: yyFlexLexer(nullptr), start_token(start_token), prepend_first_token(true), buffer(&buffer)
 	{};
 	virtual ~Scanner() {};
 
+	/**
+	 * @brief Scans whole input into token buffer.
+	 */
+	static TokenBuffer scanAll(std::istream &in);
+	static TokenBuffer scanAll(Source::Ptr source);
+
 	// We want to use differeny yylex with yacc.
 	using yyFlexLexer::yylex;
 	virtual int yylex(
@@ -32,10 +87,44 @@ public:
 		Parser::location_type *location
 	);
 
+protected:
+	/**
+	 * Copies next part of the source into buffer of flex.
+	 */
+	virtual int LexerInput(char *buf, int max_size) override;
+
+private:
+	/**
+	 * Generated by flex. Scans next token from the input.
+	 */
+	int scan(
+		Parser::semantic_type *lval,
+		Parser::location_type *location
+	);
+
+	/**
+	 * Provides next token from the token buffer.
+	 */
+	int replay(
+		Parser::semantic_type *lval,
+		Parser::location_type *location
+	);
+
 private:
 	Parser::semantic_type *yylval = nullptr;
 	Parser::token::token_kind_type start_token = Parser::token::PROGRAM_START;
 	bool prepend_first_token = false;
+
+	const TokenBuffer *buffer = nullptr;
+	std::size_t position = 0;
+
+	Source::Ptr source;
+	/// Part of the source passed to flex.
+	std::size_t input_offset = 0;
+	/// Part of the source matched by rules.
+	std::size_t offset = 0;
+	/// Start of string literal being scanned.
+	std::size_t literal_start = 0;
 };
 
 }
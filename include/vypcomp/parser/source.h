@@ -0,0 +1,51 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace vypcomp {
+
+/**
+ * Text of the scanned program.
+ *
+ * Files are mapped into memory instead of being read, other inputs
+ * are read into memory. Tokens refer to the text without copying it,
+ * so the source is shared by scanner and token buffer and lives as
+ * long as any of them.
+ */
+class Source {
+public:
+	using Ptr = std::shared_ptr<const Source>;
+
+	/**
+	 * Maps file into memory. Files that cannot be mapped (pipes,
+	 * empty files) are read.
+	 */
+	static Ptr map(const std::string& filename);
+	static Ptr read(std::istream& in);
+	static Ptr copy(std::string text);
+
+	Source(const Source&) = delete;
+	Source& operator=(const Source&) = delete;
+	~Source();
+
+	std::string_view text() const;
+	bool mapped() const;
+
+private:
+	Source() = default;
+
+private:
+	std::string _text;
+	const char* _mapping = nullptr;
+	std::size_t _mappingSize = 0;
+};
+
+}
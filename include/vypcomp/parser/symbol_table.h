@@ -5,10 +5,12 @@
 
 #pragma once
 
-#include <map>
 #include <variant>
+#include <vector>
 
+#include "vypcomp/ir/arena.h"
 #include "vypcomp/ir/instructions.h"
+#include "vypcomp/ir/name_map.h"
 
 namespace vypcomp {
 
@@ -19,19 +21,89 @@ public:
 			ir::Class::Ptr,
 			ir::AllocaInstruction::Ptr>;
 
-	using Key = std::string;
+	using Key = ir::Name;
 
-	SymbolTable(bool storesFunctions = false);
+	/**
+	 * Arena provided to global table owns all IR nodes created
+	 * while parsing. Nodes are freed when last copy of the table dies.
+	 */
+	SymbolTable(bool storesFunctions = false, ir::Arena::Ptr arena = nullptr);
 
 	bool insert(const std::pair<Key, Symbol>& element);
+	bool erase(const Key& symb);
 
 	bool has(const Key& symb) const;
 	Symbol get(const Key& symb) const;
-	const std::map<Key, Symbol>& data() const;
+	const Symbol* find(const Key& symb) const;
+
+	/**
+	 * Provides symbols sorted by their names.
+	 */
+	std::vector<std::pair<Key, Symbol>> data() const;
+	bool storesFunctions() const;
+	ir::Arena::Ptr arena() const;
 
 private:
-	std::map<Key, Symbol> _table;
+	ir::NameMap<Symbol> _table;
 	bool _storesFunctions = false;
+	ir::Arena::Ptr _arena;
+};
+
+/**
+ * Stack of nested scopes on top of global symbol table.
+ *
+ * All visible symbols are kept in single hash map pointing to the
+ * innermost binding of each name. Bindings form undo log, popping
+ * scope restores bindings that were shadowed inside of it.
+ */
+class ScopedSymbolTable {
+public:
+	using Key = SymbolTable::Key;
+	using Symbol = SymbolTable::Symbol;
+
+	ScopedSymbolTable(const SymbolTable& global);
+
+	const SymbolTable& global() const;
+
+	void push(bool storesFunctions = false);
+	void pop();
+
+	/**
+	 * Number of scopes above global scope.
+	 */
+	std::size_t depth() const;
+
+	/**
+	 * Inserts symbol into the innermost scope.
+	 */
+	bool insert(const std::pair<Key, Symbol>& element);
+
+	const Symbol* find(const Key& symb) const;
+	const Symbol* findCurrent(const Key& symb) const;
+	const Symbol* findGlobal(const Key& symb) const;
+
+private:
+	static constexpr std::size_t None = -1;
+
+	struct Binding {
+		Key key;
+		Symbol symbol;
+		std::size_t scope;
+		std::size_t shadowed;
+	};
+
+	struct Scope {
+		std::size_t firstBinding;
+		bool storesFunctions;
+	};
+
+	const Binding* binding(const Key& symb) const;
+
+private:
+	SymbolTable _global;
+	ir::NameMap<std::size_t> _visible;
+	std::vector<Binding> _bindings;
+	std::vector<Scope> _scopes;
 };
 
 }
@@ -0,0 +1,88 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "vypcomp/driver/batch.h"
+
+using namespace vypcomp;
+
+std::vector<std::string> vypcomp::readManifest(const std::string& path)
+{
+	std::ifstream manifest(path);
+	if (!manifest)
+		throw std::runtime_error("unable to open manifest "+path);
+
+	std::vector<std::string> result;
+	std::string line;
+	while (std::getline(manifest, line)) {
+		auto start = line.find_first_not_of(" \t\r");
+		if (start == std::string::npos || line[start] == '#')
+			continue;
+		auto end = line.find_last_not_of(" \t\r");
+		result.push_back(line.substr(start, end-start+1));
+	}
+	return result;
+}
+
+int vypcomp::compileBatch(const std::vector<std::string>& inputs, std::size_t jobs, const BatchCompiler& compile,
+		std::ostream& out, std::ostream& err)
+{
+	struct Result {
+		int code = 0;
+		std::ostringstream out;
+		std::ostringstream err;
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<Result> results(inputs.size());
+	std::atomic<std::size_t> next = 0;
+	auto worker = [&]() {
+		for (auto i = next++; i < inputs.size(); i = next++) {
+			auto& result = results[i];
+			result.code = compile(inputs[i], result.out, result.err);
+		}
+	};
+
+	std::size_t threads = jobs ? jobs : std::max(1u, std::thread::hardware_concurrency());
+	threads = std::min(threads, inputs.size());
+	std::vector<std::thread> workers;
+	for (std::size_t i = 1; i < threads; i++)
+		workers.emplace_back(worker);
+	worker();
+	for (auto& thread: workers)
+		thread.join();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	int exitCode = 0;
+	std::size_t failed = 0;
+	for (std::size_t i = 0; i < inputs.size(); i++) {
+		auto& result = results[i];
+		out << result.out.str();
+		std::istringstream errors(result.err.str());
+		for (std::string line; std::getline(errors, line);)
+			err << inputs[i] << ": " << line << std::endl;
+		out << inputs[i] << ": " << result.code << std::endl;
+		if (result.code != 0) {
+			failed++;
+			if (exitCode == 0)
+				exitCode = result.code;
+		}
+	}
+
+	err << "compiled " << inputs.size() << " files (" << failed << " failed) in "
+		<< std::fixed << std::setprecision(3) << elapsed.count() << " s, "
+		<< std::setprecision(1) << inputs.size()/elapsed.count() << " files/s" << std::endl;
+
+	return exitCode;
+}
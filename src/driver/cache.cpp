@@ -0,0 +1,247 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "vypcomp/driver/cache.h"
+
+namespace fs = std::filesystem;
+
+using namespace vypcomp;
+
+namespace {
+
+const std::string Extension = ".vc";
+const std::string TemporaryExtension = Extension+".tmp.";
+
+/**
+ * Temporaries older than this are not being written anymore, they
+ * were left by compiler that crashed or was killed while storing.
+ */
+constexpr auto StaleTemporaryAge = std::chrono::minutes(10);
+
+int processId()
+{
+#ifdef _WIN32
+	return _getpid();
+#else
+	return getpid();
+#endif
+}
+
+/**
+ * 128-bit hash built of two FNV-1a lanes with different offset basis,
+ * each finished by splitmix64 finalizer.
+ */
+class Hash {
+public:
+	void update(const char* data, std::size_t size)
+	{
+		for (std::size_t i = 0; i < size; i++) {
+			auto byte = static_cast<unsigned char>(data[i]);
+			_low = (_low ^ byte)*Prime;
+			_high = (_high ^ byte)*Prime;
+		}
+	}
+
+	void update(std::string_view data)
+	{
+		update(data.data(), data.size());
+		// separates consecutive strings
+		update("\0", 1);
+	}
+
+	std::string hex() const
+	{
+		std::ostringstream result;
+		result << std::hex;
+		for (auto lane: {mix(_high), mix(_low)}) {
+			result.width(16);
+			result.fill('0');
+			result << lane;
+		}
+		return result.str();
+	}
+
+private:
+	static std::uint64_t mix(std::uint64_t value)
+	{
+		value ^= value >> 30;
+		value *= 0xbf58476d1ce4e5b9ull;
+		value ^= value >> 27;
+		value *= 0x94d049bb133111ebull;
+		return value ^ (value >> 31);
+	}
+
+	static constexpr std::uint64_t Prime = 0x100000001b3ull;
+
+	std::uint64_t _low = 0xcbf29ce484222325ull;
+	std::uint64_t _high = 0x84222325cbf29ce4ull;
+};
+
+}
+
+Cache::Cache(const fs::path& directory, std::uintmax_t limit, const std::string& configuration):
+	_directory(directory),
+	_limit(limit),
+	_configuration(configuration)
+{
+	fs::create_directories(_directory);
+}
+
+std::string Cache::key(std::string_view source) const
+{
+	Hash hash;
+	hash.update(_configuration);
+	hash.update(source);
+	return hash.hex();
+}
+
+std::optional<std::string> Cache::load(const std::string& key)
+{
+	std::ifstream input(entry(key), std::ios::binary);
+	if (!input) {
+		_misses++;
+		return std::nullopt;
+	}
+
+	std::string code(std::istreambuf_iterator<char>(input), {});
+	_hits++;
+
+	// recently used entries are evicted last
+	std::error_code ignored;
+	fs::last_write_time(entry(key), fs::file_time_type::clock::now(), ignored);
+	return code;
+}
+
+void Cache::store(const std::string& key, const std::string& code)
+{
+	// compilers sharing the cache write their own temporaries
+	auto path = entry(key);
+	auto temporary = path;
+	std::ostringstream suffix;
+	suffix << ".tmp." << processId() << "." << std::this_thread::get_id() << "." << _temporaries++;
+	temporary += suffix.str();
+
+	{
+		std::ofstream output(temporary, std::ios::binary);
+		output << code;
+		if (!output) {
+			std::error_code ignored;
+			fs::remove(temporary, ignored);
+			return;
+		}
+	}
+
+	std::error_code error;
+	fs::rename(temporary, path, error);
+	if (error) {
+		fs::remove(temporary, error);
+		return;
+	}
+
+	evict();
+}
+
+std::size_t Cache::hits() const
+{
+	return _hits;
+}
+
+std::size_t Cache::misses() const
+{
+	return _misses;
+}
+
+std::uintmax_t Cache::bytes() const
+{
+	std::uintmax_t result = 0;
+	std::error_code error;
+	for (auto& file: fs::directory_iterator(_directory, error)) {
+		if (file.path().extension() == Extension)
+			result += file.file_size(error);
+	}
+	return result;
+}
+
+void Cache::report(std::ostream& out) const
+{
+	out << "cache: " << hits() << " hits, " << misses() << " misses, "
+		<< bytes() << " bytes in " << _directory.string() << std::endl;
+}
+
+std::string Cache::hashFile(const fs::path& path)
+{
+	std::ifstream input(path, std::ios::binary);
+	if (!input)
+		throw std::runtime_error("unable to read "+path.string());
+
+	Hash hash;
+	char buffer[64*1024];
+	while (input.read(buffer, sizeof(buffer)) || input.gcount())
+		hash.update(buffer, input.gcount());
+	return hash.hex();
+}
+
+fs::path Cache::entry(const std::string& key) const
+{
+	return _directory/(key+Extension);
+}
+
+void Cache::evict()
+{
+	std::lock_guard<std::mutex> lock(_evictionMutex);
+
+	struct Entry {
+		fs::path path;
+		std::uintmax_t size;
+		fs::file_time_type used;
+	};
+
+	std::vector<Entry> entries;
+	std::uintmax_t total = 0;
+	std::error_code error;
+	auto stale = fs::file_time_type::clock::now() - StaleTemporaryAge;
+	for (auto& file: fs::directory_iterator(_directory, error)) {
+		if (file.path().filename().string().find(TemporaryExtension) != std::string::npos) {
+			if (file.last_write_time(error) < stale && !error)
+				fs::remove(file.path(), error);
+			continue;
+		}
+		if (file.path().extension() != Extension)
+			continue;
+		Entry entry{file.path(), file.file_size(error), file.last_write_time(error)};
+		if (error)
+			continue;
+		total += entry.size;
+		entries.push_back(entry);
+	}
+	if (total <= _limit)
+		return;
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.used < b.used;
+	});
+	for (auto& entry: entries) {
+		if (total <= _limit)
+			break;
+		// entry removed by other compiler is not counted twice
+		if (fs::remove(entry.path, error))
+			total -= entry.size;
+	}
+}
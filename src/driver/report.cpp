@@ -0,0 +1,178 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "vypcomp/driver/report.h"
+
+using namespace vypcomp;
+
+namespace {
+
+// relaxed counters are cheap enough to be always enabled
+std::atomic<std::size_t> allocationCount = 0;
+std::atomic<std::size_t> allocationBytes = 0;
+
+void* allocate(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocationBytes.fetch_add(size, std::memory_order_relaxed);
+	if (auto result = std::malloc(size ? size : 1))
+		return result;
+	throw std::bad_alloc();
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+	return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+TimeReport::Phase::Phase(TimeReport* report, const std::string& name):
+	_report(report)
+{
+	if (!_report)
+		return;
+
+	_start.name = name;
+	_start.allocations = allocations();
+	_start.allocatedBytes = allocatedBytes();
+	_wallStart = std::chrono::steady_clock::now();
+	_cpuStart = std::clock();
+}
+
+TimeReport::Phase::~Phase()
+{
+	if (!_report)
+		return;
+
+	std::chrono::duration<double> wall = std::chrono::steady_clock::now() - _wallStart;
+	Measurement result;
+	result.name = _start.name;
+	result.wall = wall.count();
+	result.cpu = double(std::clock() - _cpuStart)/CLOCKS_PER_SEC;
+	result.allocations = allocations() - _start.allocations;
+	result.allocatedBytes = allocatedBytes() - _start.allocatedBytes;
+	result.peakRss = peakRss();
+	_report->_phases.push_back(result);
+}
+
+const std::vector<TimeReport::Measurement>& TimeReport::phases() const
+{
+	return _phases;
+}
+
+TimeReport::Measurement TimeReport::total() const
+{
+	Measurement result;
+	result.name = "total";
+	for (auto& phase: _phases) {
+		result.wall += phase.wall;
+		result.cpu += phase.cpu;
+		result.allocations += phase.allocations;
+		result.allocatedBytes += phase.allocatedBytes;
+		result.peakRss = std::max(result.peakRss, phase.peakRss);
+	}
+	return result;
+}
+
+void TimeReport::print(std::ostream& out) const
+{
+	auto flags = out.flags();
+	out << std::left << std::setw(12) << "phase" << std::right
+		<< std::setw(12) << "wall ms" << std::setw(12) << "cpu ms"
+		<< std::setw(12) << "allocs" << std::setw(14) << "alloc KiB"
+		<< std::setw(16) << "peak RSS KiB" << std::endl;
+
+	auto row = [&out](const Measurement& phase) {
+		out << std::left << std::setw(12) << phase.name << std::right
+			<< std::fixed << std::setprecision(3)
+			<< std::setw(12) << phase.wall*1000 << std::setw(12) << phase.cpu*1000
+			<< std::setw(12) << phase.allocations << std::setw(14) << phase.allocatedBytes/1024
+			<< std::setw(16) << phase.peakRss << std::endl;
+	};
+	for (auto& phase: _phases)
+		row(phase);
+	row(total());
+	out.flags(flags);
+}
+
+void TimeReport::printJson(std::ostream& out) const
+{
+	auto flags = out.flags();
+	auto object = [&out](const Measurement& phase) {
+		out << "{\"name\": \"" << phase.name << "\""
+			<< std::fixed << std::setprecision(6)
+			<< ", \"wall_s\": " << phase.wall
+			<< ", \"cpu_s\": " << phase.cpu
+			<< ", \"allocations\": " << phase.allocations
+			<< ", \"allocated_bytes\": " << phase.allocatedBytes
+			<< ", \"peak_rss_kib\": " << phase.peakRss << "}";
+	};
+
+	out << "{\"phases\": [";
+	for (std::size_t i = 0; i < _phases.size(); i++) {
+		out << (i ? ", " : "");
+		object(_phases[i]);
+	}
+	out << "], \"total\": ";
+	object(total());
+	out << "}" << std::endl;
+	out.flags(flags);
+}
+
+std::size_t TimeReport::allocations()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+std::size_t TimeReport::allocatedBytes()
+{
+	return allocationBytes.load(std::memory_order_relaxed);
+}
+
+long TimeReport::peakRss()
+{
+#ifndef _WIN32
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return usage.ru_maxrss;
+#endif
+	return 0;
+}
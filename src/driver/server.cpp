@@ -0,0 +1,289 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "vypcomp/driver/server.h"
+
+using namespace vypcomp;
+
+#ifndef _WIN32
+
+namespace {
+
+std::string systemError(const std::string& what)
+{
+	return what+": "+std::strerror(errno);
+}
+
+/**
+ * Path of the socket removed when server is terminated by signal.
+ */
+char terminatedSocket[sizeof(sockaddr_un::sun_path)] = {};
+/**
+ * Worker process terminated together with the server.
+ */
+volatile pid_t terminatedWorker = 0;
+
+void terminate(int signal)
+{
+	if (terminatedWorker > 0)
+		kill(terminatedWorker, signal);
+	unlink(terminatedSocket);
+	_exit(128+signal);
+}
+
+}
+
+Server::Server(const std::string& path, Handler handler, std::size_t threads, Exhausted exhausted):
+	_path(path),
+	_handler(std::move(handler)),
+	_threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+	_exhausted(std::move(exhausted))
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path))
+		throw std::runtime_error("socket path is too long: "+path);
+	std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path)-1);
+
+	_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (_socket < 0)
+		throw std::runtime_error(systemError("unable to create socket"));
+
+	// socket left by previous server would make bind fail
+	unlink(path.c_str());
+	if (bind(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+			|| listen(_socket, SOMAXCONN) < 0) {
+		auto error = systemError("unable to listen on "+path);
+		close(_socket);
+		throw std::runtime_error(error);
+	}
+
+	std::strncpy(terminatedSocket, path.c_str(), sizeof(terminatedSocket)-1);
+	signal(SIGINT, terminate);
+	signal(SIGTERM, terminate);
+}
+
+Server::~Server()
+{
+	close(_socket);
+	unlink(_path.c_str());
+}
+
+void Server::run()
+{
+	if (!_exhausted) {
+		acceptConnections();
+		return;
+	}
+
+	while (!_stopped) {
+		auto worker = fork();
+		if (worker < 0)
+			throw std::runtime_error(systemError("unable to start worker process"));
+		if (worker == 0) {
+			// worker must never return into the caller of run
+			terminatedWorker = 0;
+			try {
+				acceptConnections();
+			} catch (const std::exception& e) {
+				std::fprintf(stderr, "error: %s\n", e.what());
+				_exit(1);
+			}
+			_exit(0);
+		}
+
+		terminatedWorker = worker;
+		int status = 0;
+		while (waitpid(worker, &status, 0) < 0 && errno == EINTR)
+			;
+		terminatedWorker = 0;
+		if (!_stopped && (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+			throw std::runtime_error("server worker process failed");
+	}
+}
+
+void Server::stop()
+{
+	_stopped = true;
+	// accept waiting in run fails once the socket is shut down, the
+	// socket is shared with worker process too
+	shutdown(_socket, SHUT_RDWR);
+}
+
+void Server::acceptConnections()
+{
+	if (_exhausted && pipe(_wakeup) < 0)
+		throw std::runtime_error(systemError("unable to create pipe"));
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < _threads; i++)
+		threads.emplace_back([this]() { serveConnections(); });
+
+	std::string error;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_changed.wait(lock, [this]() { return _pending.size() < _threads; });
+		}
+
+		if (_exhausted) {
+			pollfd events[] = {{_socket, POLLIN, 0}, {_wakeup[0], POLLIN, 0}};
+			if (poll(events, 2, -1) < 0 && errno != EINTR) {
+				error = systemError("unable to wait for connection");
+				break;
+			}
+			if (events[1].revents)
+				break;
+			if (!events[0].revents)
+				continue;
+		}
+
+		int connection = accept(_socket, nullptr, nullptr);
+		if (connection < 0) {
+			// socket shut down by stop of the parent process fails
+			// with EINVAL in worker process
+			if (_stopped || errno == EINVAL)
+				break;
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			error = systemError("unable to accept connection");
+			break;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_pending.push_back(connection);
+		}
+		_changed.notify_all();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_closed = true;
+	}
+	_changed.notify_all();
+	for (auto& thread: threads)
+		thread.join();
+
+	if (_exhausted) {
+		close(_wakeup[0]);
+		close(_wakeup[1]);
+	}
+	if (!error.empty())
+		throw std::runtime_error(error);
+}
+
+void Server::serveConnections()
+{
+	while (true) {
+		int connection;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_changed.wait(lock, [this]() { return !_pending.empty() || _closed; });
+			if (_pending.empty())
+				return;
+			connection = _pending.front();
+			_pending.pop_front();
+		}
+		_changed.notify_all();
+
+		serve(connection);
+		// before the client sees the end of the reply, so that its
+		// next request is accepted by the fresh worker
+		if (_exhausted && _exhausted()) {
+			char byte = 0;
+			[[maybe_unused]] auto written = write(_wakeup[1], &byte, 1);
+		}
+		close(connection);
+	}
+}
+
+void Server::serve(int connection) const
+{
+	std::string source;
+	char buffer[64*1024];
+	while (true) {
+		auto received = recv(connection, buffer, sizeof(buffer), 0);
+		if (received < 0 && errno == EINTR)
+			continue;
+		if (received < 0)
+			return;
+		if (received == 0)
+			break;
+		source.append(buffer, received);
+	}
+
+	std::ostringstream code, errors;
+	auto result = _handler(source, code, errors);
+
+	// exit code on the first line, then code or error message
+	std::ostringstream response;
+	response << result << "\n" << (result == 0 ? code.str() : errors.str());
+	auto reply = response.str();
+	for (std::size_t sent = 0; sent < reply.size();) {
+		// client that went away must not kill the server by SIGPIPE
+		auto written = send(connection, reply.data()+sent, reply.size()-sent, MSG_NOSIGNAL);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written < 0)
+			return;
+		sent += written;
+	}
+}
+
+#else
+
+Server::Server(const std::string& path, Handler handler, std::size_t threads, Exhausted exhausted):
+	_path(path),
+	_handler(std::move(handler)),
+	_threads(threads),
+	_exhausted(std::move(exhausted))
+{
+	throw std::runtime_error("server mode is not supported on this platform");
+}
+
+Server::~Server()
+{
+}
+
+void Server::run()
+{
+}
+
+void Server::stop()
+{
+}
+
+void Server::acceptConnections()
+{
+}
+
+void Server::serveConnections()
+{
+}
+
+void Server::serve(int connection) const
+{
+}
+
+#endif
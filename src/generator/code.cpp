@@ -0,0 +1,151 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <cctype>
+#include <iterator>
+#include <sstream>
+
+#include <vypcomp/generator/code.h>
+
+using namespace vypcomp;
+
+namespace
+{
+
+/**
+ * Splits instruction into tokens separated by whitespace or commas.
+ * Returns position of comment or end of line.
+ */
+std::size_t tokenize(const std::string& line, std::vector<std::string>& tokens)
+{
+    std::size_t i = 0;
+    while (i < line.size())
+    {
+        auto c = line[i];
+        if (std::isspace(static_cast<unsigned char>(c)) || c == ',')
+        {
+            i++;
+            continue;
+        }
+        if (c == '#')
+            return i;
+
+        auto start = i;
+        if (c == '"')
+        {
+            for (i++; i < line.size() && line[i] != '"'; i++)
+            {
+                if (line[i] == '\\')
+                    i++;
+            }
+            i++;
+        }
+        else
+        {
+            while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i])) && line[i] != ',' && line[i] != '#')
+                i++;
+        }
+
+        tokens.push_back(line.substr(start, i - start));
+    }
+
+    return line.size();
+}
+
+}
+
+std::string vypcomp::CodeLine::str() const
+{
+    std::string result = opcode;
+    for (std::size_t i = 0; i < operands.size(); i++)
+        result += (i == 0 ? " " : ", ") + operands[i];
+
+    if (!comment.empty())
+        result += (result.empty() ? "" : " ") + comment;
+
+    return result;
+}
+
+CodeLine& vypcomp::Code::label(std::string name)
+{
+    return emit("LABEL", std::move(name));
+}
+
+CodeLine& vypcomp::Code::comment(const std::string& text)
+{
+    code_lines.push_back({{}, {}, "# " + text});
+    return code_lines.back();
+}
+
+void vypcomp::Code::blank()
+{
+    code_lines.emplace_back();
+}
+
+void vypcomp::Code::append(const Code& code)
+{
+    code_lines.insert(code_lines.end(), code.code_lines.begin(), code.code_lines.end());
+}
+
+void vypcomp::Code::append(Code&& code)
+{
+    if (code_lines.empty())
+    {
+        code_lines = std::move(code.code_lines);
+        return;
+    }
+
+    code_lines.insert(
+        code_lines.end(),
+        std::make_move_iterator(code.code_lines.begin()),
+        std::make_move_iterator(code.code_lines.end())
+    );
+}
+
+Code vypcomp::Code::parse(std::istream& in)
+{
+    Code result;
+    std::string text;
+    while (std::getline(in, text))
+    {
+        std::vector<std::string> tokens;
+        auto comment_start = tokenize(text, tokens);
+
+        CodeLine line;
+        if (!tokens.empty())
+        {
+            line.opcode = tokens[0];
+            line.operands.assign(tokens.begin() + 1, tokens.end());
+        }
+        if (comment_start < text.size())
+            line.comment = text.substr(comment_start);
+
+        result.code_lines.push_back(line);
+    }
+
+    return result;
+}
+
+Code vypcomp::Code::parse(const std::string& text)
+{
+    std::istringstream in(text);
+    return parse(in);
+}
+
+void vypcomp::Code::print(std::ostream& out) const
+{
+    for (auto& line : code_lines)
+        out << line.str() << '\n';
+}
+
+vypcomp::Code::Lines& vypcomp::Code::lines()
+{
+    return code_lines;
+}
+
+const vypcomp::Code::Lines& vypcomp::Code::lines() const
+{
+    return code_lines;
+}
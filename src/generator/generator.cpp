@@ -6,9 +6,15 @@
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
 #include <string_view>
+#include <thread>
 
+#include <vypcomp/generator/code.h>
 #include <vypcomp/generator/generator.h>
+#include <vypcomp/generator/peephole.h>
 #include <vypcomp/ir/instructions.h>
 
 using namespace vypcomp;
@@ -16,14 +22,27 @@ using namespace std::string_literals;
 
 constexpr std::string_view VYPLANG_PREFIX = "vl_";
 
-vypcomp::Generator::Generator(std::string out_filename, bool verbose)
-    : verbose(verbose) 
+vypcomp::Generator::Generator(std::string out_filename, bool verbose, bool optimize, std::size_t threads)
+    : verbose(verbose), optimize(optimize), threads(threads)
 {
     _main_out = std::make_unique<std::ofstream>(out_filename);
 }
 
-vypcomp::Generator::Generator(std::unique_ptr<std::ostream> out, bool verbose)
-    : _main_out(std::move(out)), verbose(verbose)
+vypcomp::Generator::Generator(std::unique_ptr<std::ostream> out, bool verbose, bool optimize, std::size_t threads)
+    : _main_out(std::move(out)), verbose(verbose), optimize(optimize), threads(threads)
+{
+}
+
+vypcomp::Generator::Generator(const Generator& layout)
+    : verbose(layout.verbose),
+    optimize(layout.optimize),
+    class_vtable_addr_mapping(layout.class_vtable_addr_mapping),
+    class_id_mapping(layout.class_id_mapping),
+    class_names_addr(layout.class_names_addr),
+    class_names(layout.class_names),
+    class_vtable_labels(layout.class_vtable_labels),
+    direct_method_labels(layout.direct_method_labels),
+    class_method_vtable_mapping(layout.class_method_vtable_mapping)
 {
 }
 
@@ -34,14 +53,37 @@ const vypcomp::Generator::OutputStream& vypcomp::Generator::get_output() const
 
 void vypcomp::Generator::generate(const vypcomp::SymbolTable& symbol_table)
 {
-    OutputStream& out = *_main_out;
-    out << "#! /bin/vypint\n# VYPcode: 1.0\n# Generated by: xmicka11 & xkubov06\n";
+    // the whole program is collected first and written out at once
+    Code code;
+    generate_program(symbol_table, code);
+    *_main_out << "#! /bin/vypint\n# VYPcode: 1.0\n# Generated by: xmicka11 & xkubov06\n";
+    if (!optimize)
+    {
+        code.print(*_main_out);
+        return;
+    }
+    // optimized code is rewritten by peephole rules before it is written out
+    Peephole peephole;
+    peephole.run(code);
+    code.print(*_main_out);
+    if (verbose)
+        peephole.report(*_main_out);
+}
+
+void vypcomp::Generator::generate_program(const vypcomp::SymbolTable& symbol_table, Code& out)
+{
     // program prolog
     // generates chunks representing vtables and puts them at the stack base
     generate_vtables(symbol_table, out);
+    generate_class_ids(symbol_table, out);
+    if (optimize)
+        analyze_class_hierarchy();
     // proper call to main makes the order of functions meaningless
-    out << "CALL [$SP] " << VYPLANG_PREFIX << "main" << "\n" << "JUMP ENDOFPROGRAM" << std::endl;
+    out.emit("CALL", "[$SP]", VYPLANG_PREFIX.data() + "main"s);
+    out.emit("JUMP", "ENDOFPROGRAM");
 
+    // with the layout fixed, functions and classes are independent of each other
+    std::vector<Job> jobs;
     for (auto [_, symbol] : symbol_table.data()) {
         if (std::holds_alternative<ir::Function::Ptr>(symbol))
         {
@@ -53,13 +95,17 @@ void vypcomp::Generator::generate(const vypcomp::SymbolTable& symbol_table)
             }
             else
             {
-                generate_function(function, std::string(VYPLANG_PREFIX) + function->name(), out);
+                jobs.push_back([function](Generator& generator, Code& code) {
+                    generator.generate_function(function, std::string(VYPLANG_PREFIX) + function->name(), code);
+                });
             }
         }
         else if (std::holds_alternative<ir::Class::Ptr>(symbol))
         {
             auto class_symbol = std::get<ir::Class::Ptr>(symbol);
-            generate_class(class_symbol, out);
+            jobs.push_back([class_symbol](Generator& generator, Code& code) {
+                generator.generate_class(class_symbol, code);
+            });
             //std::cerr << "class generation is not supported yet, skipping " << class_symbol->name() << std::endl;
         }
         else
@@ -67,12 +113,54 @@ void vypcomp::Generator::generate(const vypcomp::SymbolTable& symbol_table)
             throw std::runtime_error("unexpected symbol on top level symbol table");
         }
     }
-    generate_builtin_functions(out);
+    std::vector<Code> buffers(jobs.size());
+    generate_parallel(jobs, buffers);
+    // buffers are joined in symbol table order, so the output doesn't depend on scheduling
+    for (auto& buffer : buffers)
+        out.append(std::move(buffer));
+
+    generate_builtin_functions(symbol_table, out);
     // program epilog
-    out << "LABEL ENDOFPROGRAM";
+    out.label("ENDOFPROGRAM");
+}
+
+void vypcomp::Generator::generate_parallel(const std::vector<Job>& jobs, std::vector<Code>& buffers) const
+{
+    std::atomic<std::size_t> next_job = 0;
+    std::vector<std::exception_ptr> errors(jobs.size());
+    auto worker = [&]() {
+        Generator generator(*this);
+        for (auto job = next_job++; job < jobs.size(); job = next_job++)
+        {
+            try
+            {
+                jobs[job](generator, buffers[job]);
+            }
+            catch (...)
+            {
+                errors[job] = std::current_exception();
+            }
+        }
+    };
+
+    std::size_t thread_count = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min(thread_count, jobs.size());
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < thread_count; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    // report the error of the first symbol, as sequential generation would
+    for (auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
 }
 
-void vypcomp::Generator::generate_vtables(const vypcomp::SymbolTable& symbol_table, OutputStream& out)
+void vypcomp::Generator::generate_vtables(const vypcomp::SymbolTable& symbol_table, Code& out)
 {
     // vtables reside at the stack base, they will be referenced by absolute addresses in their particular instances
     std::size_t address_counter = 0;
@@ -80,7 +168,7 @@ void vypcomp::Generator::generate_vtables(const vypcomp::SymbolTable& symbol_tab
         if (std::holds_alternative<ir::Class::Ptr>(symbol))
         {
             auto class_symbol = std::get<ir::Class::Ptr>(symbol);
-            std::stringstream class_vtable_init;
+            Code class_vtable_init;
             //generate_vtable(class_symbol, class_vtable_init);
             VtableMapping class_vtable;
             VtableMapping super_vtable;
@@ -99,40 +187,126 @@ void vypcomp::Generator::generate_vtables(const vypcomp::SymbolTable& symbol_tab
                     vtable_indices.push_back(method->name());
                 }
             }
+            class_vtable_labels[class_symbol->name()] = class_vtable;
             const auto vtable_size = vtable_indices.size();
-            class_vtable_init << "CREATE $0, " << vtable_size;
+            auto& create = class_vtable_init.emit("CREATE", "$0", vtable_size);
             if (verbose)
-                class_vtable_init << " # vtable for " << class_symbol->name() << std::endl;
-            else
-                class_vtable_init << std::endl;
+                create.comment = "# vtable for " + class_symbol->name();
             for (auto entry_id = 0u; entry_id < vtable_size; entry_id++)
             {
                 auto method_at_index = vtable_indices[entry_id];
                 auto method_label = class_vtable[method_at_index];
-                class_vtable_init << "SETWORD $0, " << entry_id << ", \"" << method_label << "\"\n";
+                class_vtable_init.emit("SETWORD", "$0", entry_id, "\"" + method_label + "\"");
             }
 
-            out << "ADDI $SP, $SP, 1";
+            auto& reserve = out.emit("ADDI", "$SP", "$SP", 1);
             if (verbose)
-                out << " # reserve space for vtable" << std::endl;
-            else
-                out << std::endl;
+                reserve.comment = "# reserve space for vtable";
             // create the chunk and set its values
-            out << class_vtable_init.str();
+            out.append(class_vtable_init);
             // save the chunk id on stack
-            out << "SET [" << address_counter << "], $0\n" << std::endl;
+            out.emit("SET", "[" + std::to_string(address_counter) + "]", "$0");
+            out.blank();
             class_vtable_addr_mapping[class_symbol->name()] = address_counter;
             address_counter++;
         }
     }
 }
 
+void vypcomp::Generator::generate_class_ids(const vypcomp::SymbolTable& symbol_table, Code& out)
+{
+    std::unordered_map<ClassName, std::vector<ir::Class::Ptr>> subclasses;
+    std::vector<ir::Class::Ptr> roots;
+    for (auto [_, symbol] : symbol_table.data()) {
+        if (std::holds_alternative<ir::Class::Ptr>(symbol))
+        {
+            auto class_symbol = std::get<ir::Class::Ptr>(symbol);
+            if (auto base = class_symbol->getBase())
+                subclasses[base->name()].push_back(class_symbol);
+            else
+                roots.push_back(class_symbol);
+        }
+    }
+    if (roots.empty())
+        return;
+
+    // pre-order numbering, so that ids of all subclasses of a class form a continuous range after its id
+    std::function<void(const ir::Class::Ptr&)> assign_id = [&](const ir::Class::Ptr& class_symbol) {
+        std::int64_t id = class_names.size();
+        class_names.push_back(class_symbol->name());
+        for (auto& subclass : subclasses[class_symbol->name()])
+            assign_id(subclass);
+        class_id_mapping[class_symbol->name()] = {id, class_names.size() - 1};
+    };
+    for (auto& root : roots)
+        assign_id(root);
+
+    // class names are needed only by getClass, they reside at the stack base after vtables
+    class_names_addr = class_vtable_addr_mapping.size();
+    auto& reserve = out.emit("ADDI", "$SP", "$SP", 1);
+    if (verbose)
+        reserve.comment = "# reserve space for class names";
+    out.emit("CREATE", "$0", class_names.size());
+    for (std::size_t id = 0; id < class_names.size(); id++)
+    {
+        out.emit("SETWORD", "$0", id, "\"" + class_names[id] + "\"");
+    }
+    out.emit("SET", "[" + std::to_string(class_names_addr) + "]", "$0");
+    out.blank();
+}
+
+void vypcomp::Generator::analyze_class_hierarchy()
+{
+    for (auto& [class_name, vtable] : class_vtable_labels)
+    {
+        auto [first_id, last_id] = class_id_mapping[class_name];
+        for (auto& [method_name, label] : vtable)
+        {
+            // method can be called directly if no subclass overrides it
+            bool overridden = false;
+            for (auto id = first_id + 1; id <= last_id && !overridden; id++)
+            {
+                auto& subclass_vtable = class_vtable_labels[class_names[id]];
+                auto subclass_label = subclass_vtable.find(method_name);
+                overridden = subclass_label == subclass_vtable.end() || subclass_label->second != label;
+            }
+            if (!overridden)
+                direct_method_labels[class_name][method_name] = label;
+        }
+    }
+}
+
+std::optional<vypcomp::Generator::LabelName> vypcomp::Generator::find_direct_method_label(const ClassName& class_name, const MethodName& method_name) const
+{
+    auto class_methods = direct_method_labels.find(class_name);
+    if (class_methods == direct_method_labels.end())
+        return std::nullopt;
+    auto label = class_methods->second.find(method_name);
+    if (label == class_methods->second.end())
+        return std::nullopt;
+    return label->second;
+}
+
+vypcomp::Generator::ClassIdRange vypcomp::Generator::get_class_ids(const ClassName& class_name) const
+{
+    // lookup must not insert, workers share the mapping and unknown class would get id of Object
+    auto ids = class_id_mapping.find(class_name);
+    if (ids == class_id_mapping.end())
+        throw std::runtime_error("Class " + class_name + " has no class id.");
+    return ids->second;
+}
+
 std::string vypcomp::Generator::generate_method_label(const ir::Function::Ptr& method)
 {
     return VYPLANG_PREFIX.data() + method->argTypes()[0].get<ir::Datatype::ClassName>() + "_"s + method->name();
 }
 
-void vypcomp::Generator::generate_class(vypcomp::ir::Class::Ptr input, OutputStream& out)
+std::string vypcomp::Generator::next_label_index()
+{
+    return function_label + "_" + std::to_string(label_counter++);
+}
+
+void vypcomp::Generator::generate_class(vypcomp::ir::Class::Ptr input, Code& out)
 {
     generate_constructor(input, out);
 
@@ -142,21 +316,24 @@ void vypcomp::Generator::generate_class(vypcomp::ir::Class::Ptr input, OutputStr
         {
             if (input->name() == "Object" && method->name() == "toString")
             {
-                out << "LABEL " << VYPLANG_PREFIX << input->name() << "_" << method->name() << std::endl;
-                out << "SET $1, [$SP-1]\n";
-                out << "INT2STRING $0, $1\n";
-                out << "SET $1, [$SP]\n";
-                out << "SUBI $SP, $SP, 2\n"; // clean up return address space + this arg
-                out << "RETURN $1\n" << std::endl;
+                out.label(VYPLANG_PREFIX.data() + input->name() + "_" + method->name());
+                out.emit("SET", "$1", "[$SP-1]");
+                out.emit("INT2STRING", "$0", "$1");
+                out.emit("SET", "$1", "[$SP]");
+                out.emit("SUBI", "$SP", "$SP", 2); // clean up return address space + this arg
+                out.emit("RETURN", "$1");
+                out.blank();
             }
             else if (input->name() == "Object" && method->name() == "getClass")
             {
-                out << "LABEL " << VYPLANG_PREFIX << input->name() << "_" << method->name() << std::endl;
-                out << "SET $1, [$SP-1]\n"; // $1 now has object chunk id
-                out << "GETWORD $0, $1, 1\n"; // type name string has offset 1
-                out << "SET $1, [$SP]\n";
-                out << "SUBI $SP, $SP, 2\n"; // clean up return address space + this arg
-                out << "RETURN $1\n" << std::endl;
+                out.label(VYPLANG_PREFIX.data() + input->name() + "_" + method->name());
+                out.emit("SET", "$1", "[$SP-1]"); // $1 now has object chunk id
+                out.emit("GETWORD", "$2", "$1", 1); // class id has offset 1
+                out.emit("GETWORD", "$0", "[" + std::to_string(class_names_addr) + "]", "$2"); // class name is looked up by id
+                out.emit("SET", "$1", "[$SP]");
+                out.emit("SUBI", "$SP", "$SP", 2); // clean up return address space + this arg
+                out.emit("RETURN", "$1");
+                out.blank();
             }
             else
             {
@@ -166,41 +343,46 @@ void vypcomp::Generator::generate_class(vypcomp::ir::Class::Ptr input, OutputStr
     }
 }
 
-void vypcomp::Generator::generate_constructor(vypcomp::ir::Class::Ptr input, OutputStream& out)
+void vypcomp::Generator::generate_constructor(vypcomp::ir::Class::Ptr input, Code& out)
 {
     AllocaVector args{};
     AllocaVector local_vars{};
+    // implicit initializations are generated outside of any function
+    variable_registers.clear();
     auto object_size = get_object_size(input);
-    out << "LABEL " << VYPLANG_PREFIX << input->name() << "_constructor\n";
+    function_label = VYPLANG_PREFIX.data() + input->name() + "_constructor";
+    label_counter = 0;
+    out.label(function_label);
     // reserver space for object ref
-    out << "ADDI $SP, $SP, 1\n";
+    out.emit("ADDI", "$SP", "$SP", 1);
     // create chunk
-    out << "CREATE $0, " << object_size << "\n";
-    out << "SET [$SP], $0\n";
+    out.emit("CREATE", "$0", object_size);
+    out.emit("SET", "[$SP]", "$0");
     // invoke all parent constructors here
     generate_constructor_chain_invocation(input, out);
     
     auto vtable_address = class_vtable_addr_mapping[input->name()];
-    out << "SETWORD [$SP], 0, [" << vtable_address << "]";
+    auto& set_vtable = out.emit("SETWORD", "[$SP]", 0, "[" + std::to_string(vtable_address) + "]");
     if (verbose)
-        out << " # set vtable pointing to " << input->name() << " vtable" << std::endl;
-    else
-        out << std::endl;
-    // set classname for dynamic casts
-    out << "SETWORD [$SP], 1, \"" << input->name() << "\"\n";
+        set_vtable.comment = "# set vtable pointing to " + input->name() + " vtable";
+    // set class id for dynamic casts and getClass
+    auto& set_class_id = out.emit("SETWORD", "[$SP]", 1, get_class_ids(input->name()).first);
+    if (verbose)
+        set_class_id.comment = "# class id of " + input->name();
 
-    out << "SET $0, [$SP]\n";
-    out << "SUBI $SP, $SP, 1\n"; // clean up 1 local var
-    out << "SET $1, [$SP]\n";
-    out << "SUBI $SP, $SP, 1\n"; // clean up return address space
-    out << "RETURN $1\n" << std::endl;
+    out.emit("SET", "$0", "[$SP]");
+    out.emit("SUBI", "$SP", "$SP", 1); // clean up 1 local var
+    out.emit("SET", "$1", "[$SP]");
+    out.emit("SUBI", "$SP", "$SP", 1); // clean up return address space
+    out.emit("RETURN", "$1");
+    out.blank();
 
     // generate code for user-defined constructor if it exists
     if (input->constructor())
         generate_function(input->constructor(), VYPLANG_PREFIX.data() + input->name() + "_constructor_body", out);
 }
 
-void vypcomp::Generator::generate_constructor_chain_invocation(vypcomp::ir::Class::Ptr input, OutputStream& out)
+void vypcomp::Generator::generate_constructor_chain_invocation(vypcomp::ir::Class::Ptr input, Code& out)
 {
     if (!input) return;
     auto parent = input->getBase();
@@ -209,24 +391,24 @@ void vypcomp::Generator::generate_constructor_chain_invocation(vypcomp::ir::Clas
     // then initialize values of this class
     for (auto& implicit_instr : input->implicit())
     {
-        auto implicit_assignment = dynamic_cast<ir::Assignment*>(implicit_instr.get());
+        auto implicit_assignment = ir::as<ir::Assignment>(implicit_instr.get());
         if (!implicit_assignment) throw std::runtime_error("Implicit instruction was not an assignment:\n" + implicit_instr->str(""));
         auto destination = implicit_assignment->getAlloca();
         auto value_expr = implicit_assignment->getExpr();
         auto attribute_offset = get_object_attribute_offset(input, destination->name());
         if (verbose)
-            out << "# initialize value of " << destination->name() << std::endl;
+            out.comment("initialize value of " + destination->name());
         auto om = OffsetMap();
         auto tmp = TempVarMap();
         generate_expression(value_expr, "$0", om, tmp, out);
-        out << "SETWORD [$SP], " << attribute_offset << ", $0" << std::endl;
+        out.emit("SETWORD", "[$SP]", attribute_offset, "$0");
     }
     // then jump into user-defined constructor body of current class
     if (input->constructor())
     {
-        out << "ADDI $SP, $SP, 2\n";
-        out << "SET [$SP-1], [$SP-2]\n"; // push local variable containing new chunk id as an argument
-        out << "CALL [$SP], " << VYPLANG_PREFIX << input->name() << "_constructor_body" << std::endl;
+        out.emit("ADDI", "$SP", "$SP", 2);
+        out.emit("SET", "[$SP-1]", "[$SP-2]"); // push local variable containing new chunk id as an argument
+        out.emit("CALL", "[$SP]", VYPLANG_PREFIX.data() + input->name() + "_constructor_body");
     }
 }
 
@@ -247,41 +429,61 @@ std::size_t vypcomp::Generator::get_object_size(vypcomp::ir::Class::Ptr input)
     return obj_size;
 }
 
-void vypcomp::Generator::generate_function(vypcomp::ir::Function::Ptr input, std::string label_name, OutputStream& out)
+void vypcomp::Generator::generate_function(vypcomp::ir::Function::Ptr input, std::string label_name, Code& out)
 {
     if (!input) return;
     auto first_block = input->first();
-    out << "LABEL " << label_name << std::endl;
+    function_label = label_name;
+    label_counter = 0;
+    out.label(label_name);
     // TempVarMap holds destination for each expression result 
-    // (currently each expression producing new value gets separate stack location aka "local variable" with lifetime of the whole function execution)
+    // (each expression producing new value gets separate temporary, temporaries of a statement are packed into reusable stack slots)
     TempVarMap temporary_variables_mapping; 
+    temporary_slots.clear();
     // local_variables consists of all possible local variables with variable in sub-scopes as well
     auto local_variables = get_alloca_instructions(first_block->first(), temporary_variables_mapping);
     const auto& args = input->args();
+    // temporaries are owned by local_variables, the ones kept in registers must outlive generated body
+    AllocaVector register_variables;
+    variable_registers.clear();
+    if (optimize)
+    {
+        variable_registers = RegisterAllocator(temporary_variables_mapping).allocate(args, local_variables, first_block);
+        // variables kept in registers don't need stack space
+        auto in_register = std::stable_partition(local_variables.begin(), local_variables.end(), [this](const auto& alloca_instr) {
+            return variable_registers.count(alloca_instr.get()) == 0;
+        });
+        register_variables.assign(in_register, local_variables.end());
+        local_variables.erase(in_register, local_variables.end());
+    }
     arg_count = args.size();
-    variable_count = local_variables.size();
+    variable_count = layout_frame(local_variables);
     
     generate_function_body(input, out, args, local_variables, temporary_variables_mapping);
 }
 
-void vypcomp::Generator::generate_constructor_body(vypcomp::ir::Function::Ptr input, std::string label_name, OutputStream& out) // TODO: OBSOLETE
+void vypcomp::Generator::generate_constructor_body(vypcomp::ir::Function::Ptr input, std::string label_name, Code& out) // TODO: OBSOLETE
 {
     if (!input) return;
     auto first_block = input->first();
-    out << "LABEL " << label_name << std::endl;
+    function_label = label_name;
+    label_counter = 0;
+    out.label(label_name);
     // TempVarMap holds destination for each expression result 
-    // (currently each expression producing new value gets separate stack location aka "local variable" with lifetime of the whole function execution)
+    // (each expression producing new value gets separate temporary, temporaries of a statement are packed into reusable stack slots)
     TempVarMap temporary_variables_mapping;
+    temporary_slots.clear();
     // local_variables consists of all possible local variables with variable in sub-scopes as well
     auto local_variables = get_alloca_instructions(first_block->first(), temporary_variables_mapping);
     const auto& args = input->args();
+    variable_registers.clear();
     arg_count = args.size();
-    variable_count = local_variables.size();
+    variable_count = layout_frame(local_variables);
 
     generate_function_body(input, out, args, local_variables, temporary_variables_mapping);
 }
 
-void vypcomp::Generator::generate_function_body(vypcomp::ir::Function::Ptr input, OutputStream& out, const AllocaVector& args, const AllocaVector& local_variables, TempVarMap& temporary_variables_mapping)
+void vypcomp::Generator::generate_function_body(vypcomp::ir::Function::Ptr input, Code& out, const AllocaVector& args, const AllocaVector& local_variables, TempVarMap& temporary_variables_mapping)
 {
     OffsetMap variable_offsets{};
     if (arg_count != 0)
@@ -297,14 +499,13 @@ void vypcomp::Generator::generate_function_body(vypcomp::ir::Function::Ptr input
     if (variable_count != 0)
     {
         // if there are any variables in the possible instruction stream, reserve stack space for them
-        out << "ADDI $SP, $SP, " << variable_count << std::endl;
+        out.emit("ADDI", "$SP", "$SP", variable_count);
         // shift the offsets of function arguments
         std::for_each(variable_offsets.begin(), variable_offsets.end(), [this](auto& ptr_offset_pair) { ptr_offset_pair.second += variable_count;  });
         // insert $SP offsets of local variables
-        for (std::size_t i = 0; i < variable_count; i++)
+        for (auto& alloca_instr : local_variables)
         {
-            auto& alloca_instr = local_variables[i];
-            std::int64_t offset = variable_count - i - 1; // last variable is [$SP]
+            std::int64_t offset = variable_count - frame_positions.at(alloca_instr.get()) - 1; // last position is [$SP]
             variable_offsets[alloca_instr.get()] = offset;
         }
     }
@@ -313,26 +514,42 @@ void vypcomp::Generator::generate_function_body(vypcomp::ir::Function::Ptr input
         // dump offsets of all local symbols into code
         for (auto& alloca_instr : args)
         {
-            auto offset = variable_offsets[alloca_instr.get()];
-            out << "# [$SP-" << offset << "] " << alloca_instr->name() << std::endl;
+            out.comment(get_variable_location(alloca_instr.get(), variable_offsets) + " " + alloca_instr->name());
         }
         for (auto& alloca_instr : local_variables)
         {
             auto offset = variable_offsets[alloca_instr.get()];
-            out << "# [$SP-" << offset << "] " << alloca_instr->name() << std::endl;
+            out.comment("[$SP-" + std::to_string(offset) + "] " + alloca_instr->name());
+        }
+        std::vector<std::pair<DestinationName, std::string>> register_variables;
+        for (auto& [alloca_ptr, reg] : variable_registers)
+        {
+            if (!variable_offsets.count(alloca_ptr))
+                register_variables.emplace_back(reg, alloca_ptr->name());
+        }
+        std::sort(register_variables.begin(), register_variables.end());
+        for (auto& [reg, name] : register_variables)
+        {
+            out.comment(reg + " " + name);
         }
     }
+    for (auto& alloca_instr : args)
+    {
+        // arguments kept in registers are loaded once in prolog
+        if (auto reg = variable_registers.find(alloca_instr.get()); reg != variable_registers.end())
+            out.emit("SET", reg->second, "[$SP-" + std::to_string(variable_offsets[alloca_instr.get()]) + "]");
+    }
 
     generate_block(input->first(), variable_offsets, temporary_variables_mapping, out);
 
     if (!is_return(input->first()->last()))
     {
-        out << "SET $0, 0" << std::endl;
+        out.emit("SET", "$0", 0);
         generate_return(out);
     }
 }
 
-void vypcomp::Generator::generate_block(vypcomp::ir::BasicBlock::Ptr in_block, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, OutputStream& out)
+void vypcomp::Generator::generate_block(vypcomp::ir::BasicBlock::Ptr in_block, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, Code& out)
 {
     if (in_block == nullptr)
     {
@@ -344,7 +561,7 @@ void vypcomp::Generator::generate_block(vypcomp::ir::BasicBlock::Ptr in_block, O
     }
 }
 
-void vypcomp::Generator::generate_return(OutputStream& out)
+void vypcomp::Generator::generate_return(Code& out)
 {
     //  high address
     // |  ...    | < SP after prolog
@@ -361,26 +578,26 @@ void vypcomp::Generator::generate_return(OutputStream& out)
     if (variable_count != 0)
     {
         // reclaim stack of local variables
-        out << "SUBI $SP, $SP, " << variable_count;
+        auto& reclaim = out.emit("SUBI", "$SP", "$SP", variable_count);
         if (verbose)
-            out << " # [$SP] is now return address\n";
-        else
-            out << "\n";
+            reclaim.comment = "# [$SP] is now return address";
     }
     // reclaim stack of arguments, move by at least one (return address)
-    out << "SET $1, [$SP]" << "\n";
-    out << "SUBI $SP, $SP, " << arg_count+1 << "\n";
-    out << "RETURN $1\n" << std::endl;
+    out.emit("SET", "$1", "[$SP]");
+    out.emit("SUBI", "$SP", "$SP", arg_count+1);
+    out.emit("RETURN", "$1");
+    out.blank();
 }
 
-void vypcomp::Generator::generate_instruction(vypcomp::ir::Instruction::Ptr input, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, OutputStream& out)
+void vypcomp::Generator::generate_instruction(vypcomp::ir::Instruction::Ptr input, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, Code& out)
 {
-    if (auto instr = dynamic_cast<ir::AllocaInstruction*>(input.get()))
+    switch (input->kind())
     {
+    case ir::Instruction::Kind::Alloca:
         return; // these are handled elsewhere
-    }
-    else if (auto instr = dynamic_cast<ir::Assignment*>(input.get()))
+    case ir::Instruction::Kind::Assignment:
     {
+        auto instr = static_cast<ir::Assignment*>(input.get());
         auto destination = instr->getAlloca();
         auto expr = instr->getExpr();
         if (!destination) 
@@ -390,133 +607,143 @@ void vypcomp::Generator::generate_instruction(vypcomp::ir::Instruction::Ptr inpu
         }
         else
         {
-            auto variable_offset_iter = variable_offsets.find(destination.get());
-            if (variable_offset_iter == variable_offsets.end()) throw std::runtime_error("Assignment destination was not found while generating assignment");
-            auto& [_, variable_offset] = *variable_offset_iter;
+            auto variable_location = get_variable_location(destination.get(), variable_offsets);
+            if ((expr->is_simple() || ir::is<ir::BinaryOpExpression>(expr)) && variable_registers.count(destination.get()))
+            {
+                // simple values and results of operations are set into the variable register directly
+                generate_expression(expr, variable_location, variable_offsets, temporary_variables_mapping, out);
+                break;
+            }
             auto result_register = std::string("$0");
             generate_expression(expr, result_register, variable_offsets, temporary_variables_mapping, out);
-            out << "SET [$SP-" << variable_offset << "], " << result_register << std::endl;
+            out.emit("SET", variable_location, result_register);
         }
+        break;
     }
-    else if (auto instr = dynamic_cast<ir::ObjectAssignment*>(input.get()))
+    case ir::Instruction::Kind::ObjectAssignment:
     {
+        auto instr = static_cast<ir::ObjectAssignment*>(input.get());
         auto destination = instr->getTarget();
         auto value_expr = instr->getExpr();
-        ir::ObjectAttributeExpression* target_expression = dynamic_cast<ir::ObjectAttributeExpression*>(destination.get());
+        ir::ObjectAttributeExpression* target_expression = ir::as<ir::ObjectAttributeExpression>(destination.get());
         if (!target_expression)
         {
             throw std::runtime_error("Target of object assignment is not an object attribute, but instead: " + destination->to_string());
         }
         auto object_alloca = target_expression->getObject();
-        auto object_stack_offset = find_offset(object_alloca.get(), variable_offsets);
-        if (!object_stack_offset) throw std::runtime_error("Target of object attribute assignment was not found: " + object_alloca->name());
+        auto object_location = get_variable_location(object_alloca.get(), variable_offsets);
         auto attribute_name = target_expression->getAttribute()->name();
         auto attribute_chunk_offset = get_object_attribute_offset(target_expression->getClass(), attribute_name);
         generate_expression(value_expr, "$1", variable_offsets, temporary_variables_mapping, out);
-        out << "SETWORD [$SP-" << object_stack_offset.value() << "], " << attribute_chunk_offset << ", " << "$1" << std::endl;
+        out.emit("SETWORD", object_location, attribute_chunk_offset, "$1");
+        break;
     }
-    else if (auto instr = dynamic_cast<ir::Return*>(input.get()))
+    case ir::Instruction::Kind::Return:
     {
+        auto instr = static_cast<ir::Return*>(input.get());
         if (!instr->isVoid())
         {
             auto expr = instr->getExpr();
             generate_expression(expr, "$0", variable_offsets, temporary_variables_mapping, out);
         }
         generate_return(out);
+        break;
     }
-    else if (auto instr = dynamic_cast<ir::BranchInstruction*>(input.get()))
+    case ir::Instruction::Kind::Branch:
     {
-        static std::uint64_t if_label_index = 0;
-        auto str_label_index = std::to_string(if_label_index++);
+        auto instr = static_cast<ir::BranchInstruction*>(input.get());
+        auto str_label_index = next_label_index();
         auto expr = instr->getExpr();
         auto if_block = instr->getIf();
         auto else_block = instr->getElse();
         auto label_if = "if_branch_"s + str_label_index;
         auto label_else = "else_branch_"s + str_label_index;
         auto label_end = "endif_label_"s + str_label_index;
-        std::stringstream if_instruction_stream, else_instruction_stream;
-
-        generate_block(if_block, variable_offsets, temporary_variables_mapping, if_instruction_stream);
-        generate_block(else_block, variable_offsets, temporary_variables_mapping, else_instruction_stream);
 
         generate_expression(expr, "$0", variable_offsets, temporary_variables_mapping, out);
-        out << "JUMPZ " << label_else << ", $0\n";
+        out.emit("JUMPZ", label_else, "$0");
 
-        out << "LABEL " << label_if << "\n";
-        if (if_instruction_stream.rdbuf()->in_avail())
-            out << if_instruction_stream.rdbuf();
-        out << "JUMP " << label_end << "\n";
+        // blocks are appended in place, nested control flow is never copied
+        out.label(label_if);
+        generate_block(if_block, variable_offsets, temporary_variables_mapping, out);
+        out.emit("JUMP", label_end);
 
-        out << "LABEL " << label_else << "\n";
-        if (else_instruction_stream.rdbuf()->in_avail())
-            out << else_instruction_stream.rdbuf();
-        out << "JUMP " << label_end << "\n";
+        out.label(label_else);
+        generate_block(else_block, variable_offsets, temporary_variables_mapping, out);
+        out.emit("JUMP", label_end);
 
-        out << "LABEL " << label_end << std::endl;
+        out.label(label_end);
+        break;
     }
-    else if (auto instr = dynamic_cast<ir::LoopInstruction*>(input.get()))
+    case ir::Instruction::Kind::Loop:
     {
-        static std::uint64_t while_label = 0;
-        auto str_while_label = std::to_string(while_label++);
+        auto instr = static_cast<ir::LoopInstruction*>(input.get());
+        auto str_while_label = next_label_index();
         auto expr = instr->getExpr();
         auto body_block = instr->getBody();
         auto condition_label = "while_cond_"s + str_while_label;
         auto end_label = "while_end_"s + str_while_label;
 
-        std::stringstream body_instruction_stream;
-        generate_block(body_block, variable_offsets, temporary_variables_mapping, body_instruction_stream);
-
-        out << "LABEL " << condition_label << "\n";
+        out.label(condition_label);
         generate_expression(expr, "$0", variable_offsets, temporary_variables_mapping, out);
-        out << "JUMPZ " << end_label << ", $0\n";
-        if (body_instruction_stream.rdbuf()->in_avail())
-            out << body_instruction_stream.rdbuf();
-        out << "JUMP " << condition_label << "\n";
-        out << "LABEL " << end_label << std::endl;
+        out.emit("JUMPZ", end_label, "$0");
+        generate_block(body_block, variable_offsets, temporary_variables_mapping, out);
+        out.emit("JUMP", condition_label);
+        out.label(end_label);
+        break;
     }
-    else
+    default:
     {
         std::cerr << "skipping past instruction:\n" << input->str("") << std::endl;
         //throw std::runtime_error("Generator encountered unsupported IR instruction type.");
     }
+    }
 }
 
-void vypcomp::Generator::generate_expression(ir::Expression::ValueType input, DestinationName destination, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, OutputStream& out)
+void vypcomp::Generator::generate_expression(ir::Expression::ValueType input, DestinationName destination, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, Code& out)
 {   
-    if (auto lit_expr = dynamic_cast<ir::LiteralExpression*>(input.get()))
+    switch (input->kind())
     {
+    case ir::Expression::Kind::Literal:
+    case ir::Expression::Kind::NullObject:
+    {
+        auto lit_expr = static_cast<ir::LiteralExpression*>(input.get());
         auto lit_value = lit_expr->getValue();
         if (destination.size() == 0) throw std::runtime_error("Can't assign literal expression to null.");
-        out << "SET " << destination << ", " << lit_value.vypcode_representation() << std::endl;
+        out.emit("SET", destination, lit_value.vypcode_representation());
+        break;
     }
-    else if (auto constr_expr = dynamic_cast<ir::ConstructorExpression*>(input.get()))
+    case ir::Expression::Kind::Constructor:
     {
+        auto constr_expr = static_cast<ir::ConstructorExpression*>(input.get());
         // reserve stack space
-        out << "ADDI $SP, $SP, 1";
+        auto& reserve = out.emit("ADDI", "$SP", "$SP", 1);
         if (verbose)
-            out << " # reserved stack for return address" << std::endl;
-        else
-            out << std::endl;
+            reserve.comment = "# reserved stack for return address";
         // shift local variable offsets by the amount stack increased
         std::for_each(variable_offsets.begin(), variable_offsets.end(), [](auto& ptr_offset_pair) { ptr_offset_pair.second += 1ll;  });
-        out << "CALL [$SP], " << VYPLANG_PREFIX << constr_expr->getFunctionName() << "_constructor\n";
+        out.emit("CALL", "[$SP]", VYPLANG_PREFIX.data() + constr_expr->getFunctionName() + "_constructor");
         if (destination.size() && destination != "$0")
-            out << "SET " << destination << ", $0" << std::endl;
+            out.emit("SET", destination, "$0");
         // shift local variable offsets back, since callee cleaned up the stack
         std::for_each(variable_offsets.begin(), variable_offsets.end(), [](auto& ptr_offset_pair) { ptr_offset_pair.second -= 1ll;  });
 
+        break;
     }
-    else if (auto method_exp = dynamic_cast<ir::MethodExpression*>(input.get()))
+    case ir::Expression::Kind::Method:
     {
+        auto method_exp = static_cast<ir::MethodExpression*>(input.get());
         auto function_args = method_exp->getArgs();
         const auto args_count = function_args.size();
         auto context_object = method_exp->getContextObj();
+        // method that is not overridden in any subclass of the static class is called without vtable lookup
+        std::optional<LabelName> direct_label;
+        if (!ir::is<ir::SuperExpression>(context_object))
+            direct_label = find_direct_method_label(context_object->type().get<ir::Datatype::ClassName>(), method_exp->getFunction()->name());
         // reserve stack space
-        out << "ADDI $SP, $SP, " << args_count + 1; // at least one for return address, last arg is $SP-1
+        auto& reserve = out.emit("ADDI", "$SP", "$SP", args_count + 1); // at least one for return address, last arg is $SP-1
         if (verbose)
-            out << " # reserved stack for " << args_count << " function parameters + return address" << std::endl;
-        else
-            out << std::endl;
+            reserve.comment = "# reserved stack for " + std::to_string(args_count) + " function parameters + return address";
         // shift local variable offsets by the amount stack increased
         std::for_each(variable_offsets.begin(), variable_offsets.end(), [args_count](auto& ptr_offset_pair) { ptr_offset_pair.second += args_count + 1ll;  });
         // calculate each argument expression and store it on proper stack position
@@ -525,28 +752,33 @@ void vypcomp::Generator::generate_expression(ir::Expression::ValueType input, De
             const ir::Expression::ValueType& argument = function_args[i];
             generate_expression(argument, "$0", variable_offsets, temporary_variables_mapping, out);
             std::int64_t offset = args_count - i; // first argument has lowest stack address, last is $SP-1
-            out << "SET " << "[$SP-" << offset << "], $0" << std::endl;
+            out.emit("SET", "[$SP-" + std::to_string(offset) + "]", "$0");
             if (i == 0)
             {
-                if (auto superexp = dynamic_cast<ir::SuperExpression*>(context_object.get()))
+                if (ir::is<ir::SuperExpression>(context_object))
                 {
-                    // super suppresses lookup of method in vtable and hardcodes the first implementation of such method
+                    // super calls suppress lookup of method in vtable, the label is hardcoded
                     continue;
                 }
+                else if (direct_label)
+                {
+                    // devirtualized call hardcodes the label, but must still fault on null object like the vtable lookup
+                    out.emit("GETWORD", "$1", "$0", 0);
+                }
                 else
                 {
                     // first argument is the object being having the method called
-                    out << "GETWORD $1, $0, 0\n"; // get vtable chunk id
+                    out.emit("GETWORD", "$1", "$0", 0); // get vtable chunk id
                     auto method_offset_map = class_method_vtable_mapping[context_object->type().get<ir::Datatype::ClassName>()];
-                    auto method_offset = (*method_offset_map)[method_exp->getFunction()->name()];
-                    out << "GETWORD $2, $1, " << method_offset << "\n"; // $2 now should now have chunk id of chunk with label name
+                    auto method_offset = method_offset_map->at(method_exp->getFunction()->name());
+                    out.emit("GETWORD", "$2", "$1", method_offset); // $2 now should now have chunk id of chunk with label name
                     // store the chunk id of label in the to-be return address
-                    out << "SET [$SP], $2" << std::endl;
+                    out.emit("SET", "[$SP]", "$2");
                 }
             }
         }
         // jump into subroutine
-        if (auto superexp = dynamic_cast<ir::SuperExpression*>(context_object.get()))
+        if (auto superexp = ir::as<ir::SuperExpression>(context_object.get()))
         {
             auto child_class = superexp->getClass();
             auto parent_class = child_class->getBase();
@@ -554,23 +786,29 @@ void vypcomp::Generator::generate_expression(ir::Expression::ValueType input, De
             auto original_method = parent_class->getMethod(method_exp->getFunction()->name());
             std::string label_name = generate_method_label(original_method);
             // in case it was accessed through super object, ignore vtables and get the first implementation
-            out << "CALL [$SP], " << label_name << std::endl;
+            out.emit("CALL", "[$SP]", label_name);
+        }
+        else if (direct_label)
+        {
+            out.emit("CALL", "[$SP]", *direct_label);
         }
         else
         {
             // [$SP] holds the chunk id of the label to be jumped to in case the jump resolution is vtable based
-            out << "CALL [$SP], [$SP]" << std::endl;
+            out.emit("CALL", "[$SP]", "[$SP]");
         }
 
         // return value register is always $0
         if (destination.size() && destination != "$0")
-            out << "SET " << destination << ", $0" << std::endl;
+            out.emit("SET", destination, "$0");
         // shift local variable offsets back, since callee cleaned up the stack
         std::for_each(variable_offsets.begin(), variable_offsets.end(), [args_count](auto& ptr_offset_pair) { ptr_offset_pair.second -= args_count + 1ll;  });
+        break;
     }
-    else if (auto func_expr = dynamic_cast<ir::FunctionExpression*>(input.get()))
+    case ir::Expression::Kind::Function:
     {
-        std::string func_name = func_expr->getFunction()->name();
+        auto func_expr = static_cast<ir::FunctionExpression*>(input.get());
+        const ir::Name& func_name = func_expr->getFunction()->name();
 
         auto function_args = func_expr->getArgs();
         const auto args_count = function_args.size();
@@ -587,27 +825,38 @@ void vypcomp::Generator::generate_expression(ir::Expression::ValueType input, De
                 switch (prim_type)
                 {
                 case ir::PrimitiveDatatype::Int:
-                    out << "WRITEI $0" << std::endl;
+                    out.emit("WRITEI", "$0");
                     break;
                 case ir::PrimitiveDatatype::String:
-                    out << "WRITES $0" << std::endl;
+                    out.emit("WRITES", "$0");
                     break;
                 case ir::PrimitiveDatatype::Float:
-                    out << "WRITEF $0" << std::endl;
+                    out.emit("WRITEF", "$0");
                     break;
                 default:
                     throw std::runtime_error("Unexpected primitive type in print.");
                 }
             }
         }
+        else if (optimize && func_name == "length")
+        {
+            // builtins without control flow are expanded in place of the call
+            generate_expression(function_args[0], "$0", variable_offsets, temporary_variables_mapping, out);
+            if (destination.size())
+                out.emit("GETSIZE", destination, "$0");
+        }
+        else if (optimize && (func_name == "readInt" || func_name == "readFloat" || func_name == "readString"))
+        {
+            auto read_instruction = func_name == "readInt" ? "READI" : func_name == "readFloat" ? "READF" : "READS";
+            // input is consumed even if the value is discarded
+            out.emit(read_instruction, destination.size() ? destination : "$0");
+        }
         else
         {
             // reserve stack space
-            out << "ADDI $SP, $SP, " << args_count + 1; // at least one for return address, last arg is $SP-1
+            auto& reserve = out.emit("ADDI", "$SP", "$SP", args_count + 1); // at least one for return address, last arg is $SP-1
             if (verbose)
-                out << " # reserved stack for " << args_count << " function parameters + return address" << std::endl;
-            else
-                out << std::endl;
+                reserve.comment = "# reserved stack for " + std::to_string(args_count) + " function parameters + return address";
             // shift local variable offsets by the amount stack increased
             std::for_each(variable_offsets.begin(), variable_offsets.end(), [args_count](auto& ptr_offset_pair) { ptr_offset_pair.second += args_count + 1ll;  });
             // calculate each argument expression and store it on proper stack position
@@ -616,43 +865,89 @@ void vypcomp::Generator::generate_expression(ir::Expression::ValueType input, De
                 const ir::Expression::ValueType& argument = function_args[i];
                 generate_expression(argument, "$0", variable_offsets, temporary_variables_mapping, out);
                 std::int64_t offset = args_count - i; // first argument has lowest stack address, last is $SP-1
-                out << "SET " << "[$SP-" << offset << "], $0" << std::endl;
+                out.emit("SET", "[$SP-" + std::to_string(offset) + "]", "$0");
             }
             // jump into subroutine
-            out << "CALL [$SP], " << VYPLANG_PREFIX.data() + func_name << std::endl;
+            out.emit("CALL", "[$SP]", VYPLANG_PREFIX.data() + func_name);
             // return value register is always $0
             if (destination.size() && destination != "$0")
-                out << "SET " << destination << ", $0" << std::endl;
+                out.emit("SET", destination, "$0");
             // shift local variable offsets back, since callee cleaned up the stack
             std::for_each(variable_offsets.begin(), variable_offsets.end(), [args_count](auto& ptr_offset_pair) { ptr_offset_pair.second -= args_count + 1ll;  });
         }
+        break;
     }
-    else if (auto symb_expr = dynamic_cast<ir::SymbolExpression*>(input.get()))
+    case ir::Expression::Kind::Symbol:
+    case ir::Expression::Kind::Super:
     {
+        auto symb_expr = static_cast<ir::SymbolExpression*>(input.get());
         if (destination.size() == 0) throw std::runtime_error("Can't assign symbol expression to null.");
         auto alloca_src = symb_expr->getValue();
-        auto find_result = variable_offsets.find(alloca_src.get());
-        if (find_result == variable_offsets.end()) throw std::runtime_error("Did not find assigned offset to alloca instruction.");
-        auto& [_, offset] = *find_result;
-        out << "SET " << destination << ", " << "[$SP-" << offset << "]" << std::endl;
+        out.emit("SET", destination, get_variable_location(alloca_src.get(), variable_offsets));
+        break;
     }
-    else if (auto binop = dynamic_cast<ir::BinaryOpExpression*>(input.get()))
+    case ir::Expression::Kind::Add:
+    case ir::Expression::Kind::Subtract:
+    case ir::Expression::Kind::Multiply:
+    case ir::Expression::Kind::Divide:
+    case ir::Expression::Kind::Comparison:
+    case ir::Expression::Kind::And:
+    case ir::Expression::Kind::Or:
     {
+        auto binop = static_cast<ir::BinaryOpExpression*>(input.get());
+        if (RegisterAllocator::is_allocated_register(destination))
+        {
+            // consumer reads the result from register, not from $0
+            generate_binaryop(std::static_pointer_cast<ir::BinaryOpExpression>(input), destination, variable_offsets, temporary_variables_mapping, out, true);
+            break;
+        }
         auto result_destination = get_expr_destination(binop, temporary_variables_mapping, variable_offsets);
-        generate_binaryop(std::dynamic_pointer_cast<ir::BinaryOpExpression>(input), result_destination, variable_offsets, temporary_variables_mapping, out);
+        generate_binaryop(std::static_pointer_cast<ir::BinaryOpExpression>(input), result_destination, variable_offsets, temporary_variables_mapping, out);
+        break;
     }
-    else if (auto objattrexp = dynamic_cast<ir::ObjectAttributeExpression*>(input.get()))
+    case ir::Expression::Kind::Concat:
     {
+        auto& operands = static_cast<ir::ConcatExpression*>(input.get())->getOperands();
+        for (auto& operand : operands)
+        {
+            if (!operand->is_simple())
+                generate_expression(operand, get_expr_destination(operand.get(), temporary_variables_mapping, variable_offsets), variable_offsets, temporary_variables_mapping, out);
+        }
+        // call concatStr subroutine with the operands followed by their count
+        std::int64_t args_count = operands.size() + 1;
+        out.emit("ADDI", "$SP", "$SP", args_count + 1);
+        std::for_each(variable_offsets.begin(), variable_offsets.end(), [args_count](auto& ptr_offset_pair) { ptr_offset_pair.second += args_count + 1ll;  });
+        for (std::size_t i = 0; i < operands.size(); i++)
+        {
+            auto argument_location = "[$SP-"s + std::to_string(args_count - i) + "]";
+            if (operands[i]->is_simple())
+                generate_expression(operands[i], argument_location, variable_offsets, temporary_variables_mapping, out);
+            else
+                out.emit("SET", argument_location, get_expr_destination(operands[i].get(), temporary_variables_mapping, variable_offsets));
+        }
+        out.emit("SET", "[$SP-1]", operands.size());
+        std::for_each(variable_offsets.begin(), variable_offsets.end(), [args_count](auto& ptr_offset_pair) { ptr_offset_pair.second -= args_count + 1ll;  });
+        out.emit("CALL", "[$SP]", "concatStr");
+        auto result_destination = get_expr_destination(input.get(), temporary_variables_mapping, variable_offsets);
+        out.emit("SET", result_destination, "$0");
+        if (destination.size() && destination != "$0" && destination != result_destination)
+            out.emit("SET", destination, "$0");
+        break;
+    }
+    case ir::Expression::Kind::ObjectAttribute:
+    {
+        auto objattrexp = static_cast<ir::ObjectAttributeExpression*>(input.get());
         auto result_destination = get_expr_destination(objattrexp, temporary_variables_mapping, variable_offsets);
         auto attr_offset = get_object_attribute_offset(objattrexp->getClass(), objattrexp->getAttribute()->name());
         auto object_alloca = objattrexp->getObject();
-        auto object_address = find_offset(object_alloca.get(), variable_offsets);
-        if (!object_address) throw std::runtime_error("Attempt to read from object whose stack address was not found: " + object_alloca->name());
-        out << "GETWORD $0, [$SP-" << object_address.value() << "], " << attr_offset << std::endl;
-        out << "SET " << result_destination << ", $0" << std::endl;
+        auto object_location = get_variable_location(object_alloca.get(), variable_offsets);
+        out.emit("GETWORD", "$0", object_location, attr_offset);
+        out.emit("SET", result_destination, "$0");
+        break;
     }
-    else if (auto string_cast_expr = dynamic_cast<ir::StringCastExpression*>(input.get()))
+    case ir::Expression::Kind::StringCast:
     {
+        auto string_cast_expr = static_cast<ir::StringCastExpression*>(input.get());
         auto operand = string_cast_expr->getOperand();
         std::string operand_location;
         if (operand->is_simple())
@@ -665,11 +960,13 @@ void vypcomp::Generator::generate_expression(ir::Expression::ValueType input, De
         }
         generate_expression(operand, operand_location, variable_offsets, temporary_variables_mapping, out);
         auto expr_destination = get_expr_destination(string_cast_expr, temporary_variables_mapping, variable_offsets);
-        out << "INT2STRING $0, " << operand_location << "\n";
-        out << "SET " << expr_destination << ", $0" << std::endl;
+        out.emit("INT2STRING", "$0", operand_location);
+        out.emit("SET", expr_destination, "$0");
+        break;
     }
-    else if (auto not_expr = dynamic_cast<ir::NotExpression*>(input.get()))
+    case ir::Expression::Kind::Not:
     {
+        auto not_expr = static_cast<ir::NotExpression*>(input.get());
         auto operand = not_expr->getOperand();
         std::string operand_location;
         if (operand->is_simple())
@@ -682,13 +979,14 @@ void vypcomp::Generator::generate_expression(ir::Expression::ValueType input, De
         }
         auto expr_destination = get_expr_destination(not_expr, temporary_variables_mapping, variable_offsets);
         generate_expression(operand, operand_location, variable_offsets, temporary_variables_mapping, out);
-        out << "NOT $0, " << operand_location << "\n";
-        out << "SET " << expr_destination << ", $0" << std::endl;
+        out.emit("NOT", "$0", operand_location);
+        out.emit("SET", expr_destination, "$0");
+        break;
     }
-    else if (auto obj_cast_expr = dynamic_cast<ir::ObjectCastExpression*>(input.get()))
+    case ir::Expression::Kind::ObjectCast:
     {
-        static std::size_t dyncast_label_id = 0;
-        std::string label_name = "dynamic_cast_good_" + std::to_string(dyncast_label_id++);
+        auto obj_cast_expr = static_cast<ir::ObjectCastExpression*>(input.get());
+        std::string label_name = "dynamic_cast_good_" + next_label_index();
         auto operand = obj_cast_expr->getOperand();
         std::string operand_location;
         if (operand->is_simple())
@@ -700,31 +998,69 @@ void vypcomp::Generator::generate_expression(ir::Expression::ValueType input, De
             operand_location = get_expr_destination(operand.get(), temporary_variables_mapping, variable_offsets);
         }
         auto target_class = obj_cast_expr->getTargetClass();
+        auto [target_id, target_last] = get_class_ids(target_class->name());
 
         generate_expression(operand, operand_location, variable_offsets, temporary_variables_mapping, out);
         if (!operand->is_simple())
-            out << "SET $1, " << operand_location << "\n";
-        // get the real type of target class, which is stored at object's chunk offset 1
-        out << "GETWORD $2, $1, 1\n"; // $2 is the string containing current class name
-        out << "EQS $0, $2, \"" << target_class->name() << "\"\n";
-        out << "JUMPNZ " << label_name << ", $0\n";
-            out << "SETWORD 0, 0, 0\n"; // cause run-time error 28 if the types are not equal
+            out.emit("SET", "$1", operand_location);
+        auto operand_type = operand->type();
+        if (operand_type.is<ir::Datatype::ClassName>())
+        {
+            auto [operand_id, operand_last] = get_class_ids(operand_type.get<ir::Datatype::ClassName>());
+            if (target_id <= operand_id && operand_last <= target_last)
+            {
+                // upcast always succeeds
+                out.emit("SET", destination, "$1");
+                break;
+            }
+        }
+        // get the real class id of the object, which is stored at object's chunk offset 1
+        out.emit("GETWORD", "$2", "$1", 1);
+        if (target_id == target_last)
+        {
+            // class without subclasses matches only its own id
+            out.emit("EQI", "$0", "$2", target_id);
+            out.emit("JUMPNZ", label_name, "$0");
+        }
+        else
+        {
+            // subclasses have ids in range of the target class
+            out.emit("LTI", "$0", "$2", target_id);
+            out.emit("JUMPNZ", label_name + "_fail", "$0");
+            out.emit("GTI", "$0", "$2", target_last);
+            out.emit("JUMPZ", label_name, "$0");
+            out.label(label_name + "_fail");
+        }
+            out.emit("SETWORD", 0, 0, 0); // cause run-time error 28 if the object is not instance of target class
         // otherwise assign the object id to 
-        out << "LABEL " << label_name << "\n";
-        out << "SET " << destination << ", $1" << std::endl;
+        out.label(label_name);
+        out.emit("SET", destination, "$1");
+        break;
     }
-    else
+    default:
     {
         throw std::runtime_error("Generator encountered unsupported expression type: " + input->to_string());
     }
+    }
 }
 
-void vypcomp::Generator::generate_binaryop(ir::BinaryOpExpression::Ptr input, DestinationName destination, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, OutputStream& out)
+void vypcomp::Generator::generate_binaryop(ir::BinaryOpExpression::Ptr input, DestinationName destination, OffsetMap& variable_offsets, TempVarMap& temporary_variables_mapping, Code& out, bool in_place)
 {
+    // result is computed in $0 and copied to the destination unless the destination register can hold it directly
+    std::string result = "$0";
+    if (in_place && !(input->kind() == ir::Expression::Kind::Add && input->type() == ir::Datatype(ir::PrimitiveDatatype::String)))
+        result = destination;
+
     // prepare operands
     auto op1 = input->getOp1();
     std::string op1_location;
-    if (op1->is_simple())
+    auto op1_register = find_register(op1);
+    if (op1_register)
+    {
+        // variable kept in register is used in place
+        op1_location = op1_register.value();
+    }
+    else if (op1->is_simple())
     {
         op1_location = "$1";
     }
@@ -735,7 +1071,12 @@ void vypcomp::Generator::generate_binaryop(ir::BinaryOpExpression::Ptr input, De
 
     auto op2 = input->getOp2();
     std::string op2_location;
-    if (op2->is_simple())
+    auto op2_register = find_register(op2);
+    if (op2_register)
+    {
+        op2_location = op2_register.value();
+    }
+    else if (op2->is_simple())
     {
         op2_location = "$2";
     }
@@ -746,18 +1087,21 @@ void vypcomp::Generator::generate_binaryop(ir::BinaryOpExpression::Ptr input, De
             
     if (!op1->is_simple())
         generate_expression(op1, op1_location, variable_offsets, temporary_variables_mapping, out);
-    generate_expression(op2, op2_location, variable_offsets, temporary_variables_mapping, out);
-    if (op1->is_simple()) // it's going to be just a simple register set, set it after computing op2, because it can utilize $1 register and overwrite the result
+    if (!op2_register)
+        generate_expression(op2, op2_location, variable_offsets, temporary_variables_mapping, out);
+    if (op1->is_simple() && !op1_register) // it's going to be just a simple register set, set it after computing op2, because it can utilize $1 register and overwrite the result
         generate_expression(op1, op1_location, variable_offsets, temporary_variables_mapping, out);
     
     // execute operation
-    if (auto addop = dynamic_cast<ir::AddExpression*>(input.get()))
+    switch (input->kind())
+    {
+    case ir::Expression::Kind::Add:
     {
 
         if (input->type() == ir::Datatype(ir::PrimitiveDatatype::Int))
-            out << "ADDI $0, " << op1_location << ", " << op2_location << "\n";
+            out.emit("ADDI", result, op1_location, op2_location);
         else if (input->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
-            out << "ADDF $0, " << op1_location << ", " << op2_location << "\n";
+            out.emit("ADDF", result, op1_location, op2_location);
         else if (input->type() == ir::Datatype(ir::PrimitiveDatatype::String))
         {
             std::for_each(variable_offsets.begin(), variable_offsets.end(), [](auto& ptr_offset_pair) { ptr_offset_pair.second += 3ll;  });
@@ -781,73 +1125,80 @@ void vypcomp::Generator::generate_binaryop(ir::BinaryOpExpression::Ptr input, De
             }
             std::for_each(variable_offsets.begin(), variable_offsets.end(), [](auto& ptr_offset_pair) { ptr_offset_pair.second -= 3ll;  });
             // call addStr subroutine with the 2 operands
-            out << "ADDI $SP, $SP, 3\n";
-            out << "SET [$SP-2], " << op1_location_shifted << "\n";
-            out << "SET [$SP-1], " << op2_location_shifted << "\n";
-            out << "CALL [$SP], addStr" << std::endl;
+            out.emit("ADDI", "$SP", "$SP", 3);
+            out.emit("SET", "[$SP-2]", op1_location_shifted);
+            out.emit("SET", "[$SP-1]", op2_location_shifted);
+            out.emit("CALL", "[$SP]", "addStr");
         }
         else
             throw std::runtime_error("Unexpected operand in + operation: "s + input->to_string());
+        break;
     }
-    else if (auto minop = dynamic_cast<ir::SubtractExpression*>(input.get()))
+    case ir::Expression::Kind::Subtract:
     {
         if (input->type() == ir::Datatype(ir::PrimitiveDatatype::Int))
         {
-            out << "SUBI $0, " << op1_location << ", " << op2_location << "\n";
+            out.emit("SUBI", result, op1_location, op2_location);
         }
         else if (input->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
-            out << "SUBF $0, " << op1_location << ", " << op2_location << "\n";
+            out.emit("SUBF", result, op1_location, op2_location);
         else
         {
             throw std::runtime_error("Unexpected operand in - opertaion: "s + input->to_string());
         }
+        break;
     }
-    else if (auto mulop = dynamic_cast<ir::MultiplyExpression*>(input.get()))
+    case ir::Expression::Kind::Multiply:
     {
         if (input->type() == ir::Datatype(ir::PrimitiveDatatype::Int))
         {
-            out << "MULI $0, " << op1_location << ", " << op2_location << "\n";
+            out.emit("MULI", result, op1_location, op2_location);
         }
         else if (input->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
-            out << "MULF $0, " << op1_location << ", " << op2_location << "\n";
+            out.emit("MULF", result, op1_location, op2_location);
         else
         {
             throw std::runtime_error("Unexpected operand in * opertaion: "s + input->to_string());
         }
+        break;
     }
-    else if (auto divop = dynamic_cast<ir::DivideExpression*>(input.get()))
+    case ir::Expression::Kind::Divide:
     {
         if (input->type() == ir::Datatype(ir::PrimitiveDatatype::Int))
         {
-            out << "DIVI $0, " << op1_location << ", " << op2_location << "\n";
+            out.emit("DIVI", result, op1_location, op2_location);
         }
         else if (input->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
-            out << "DIVF $0, " << op1_location << ", " << op2_location << "\n";
+            out.emit("DIVF", result, op1_location, op2_location);
         else
         {
             throw std::runtime_error("Unexpected operand in / opertaion: "s + input->to_string());
         }
+        break;
     }
-    else if (auto andop = dynamic_cast<ir::AndExpression*>(input.get()))
+    case ir::Expression::Kind::And:
     {
-        out << "AND $0, " << op1_location << ", " << op2_location << "\n";
+        out.emit("AND", result, op1_location, op2_location);
+        break;
     }
-    else if (auto orop = dynamic_cast<ir::OrExpression*>(input.get()))
+    case ir::Expression::Kind::Or:
     {
-        out << "OR $0, " << op1_location << ", " << op2_location << "\n";
+        out.emit("OR", result, op1_location, op2_location);
+        break;
     }
-    else if (auto eqop = dynamic_cast<ir::ComparisonExpression*>(input.get()))
+    case ir::Expression::Kind::Comparison:
     {
+        auto eqop = static_cast<ir::ComparisonExpression*>(input.get());
         switch (eqop->getOperation())
         {
         case ir::ComparisonExpression::EQUALS:
             if ((op1->type() == ir::Datatype(ir::PrimitiveDatatype::Int) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Int)) || (op1->type().is<ir::Datatype::ClassName>() && op2->type().is<ir::Datatype::ClassName>()))
                 // for object type just compare the chunk ids as ints
-                out << "EQI $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("EQI", result, op1_location, op2_location);
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Float) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
-                out << "EQF $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("EQF", result, op1_location, op2_location);
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::String) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::String))
-                out << "EQS $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("EQS", result, op1_location, op2_location);
             else
             {
                 throw std::runtime_error("Unexpected operand type in == opertaion: "s + input->to_string());
@@ -857,29 +1208,29 @@ void vypcomp::Generator::generate_binaryop(ir::BinaryOpExpression::Ptr input, De
             // EQUALS and NOT the result
             if ((op1->type() == ir::Datatype(ir::PrimitiveDatatype::Int) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Int)) || (op1->type().is<ir::Datatype::ClassName>() && op2->type().is<ir::Datatype::ClassName>()))
                 // for object type just compare the chunk ids as ints
-                out << "EQI $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("EQI", result, op1_location, op2_location);
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Float) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
-                out << "EQF $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("EQF", result, op1_location, op2_location);
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::String) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::String))
-                out << "EQS $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("EQS", result, op1_location, op2_location);
             else
             {
                 throw std::runtime_error("Unexpected operand type in == opertaion: "s + input->to_string());
             }
-            out << "NOT $0, $0\n";
+            out.emit("NOT", result, result);
             break;
         case ir::ComparisonExpression::LESS:
             if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Int) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Int))
             {
-                out << "LTI $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("LTI", result, op1_location, op2_location);
             }
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Float) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
             {
-                out << "LTF $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("LTF", result, op1_location, op2_location);
             }
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::String) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::String))
             {
-                out << "LTS $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("LTS", result, op1_location, op2_location);
             }
             else
             {
@@ -889,15 +1240,15 @@ void vypcomp::Generator::generate_binaryop(ir::BinaryOpExpression::Ptr input, De
         case ir::ComparisonExpression::GREATER:
             if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Int) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Int))
             {
-                out << "GTI $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("GTI", result, op1_location, op2_location);
             }
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Float) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
             {
-                out << "GTF $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("GTF", result, op1_location, op2_location);
             }
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::String) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::String))
             {
-                out << "GTS $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("GTS", result, op1_location, op2_location);
             }
             else
             {
@@ -908,61 +1259,64 @@ void vypcomp::Generator::generate_binaryop(ir::BinaryOpExpression::Ptr input, De
             // for <= do !(>)
             if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Int) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Int))
             {
-                out << "GTI $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("GTI", result, op1_location, op2_location);
             }
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Float) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
             {
-                out << "GTF $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("GTF", result, op1_location, op2_location);
             }
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::String) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::String))
             {
-                out << "GTS $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("GTS", result, op1_location, op2_location);
             }
             else
             {
                 throw std::runtime_error("Unexpected operand type in <= operation: "s + input->to_string());
             }
-            out << "NOT $0, $0\n";
+            out.emit("NOT", result, result);
             break;
         case ir::ComparisonExpression::GEQ:
             // for >= do !(<)
             if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Int) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Int))
             {
-                out << "LTI $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("LTI", result, op1_location, op2_location);
             }
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::Float) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::Float))
             {
-                out << "LTF $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("LTF", result, op1_location, op2_location);
             }
             else if (op1->type() == ir::Datatype(ir::PrimitiveDatatype::String) && op2->type() == ir::Datatype(ir::PrimitiveDatatype::String))
             {
-                out << "LTS $0, " << op1_location << ", " << op2_location << "\n";
+                out.emit("LTS", result, op1_location, op2_location);
             }
             else
             {
                 throw std::runtime_error("Unexpected operand type in >= operation: "s + input->to_string());
             }
-            out << "NOT $0, $0\n";
+            out.emit("NOT", result, result);
             break;
         default:
             throw std::runtime_error("Unexpected comparison type in comparison: "s + input->to_string());
         }
+        break;
     }
-    else
+    default:
     {
         throw std::runtime_error("Generator encountered unsupported expression type: " + input->to_string());
     }
-    out << "SET " << destination << ", $0" << std::endl;
+    }
+    if (result != destination)
+        out.emit("SET", destination, "$0");
 }
 
 bool vypcomp::Generator::is_alloca(vypcomp::ir::Instruction::Ptr instr) const
 {
-    return dynamic_cast<ir::AllocaInstruction*>(instr.get()) != nullptr;
+    return ir::is<ir::AllocaInstruction>(instr);
 }
 
 bool vypcomp::Generator::is_return(vypcomp::ir::Instruction::Ptr instr) const
 {
-    return dynamic_cast<ir::Return*>(instr.get()) != nullptr;
+    return ir::is<ir::Return>(instr);
 }
 
 vypcomp::Generator::AllocaVector vypcomp::Generator::get_alloca_instructions(vypcomp::ir::Instruction::Ptr first, TempVarMap& exp_temporary_mapping)
@@ -971,12 +1325,16 @@ vypcomp::Generator::AllocaVector vypcomp::Generator::get_alloca_instructions(vyp
 
     for (auto current = first; current != nullptr; current = current->next())
     {
-        if (auto alloca_instr = std::dynamic_pointer_cast<ir::AllocaInstruction>(current))
+        switch (current->kind())
+        {
+        case ir::Instruction::Kind::Alloca:
         {
-            result.push_back(alloca_instr);
+            result.push_back(std::static_pointer_cast<ir::AllocaInstruction>(current));
+            break;
         }
-        else if (auto branch_instr = std::dynamic_pointer_cast<ir::BranchInstruction>(current))
+        case ir::Instruction::Kind::Branch:
         {
+            auto branch_instr = static_cast<ir::BranchInstruction*>(current.get());
             auto allocas_cond = get_temporary_allocas(branch_instr->getExpr(), exp_temporary_mapping);
             auto allocas_if = get_alloca_instructions(branch_instr->getIf()->first(), exp_temporary_mapping);
             result.insert(result.end(), allocas_cond.begin(), allocas_cond.end());
@@ -987,30 +1345,37 @@ vypcomp::Generator::AllocaVector vypcomp::Generator::get_alloca_instructions(vyp
                 auto allocas_else = get_alloca_instructions(branch_instr->getElse()->first(), exp_temporary_mapping);
                 result.insert(result.end(), allocas_else.begin(), allocas_else.end());
             }
+            break;
         }
-        else if (auto loop_instr = std::dynamic_pointer_cast<ir::LoopInstruction>(current))
+        case ir::Instruction::Kind::Loop:
         {
+            auto loop_instr = static_cast<ir::LoopInstruction*>(current.get());
             auto allocas_cond = get_temporary_allocas(loop_instr->getExpr(), exp_temporary_mapping);
             auto allocas_body = get_alloca_instructions(loop_instr->getBody()->first(), exp_temporary_mapping);
             result.insert(result.end(), allocas_cond.begin(), allocas_cond.end());
             result.insert(result.end(), allocas_body.begin(), allocas_body.end());
+            break;
         }
-        else if (auto assignment = std::dynamic_pointer_cast<ir::Assignment>(current))
+        case ir::Instruction::Kind::Assignment:
         {
             // if assignment, analyze if expressions needs temporaries
+            auto assignment = static_cast<ir::Assignment*>(current.get());
             auto expr = assignment->getExpr();
             auto allocas = get_temporary_allocas(expr, exp_temporary_mapping);
             result.insert(result.end(), allocas.begin(), allocas.end());
+            break;
         }
-        else if (auto assignment = std::dynamic_pointer_cast<ir::ObjectAssignment>(current))
+        case ir::Instruction::Kind::ObjectAssignment:
         {
-            auto target = assignment->getTarget();
+            auto assignment = static_cast<ir::ObjectAssignment*>(current.get());
             auto expr = assignment->getExpr();
             auto expr_allocas = get_temporary_allocas(expr, exp_temporary_mapping);
             result.insert(result.end(), expr_allocas.begin(), expr_allocas.end());
+            break;
         }
-        else if (auto ret_instr = std::dynamic_pointer_cast<ir::Return>(current))
+        case ir::Instruction::Kind::Return:
         {
+            auto ret_instr = static_cast<ir::Return*>(current.get());
             if (!ret_instr->isVoid())
             {
                 // analyze if return expression needs temporaries
@@ -1018,6 +1383,10 @@ vypcomp::Generator::AllocaVector vypcomp::Generator::get_alloca_instructions(vyp
                 auto allocas = get_temporary_allocas(expr, exp_temporary_mapping);
                 result.insert(result.end(), allocas.begin(), allocas.end());
             }
+            break;
+        }
+        default:
+            break;
         }
     }
     return result;
@@ -1028,79 +1397,242 @@ std::vector<ir::AllocaInstruction::Ptr> vypcomp::Generator::get_temporary_alloca
     std::vector<ir::AllocaInstruction::Ptr> result;
     if (!expr->is_simple())
     {
-        auto required_temps = get_required_temporaries(expr, exp_temporary_mapping);
-        result.insert(result.end(), required_temps.begin(), required_temps.end());
+        get_required_temporaries(expr, exp_temporary_mapping, result);
+        // temporaries are dead once the statement is executed, slots of each statement start from 0
+        if (auto temporary = find_expr_destination(expr.get(), exp_temporary_mapping))
+            temporary_slots[temporary.value()] = 0;
+        std::vector<std::size_t> busy(1);
+        assign_temporary_slots(expr, exp_temporary_mapping, busy);
     }
     return result;
 }
 
-std::vector<ir::AllocaInstruction::Ptr> vypcomp::Generator::get_required_temporaries(ir::Expression::ValueType expr, TempVarMap& exp_temporary_mapping)
+void vypcomp::Generator::get_required_temporaries(ir::Expression::ValueType expr, TempVarMap& exp_temporary_mapping, AllocaVector& result)
 {
-    std::vector<ir::AllocaInstruction::Ptr> result;
-    // very conservative approach to generating temporaries, possible improvement would reuse old temporaries and free registers
-    // for now, every binary expression result is stored in a new stack variable
+    // every expression result gets a new temporary, assign_temporary_slots then lets temporaries with disjoint lifetimes share stack slots
     if (expr->is_simple()) 
-        return {};
-    else if (auto func_expr = dynamic_cast<ir::FunctionExpression*>(expr.get()))
+        return;
+
+    switch (expr->kind())
     {
+    case ir::Expression::Kind::Function:
+    case ir::Expression::Kind::Constructor:
+    case ir::Expression::Kind::Method:
+    {
+        auto func_expr = static_cast<ir::FunctionExpression*>(expr.get());
         auto arg_expressions = func_expr->getArgs();
         for (auto& arg_expression : arg_expressions)
         {
-            auto temps = get_required_temporaries(arg_expression, exp_temporary_mapping);
-            result.insert(result.end(), temps.begin(), temps.end());
+            get_required_temporaries(arg_expression, exp_temporary_mapping, result);
         }
-        auto func_result_temp = std::make_shared<ir::AllocaInstruction>(std::make_pair(func_expr->type(), func_expr->to_string()));
+        auto func_result_temp = make_temporary(func_expr->type(), func_expr);
         exp_temporary_mapping[func_expr] = func_result_temp.get();
         result.push_back(func_result_temp);
+        break;
     }
-    else if (auto binop_exp = dynamic_cast<ir::BinaryOpExpression*>(expr.get()))
+    case ir::Expression::Kind::Add:
+    case ir::Expression::Kind::Subtract:
+    case ir::Expression::Kind::Multiply:
+    case ir::Expression::Kind::Divide:
+    case ir::Expression::Kind::Comparison:
+    case ir::Expression::Kind::And:
+    case ir::Expression::Kind::Or:
     {
-        auto exp_str = binop_exp->to_string();
+        auto binop_exp = static_cast<ir::BinaryOpExpression*>(expr.get());
         auto op1 = binop_exp->getOp1();
         auto op2 = binop_exp->getOp2();
-        auto op1_temps = get_required_temporaries(op1, exp_temporary_mapping);
-        result.insert(result.end(), op1_temps.begin(), op1_temps.end());
-        auto op2_temps = get_required_temporaries(op2, exp_temporary_mapping);
-        result.insert(result.end(), op2_temps.begin(), op2_temps.end());
+        get_required_temporaries(op1, exp_temporary_mapping, result);
+        get_required_temporaries(op2, exp_temporary_mapping, result);
 
-        auto new_temporary = std::make_shared<ir::AllocaInstruction>(std::make_pair(binop_exp->type(), binop_exp->to_string()));
+        auto new_temporary = make_temporary(binop_exp->type(), binop_exp);
         exp_temporary_mapping[binop_exp] = new_temporary.get();
         result.push_back(new_temporary);
+        break;
     }
-    else if (auto not_exp = dynamic_cast<ir::NotExpression*>(expr.get()))
+    case ir::Expression::Kind::Not:
     {
-        auto operand_temporaries = get_required_temporaries(not_exp->getOperand(), exp_temporary_mapping);
-        result.insert(result.end(), operand_temporaries.begin(), operand_temporaries.end());
-        auto new_temporary = std::make_shared<ir::AllocaInstruction>(std::make_pair(not_exp->type(), not_exp->to_string()));
+        auto not_exp = static_cast<ir::NotExpression*>(expr.get());
+        get_required_temporaries(not_exp->getOperand(), exp_temporary_mapping, result);
+        auto new_temporary = make_temporary(not_exp->type(), not_exp);
         exp_temporary_mapping[not_exp] = new_temporary.get();
         result.push_back(new_temporary);
+        break;
+    }
+    case ir::Expression::Kind::Concat:
+    {
+        auto concat_exp = static_cast<ir::ConcatExpression*>(expr.get());
+        for (auto& operand : concat_exp->getOperands())
+        {
+            get_required_temporaries(operand, exp_temporary_mapping, result);
+        }
+        auto new_temporary = make_temporary(concat_exp->type(), concat_exp);
+        exp_temporary_mapping[concat_exp] = new_temporary.get();
+        result.push_back(new_temporary);
+        break;
     }
-    else if (auto object_access_attr = dynamic_cast<ir::ObjectAttributeExpression*>(expr.get()))
+    case ir::Expression::Kind::ObjectAttribute:
     {
-        auto new_temporary = std::make_shared<ir::AllocaInstruction>(std::make_pair(object_access_attr->type(), object_access_attr->to_string()));
+        auto object_access_attr = static_cast<ir::ObjectAttributeExpression*>(expr.get());
+        auto new_temporary = make_temporary(object_access_attr->type(), object_access_attr);
         exp_temporary_mapping[object_access_attr] = new_temporary.get();
         result.push_back(new_temporary);
+        break;
     }
-    else if (auto string_cast_expr = dynamic_cast<ir::StringCastExpression*>(expr.get()))
+    case ir::Expression::Kind::StringCast:
     {
+        auto string_cast_expr = static_cast<ir::StringCastExpression*>(expr.get());
         auto operand = string_cast_expr->getOperand();
-        auto op_temps = get_required_temporaries(operand, exp_temporary_mapping);
-        result.insert(result.end(), op_temps.begin(), op_temps.end());
-        auto new_temporary = std::make_shared<ir::AllocaInstruction>(std::make_pair(ir::Datatype(ir::PrimitiveDatatype::String), string_cast_expr->to_string()));
+        get_required_temporaries(operand, exp_temporary_mapping, result);
+        auto new_temporary = make_temporary(ir::Datatype(ir::PrimitiveDatatype::String), string_cast_expr);
         exp_temporary_mapping[string_cast_expr] = new_temporary.get();
         result.push_back(new_temporary);
+        break;
     }
-    else if (auto obj_cast_expr = dynamic_cast<ir::ObjectCastExpression*>(expr.get()))
+    case ir::Expression::Kind::ObjectCast:
     {
+        auto obj_cast_expr = static_cast<ir::ObjectCastExpression*>(expr.get());
         auto operand = obj_cast_expr->getOperand();
-        auto op_temps = get_required_temporaries(operand, exp_temporary_mapping);
-        result.insert(result.end(), op_temps.begin(), op_temps.end());
+        get_required_temporaries(operand, exp_temporary_mapping, result);
+        break;
     }
-    else
+    default:
     {
         throw std::runtime_error("Unexpected expression type in get_required_temporaries. expr is "s + expr->to_string());
     }
-    return result;
+    }
+}
+
+ir::AllocaInstruction::Ptr vypcomp::Generator::make_temporary(const ir::Datatype& type, ExprRawPtr expr) const
+{
+    // temporaries are identified by their alloca, the name only labels them in verbose listings
+    // rendering expression for each of its subexpressions is quadratic in depth of the expression
+    static const ir::Name unnamed("tmp");
+    return std::make_shared<ir::AllocaInstruction>(std::make_pair(type, verbose ? ir::Name(expr->to_string()) : unnamed));
+}
+
+void vypcomp::Generator::assign_temporary_slots(ir::Expression::ValueType expr, TempVarMap& exp_temporary_mapping, std::vector<std::size_t>& busy)
+{
+    std::vector<ir::Expression::ValueType> operands;
+    get_temporary_operands(expr, exp_temporary_mapping, operands);
+    if (operands.empty())
+        return;
+
+    auto lowest_free = [&busy]() {
+        std::size_t slot = std::find(busy.begin(), busy.end(), 0) - busy.begin();
+        if (slot == busy.size())
+            busy.push_back(0);
+        return slot;
+    };
+    // result of expr is written once its operands are computed, so the operands must not share its slot,
+    // but their own operands can
+    auto temporary = find_expr_destination(expr.get(), exp_temporary_mapping);
+    if (temporary)
+        busy[temporary_slots.at(temporary.value())]++;
+    // arguments are stored into the callee frame one by one, so only one of them is live at a time
+    auto kind = expr->kind();
+    bool sequential = kind == ir::Expression::Kind::Function || kind == ir::Expression::Kind::Constructor || kind == ir::Expression::Kind::Method;
+
+    std::vector<std::size_t> operand_slots;
+    for (auto& operand : operands)
+    {
+        auto slot = lowest_free();
+        temporary_slots[find_expr_destination(operand.get(), exp_temporary_mapping).value()] = slot;
+        operand_slots.push_back(slot);
+        if (!sequential)
+            busy[slot]++;
+    }
+    if (temporary)
+        busy[temporary_slots.at(temporary.value())]--;
+
+    for (std::size_t i = 0; i < operands.size(); i++)
+    {
+        // other operands keep their results while this one is evaluated
+        if (!sequential)
+            busy[operand_slots[i]]--;
+        assign_temporary_slots(operands[i], exp_temporary_mapping, busy);
+        if (!sequential)
+            busy[operand_slots[i]]++;
+    }
+    for (std::size_t i = 0; i < operands.size() && !sequential; i++)
+        busy[operand_slots[i]]--;
+}
+
+void vypcomp::Generator::get_temporary_operands(ir::Expression::ValueType expr, TempVarMap& exp_temporary_mapping, std::vector<ir::Expression::ValueType>& operands)
+{
+    std::vector<ir::Expression::ValueType> subexpressions;
+    switch (expr->kind())
+    {
+    case ir::Expression::Kind::Function:
+    case ir::Expression::Kind::Constructor:
+    case ir::Expression::Kind::Method:
+    {
+        auto func_expr = static_cast<ir::FunctionExpression*>(expr.get());
+        auto arg_expressions = func_expr->getArgs();
+        subexpressions.assign(arg_expressions.begin(), arg_expressions.end());
+        break;
+    }
+    case ir::Expression::Kind::Add:
+    case ir::Expression::Kind::Subtract:
+    case ir::Expression::Kind::Multiply:
+    case ir::Expression::Kind::Divide:
+    case ir::Expression::Kind::Comparison:
+    case ir::Expression::Kind::And:
+    case ir::Expression::Kind::Or:
+    {
+        auto binop_exp = static_cast<ir::BinaryOpExpression*>(expr.get());
+        subexpressions = {binop_exp->getOp1(), binop_exp->getOp2()};
+        break;
+    }
+    case ir::Expression::Kind::Not:
+        subexpressions = {static_cast<ir::NotExpression*>(expr.get())->getOperand()};
+        break;
+    case ir::Expression::Kind::Concat:
+    {
+        // all operands are computed before any of them is passed to concatStr
+        auto& concat_operands = static_cast<ir::ConcatExpression*>(expr.get())->getOperands();
+        subexpressions.assign(concat_operands.begin(), concat_operands.end());
+        break;
+    }
+    case ir::Expression::Kind::StringCast:
+        subexpressions = {static_cast<ir::StringCastExpression*>(expr.get())->getOperand()};
+        break;
+    case ir::Expression::Kind::ObjectCast:
+        subexpressions = {static_cast<ir::ObjectCastExpression*>(expr.get())->getOperand()};
+        break;
+    default:
+        break;
+    }
+
+    for (auto& subexpression : subexpressions)
+    {
+        // expressions without temporary (object casts) pass the result of their operand
+        if (find_expr_destination(subexpression.get(), exp_temporary_mapping))
+            operands.push_back(subexpression);
+        else
+            get_temporary_operands(subexpression, exp_temporary_mapping, operands);
+    }
+}
+
+std::size_t vypcomp::Generator::layout_frame(const AllocaVector& local_variables)
+{
+    frame_positions.clear();
+    std::size_t frame_size = 0;
+    std::unordered_map<std::size_t, std::size_t> slot_positions;
+    for (auto& alloca_instr : local_variables)
+    {
+        auto slot = temporary_slots.find(alloca_instr.get());
+        if (slot == temporary_slots.end())
+        {
+            frame_positions[alloca_instr.get()] = frame_size++;
+            continue;
+        }
+        // temporaries in the same slot are never live at the same time
+        auto [position, inserted] = slot_positions.emplace(slot->second, frame_size);
+        if (inserted)
+            frame_size++;
+        frame_positions[alloca_instr.get()] = position->second;
+    }
+    return frame_size;
 }
 
 std::optional<std::size_t> vypcomp::Generator::find_offset(AllocaRawPtr alloca_ptr, OffsetMap& variable_offsets) const
@@ -1126,56 +1658,95 @@ vypcomp::Generator::DestinationName vypcomp::Generator::get_expr_destination(Exp
 {
     auto exp_destination = find_expr_destination(expr, temporary_variables_mapping);
     if (!exp_destination) throw std::runtime_error("Expression destination was not a temporary variable: "s + expr->to_string());
-    auto destination_offset = find_offset(exp_destination.value(), variable_offsets);
-    if (!destination_offset) throw std::runtime_error("Expression destination's offset not found: "s + expr->to_string());
-    return "[$SP-"s + std::to_string(destination_offset.value()) + "]"s;
+    return get_variable_location(exp_destination.value(), variable_offsets);
+}
+
+vypcomp::Generator::DestinationName vypcomp::Generator::get_variable_location(AllocaRawPtr alloca_ptr, OffsetMap& variable_offsets) const
+{
+    if (auto reg = variable_registers.find(alloca_ptr); reg != variable_registers.end())
+    {
+        return reg->second;
+    }
+    auto offset = find_offset(alloca_ptr, variable_offsets);
+    if (!offset) throw std::runtime_error("Did not find assigned location of variable: "s + alloca_ptr->name());
+    return "[$SP-"s + std::to_string(offset.value()) + "]"s;
 }
 
-void vypcomp::Generator::generate_builtin_functions(OutputStream& out)
+std::optional<vypcomp::Generator::DestinationName> vypcomp::Generator::find_register(const ir::Expression::ValueType& expr) const
+{
+    auto symb_expr = ir::as<ir::SymbolExpression>(expr.get());
+    if (!symb_expr) return std::nullopt;
+    if (auto reg = variable_registers.find(symb_expr->getValue().get()); reg != variable_registers.end())
+    {
+        return reg->second;
+    }
+    return std::nullopt;
+}
+
+void vypcomp::Generator::generate_builtin_functions(const vypcomp::SymbolTable& symbol_table, Code& out)
 {
     // print is broken up into intrinsic WRITEI etc. calls on call site
+    // builtins removed from symbol table as unused are not generated
+    // builtins expanded at call sites under optimization are not generated either
     // readInt
-    out << "LABEL " << VYPLANG_PREFIX << "readInt\n";
-    out << "READI $0\n";
-    out << "SET $1, [$SP]\n";
-    out << "SUBI $SP, $SP, 1\n"; // length has no parameters
-    out << "RETURN $1\n" << std::endl;
+    if (!optimize && symbol_table.has("readInt"))
+    {
+        out.label(VYPLANG_PREFIX.data() + "readInt"s);
+        out.emit("READI", "$0");
+        out.emit("SET", "$1", "[$SP]");
+        out.emit("SUBI", "$SP", "$SP", 1); // length has no parameters
+        out.emit("RETURN", "$1");
+        out.blank();
+    }
 
     // readFloat
-    out << "LABEL " << VYPLANG_PREFIX << "readFloat\n";
-    out << "READF $0\n";
-    out << "SET $1, [$SP]\n";
-    out << "SUBI $SP, $SP, 1\n"; // length has no parameters
-    out << "RETURN $1\n" << std::endl;
+    if (!optimize && symbol_table.has("readFloat"))
+    {
+        out.label(VYPLANG_PREFIX.data() + "readFloat"s);
+        out.emit("READF", "$0");
+        out.emit("SET", "$1", "[$SP]");
+        out.emit("SUBI", "$SP", "$SP", 1); // length has no parameters
+        out.emit("RETURN", "$1");
+        out.blank();
+    }
 
     // readString
-    out << "LABEL " << VYPLANG_PREFIX << "readString\n";
-    out << "READS $0\n";
-    out << "SET $1, [$SP]\n";
-    out << "SUBI $SP, $SP, 1\n"; // length has no parameters
-    out << "RETURN $1\n" << std::endl;
+    if (!optimize && symbol_table.has("readString"))
+    {
+        out.label(VYPLANG_PREFIX.data() + "readString"s);
+        out.emit("READS", "$0");
+        out.emit("SET", "$1", "[$SP]");
+        out.emit("SUBI", "$SP", "$SP", 1); // length has no parameters
+        out.emit("RETURN", "$1");
+        out.blank();
+    }
 
     // length
-    out << "LABEL " << VYPLANG_PREFIX << "length\n";
-    out << "GETSIZE $0, [$SP-1]\n";
-    out << "SET $1, [$SP]\n";
-    out << "SUBI $SP, $SP, 2\n"; // length has one parameter
-    out << "RETURN $1\n" << std::endl;
+    if (!optimize && symbol_table.has("length"))
+    {
+        out.label(VYPLANG_PREFIX.data() + "length"s);
+        out.emit("GETSIZE", "$0", "[$SP-1]");
+        out.emit("SET", "$1", "[$SP]");
+        out.emit("SUBI", "$SP", "$SP", 2); // length has one parameter
+        out.emit("RETURN", "$1");
+        out.blank();
+    }
 
     // subStr(string s, int i, int n)
+    // VYPcode has no block move of string characters, so characters are copied 4 per loop iteration
     constexpr std::string_view subStr_impl =
 R"vc(# [$SP-3] s
 # [$SP-2] i
 # [$SP-1] n
 # [$SP-0] ret_addr
 # $1 length(s)
-GETSIZE $1, [$SP-3] 
-# if length < 0, return s
-LTI $0, $1, 0
-JUMPZ subStr_s_check_cont, $0
-SET $0, [$SP-3]
-JUMP subStr_return
-LABEL subStr_s_check_cont
+# $2 offset in s
+# $3 offset in result
+# $4 end of copied part of s
+# $5 copied character, later loop condition result
+# $6 end of part of s copied 4 characters at once
+# $7 s
+GETSIZE $1, [$SP-3]
 # test i
 GTI $2, [$SP-2], 0
 LTI $3, [$SP-2], $1
@@ -1193,84 +1764,232 @@ SET $0, ""
 JUMP subStr_return
 LABEL subst_n_check_cont
 # execute subStr copy
-SET $2, 0 # loop counter
-CREATE $0, [$SP-1]
-LABEL subStr_loop_cond
-LTI $3, $2, [$SP-1]
-JUMPZ subStr_loop_end, $3
-# loop body
-ADDI $4, $2, [$SP-2] # offset in src
-# if offset in src is too big, get i'th
+SET $7, [$SP-3]
+SET $0, ""
+RESIZE $0, [$SP-1]
+SET $2, [$SP-2]
+SET $3, 0
+ADDI $4, $2, [$SP-1]
 LTI $5, $4, $1
-JUMPZ subStr_overflow_start, $5
-GETWORD $5, [$SP-3], $4
-JUMP subStr_overflow_end
-LABEL subStr_overflow_start
-GETWORD $5, [$SP-3], [$SP-2] # get i-th instead
-LABEL subStr_overflow_end
-SETWORD $0, $2, $5
+JUMPNZ subStr_copy_end_set, $5
+SET $4, $1
+LABEL subStr_copy_end_set
+SUBI $6, $4, 3
+LABEL subStr_copy4
+LTI $5, $2, $6
+JUMPZ subStr_copy1, $5
+GETWORD $5, $7, $2
+SETWORD $0, $3, $5
+ADDI $2, $2, 1
+ADDI $3, $3, 1
+GETWORD $5, $7, $2
+SETWORD $0, $3, $5
+ADDI $2, $2, 1
+ADDI $3, $3, 1
+GETWORD $5, $7, $2
+SETWORD $0, $3, $5
+ADDI $2, $2, 1
+ADDI $3, $3, 1
+GETWORD $5, $7, $2
+SETWORD $0, $3, $5
 ADDI $2, $2, 1
-JUMP subStr_loop_cond
-# loop body end
-LABEL subStr_loop_end
+ADDI $3, $3, 1
+JUMP subStr_copy4
+LABEL subStr_copy1
+LTI $5, $2, $4
+JUMPZ subStr_overflow, $5
+GETWORD $5, $7, $2
+SETWORD $0, $3, $5
+ADDI $2, $2, 1
+ADDI $3, $3, 1
+JUMP subStr_copy1
+# if offset in src is too big, i-th character is used instead
+LABEL subStr_overflow
+GETWORD $5, $7, [$SP-2]
+LABEL subStr_overflow_loop
+LTI $6, $3, [$SP-1]
+JUMPZ subStr_return, $6
+SETWORD $0, $3, $5
+ADDI $3, $3, 1
+JUMP subStr_overflow_loop
 LABEL subStr_return
 SET $1, [$SP]
 SUBI $SP, $SP, 4
 RETURN $1)vc";
-    out << "LABEL " << VYPLANG_PREFIX << "subStr\n";
-    out << subStr_impl << std::endl;
+    if (symbol_table.has("subStr"))
+    {
+        out.label(VYPLANG_PREFIX.data() + "subStr"s);
+        static const auto subStr_code = Code::parse(std::string(subStr_impl));
+        out.append(subStr_code);
+        out.blank();
+    }
 
     // addStr
+    // op1 is copied at once, op2 is appended 4 characters per loop iteration, empty operands are not copied at all
     constexpr std::string_view add_strings = 
 R"vc(LABEL addStr
 # $0 destination
 # $1 op1 string, later loop condition result
 # $2 op2 string
-# $3 iterator over op2
+# $3 offset in op2
 # $4 offset in destination chunk
-# $5 size of destination chunk, later value copied
-# $6 size op1 
+# $5 value copied
+# $6 size op1, later end of part of op2 copied 4 characters at once
 # $7 size op2
 SET $1, [$SP-2]
 SET $2, [$SP-1]
-COPY $0, $1
 GETSIZE $6, $1
 GETSIZE $7, $2
+SET $0, $1
+JUMPZ strcpy_end, $7
+SET $0, $2
+JUMPZ strcpy_end, $6
+COPY $0, $1
 ADDI $5, $6, $7
 RESIZE $0, $5
 
 SET $3, 0
+SET $4, $6
+SUBI $6, $7, 3
+LABEL strcpy_loop4
+LTI $1, $3, $6
+JUMPZ strcpy_loop, $1
+GETWORD $5, $2, $3
+SETWORD $0, $4, $5
+ADDI $3, $3, 1
+ADDI $4, $4, 1
+GETWORD $5, $2, $3
+SETWORD $0, $4, $5
+ADDI $3, $3, 1
+ADDI $4, $4, 1
+GETWORD $5, $2, $3
+SETWORD $0, $4, $5
+ADDI $3, $3, 1
+ADDI $4, $4, 1
+GETWORD $5, $2, $3
+SETWORD $0, $4, $5
+ADDI $3, $3, 1
+ADDI $4, $4, 1
+JUMP strcpy_loop4
 LABEL strcpy_loop
 LTI $1, $3, $7
 JUMPZ strcpy_end, $1
-ADDI $4, $6, $3 # get offset in the destination chunk
 GETWORD $5, $2, $3
 SETWORD $0, $4, $5
 ADDI $3, $3, 1
+ADDI $4, $4, 1
 JUMP strcpy_loop
 LABEL strcpy_end
 SET $1, [$SP]
 SUBI $SP, $SP, 3
 RETURN $1)vc";
-    out << add_strings << std::endl;
+    static const auto add_strings_code = Code::parse(std::string(add_strings));
+    out.append(add_strings_code);
+
+    // concatStr
+    // chains of string additions are flattened by the optimizer, the result is allocated once for all of the operands
+    // operands are visited by moving $SP over them, total size is computed going down, operands are copied going up
+    // the copy loop needs all of $0-$7, so the return address stays on the stack and the number of operands
+    // left to be copied moves up the stack over the slots of copied operands
+    if (optimize)
+    {
+        constexpr std::string_view concat_strings = 
+R"vc(LABEL concatStr
+# [$SP] return address
+# [$SP-1] number of operands, operands are stored below it
+# $0 destination
+# $1 loop condition result, first number of operands left to be copied
+# $2 operand string
+# $3 offset in operand, first number of operands left to be measured
+# $4 offset in destination chunk
+# $5 value copied, first size of operand
+# $6 end of part of operand copied 4 characters at once, first number of operands after the first one
+# $7 size of operand, first total size
+SET $3, [$SP-1]
+SUBI $6, $3, 1
+SET $7, 0
+SUBI $SP, $SP, 1
+LABEL concatStr_size
+SUBI $SP, $SP, 1
+SET $2, [$SP]
+GETSIZE $5, $2
+ADDI $7, $7, $5
+SUBI $3, $3, 1
+JUMPNZ concatStr_size, $3
+COPY $0, $2
+RESIZE $0, $7
+SET $4, $5
+SET [$SP], $6
+
+LABEL concatStr_next
+ADDI $SP, $SP, 1
+SET $1, [$SP-1]
+JUMPZ concatStr_end, $1
+SUBI $1, $1, 1
+SET $2, [$SP]
+SET [$SP], $1
+GETSIZE $7, $2
+SET $3, 0
+SUBI $6, $7, 3
+LABEL concatStr_loop4
+LTI $1, $3, $6
+JUMPZ concatStr_loop, $1
+GETWORD $5, $2, $3
+SETWORD $0, $4, $5
+ADDI $3, $3, 1
+ADDI $4, $4, 1
+GETWORD $5, $2, $3
+SETWORD $0, $4, $5
+ADDI $3, $3, 1
+ADDI $4, $4, 1
+GETWORD $5, $2, $3
+SETWORD $0, $4, $5
+ADDI $3, $3, 1
+ADDI $4, $4, 1
+GETWORD $5, $2, $3
+SETWORD $0, $4, $5
+ADDI $3, $3, 1
+ADDI $4, $4, 1
+JUMP concatStr_loop4
+LABEL concatStr_loop
+LTI $1, $3, $7
+JUMPZ concatStr_next, $1
+GETWORD $5, $2, $3
+SETWORD $0, $4, $5
+ADDI $3, $3, 1
+ADDI $4, $4, 1
+JUMP concatStr_loop
+LABEL concatStr_end
+ADDI $SP, $SP, 1
+SET $1, [$SP]
+SET $2, [$SP-1]
+ADDI $2, $2, 2
+SUBI $SP, $SP, $2
+RETURN $1)vc";
+        static const auto concat_strings_code = Code::parse(std::string(concat_strings));
+        out.blank();
+        out.append(concat_strings_code);
+    }
 }
 
-bool vypcomp::Generator::is_builtin_func(std::string func_name) const
+bool vypcomp::Generator::is_builtin_func(const ir::Name& func_name) const
 {
+    static const ir::Name print("print"), readInt("readInt"), readFloat("readFloat"),
+        readString("readString"), length("length"), subStr("subStr");
     if (
-        func_name == "print" ||
-        func_name == "readInt" ||
-        func_name == "readFloat" ||
-        func_name == "readString" ||
-        func_name == "length" ||
-        func_name == "subStr"
+        func_name == print ||
+        func_name == readInt ||
+        func_name == readFloat ||
+        func_name == readString ||
+        func_name == length ||
+        func_name == subStr
     ) {
         return true;
     }
     return false;
 }
 
-std::size_t vypcomp::Generator::get_object_attribute_offset(vypcomp::ir::Class::Ptr class_ptr, const std::string& attribute_name)
+std::size_t vypcomp::Generator::get_object_attribute_offset(vypcomp::ir::Class::Ptr class_ptr, const ir::Name& attribute_name)
 {
     if (!class_ptr) return 0;
     auto parent_ptr = class_ptr->getBase();
@@ -1285,9 +2004,9 @@ std::size_t vypcomp::Generator::get_object_attribute_offset(vypcomp::ir::Class::
         auto parent_offset = parent_ptr ? get_object_size(parent_ptr) : 0;
         std::size_t attr_offset = parent_offset;
         // now search for the attribute in this class
-        for (auto& atrr_list : { class_ptr->publicAttributes(), class_ptr->protectedAttributes(), class_ptr->privateAttributes() })
+        for (auto atrr_list : { &class_ptr->publicAttributes(), &class_ptr->protectedAttributes(), &class_ptr->privateAttributes() })
         {
-            for (auto& attr : atrr_list)
+            for (auto& attr : *atrr_list)
             {
                 if (attr->name() == attribute_name) return attr_offset;
                 attr_offset += 1;
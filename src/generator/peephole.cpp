@@ -0,0 +1,525 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <cctype>
+#include <cstdlib>
+#include <optional>
+#include <unordered_set>
+
+#include <vypcomp/generator/peephole.h>
+
+using namespace vypcomp;
+
+namespace
+{
+
+using Registers = std::uint64_t;
+
+constexpr Registers ALL_REGISTERS = ~Registers(0);
+
+/**
+ * Access to operands of instructions: w written, r read, l label.
+ * Second operand of CALL is label or value holding its name.
+ */
+const std::string* signature(const CodeLine& line)
+{
+    static const std::unordered_map<std::string, std::string> signatures = {
+        {"SET", "wr"}, {"CREATE", "wr"}, {"COPY", "wr"}, {"GETSIZE", "wr"},
+        {"GETWORD", "wrr"}, {"SETWORD", "rrr"}, {"RESIZE", "rr"}, {"DESTROY", "r"},
+        {"ADDI", "wrr"}, {"SUBI", "wrr"}, {"MULI", "wrr"}, {"DIVI", "wrr"},
+        {"ADDF", "wrr"}, {"SUBF", "wrr"}, {"MULF", "wrr"}, {"DIVF", "wrr"},
+        {"LTI", "wrr"}, {"LTF", "wrr"}, {"LTS", "wrr"},
+        {"EQI", "wrr"}, {"EQF", "wrr"}, {"EQS", "wrr"},
+        {"GTI", "wrr"}, {"GTF", "wrr"}, {"GTS", "wrr"},
+        {"AND", "wrr"}, {"OR", "wrr"}, {"NOT", "wr"},
+        {"INT2FLOAT", "wr"}, {"FLOAT2INT", "wr"}, {"INT2STRING", "wr"}, {"FLOAT2STRING", "wr"},
+        {"JUMP", "l"}, {"JUMPZ", "lr"}, {"JUMPNZ", "lr"}, {"CALL", "wr"}, {"RETURN", "r"},
+        {"READI", "w"}, {"READF", "w"}, {"READS", "w"},
+        {"WRITEI", "r"}, {"WRITEF", "r"}, {"WRITES", "r"}
+    };
+
+    auto result = signatures.find(line.opcode);
+    if (result == signatures.end() || result->second.size() != line.operands.size())
+        return nullptr;
+
+    return &result->second;
+}
+
+/**
+ * Index of register $N. Registers that do not fit into the set
+ * are not tracked.
+ */
+std::optional<std::size_t> register_index(const std::string& operand)
+{
+    if (operand.size() < 2 || operand[0] != '$' || !std::isdigit(static_cast<unsigned char>(operand[1])))
+        return std::nullopt;
+
+    auto index = std::strtoul(operand.c_str() + 1, nullptr, 10);
+    if (index >= 64)
+        return std::nullopt;
+
+    return index;
+}
+
+Registers registers(const CodeLine& line, char access)
+{
+    auto sig = signature(line);
+    if (!sig)
+        return access == 'w' ? 0 : ALL_REGISTERS;
+
+    Registers result = 0;
+    for (std::size_t i = 0; i < sig->size(); i++)
+    {
+        if ((*sig)[i] != access)
+            continue;
+
+        if (auto index = register_index(line.operands[i]))
+            result |= Registers(1) << *index;
+    }
+
+    return result;
+}
+
+Registers uses(const CodeLine& line)
+{
+    auto result = registers(line, 'r');
+    // Returned value is passed in $0.
+    if (line.opcode == "RETURN")
+        result |= 1;
+
+    return result;
+}
+
+Registers defs(const CodeLine& line)
+{
+    // Callee may overwrite any register.
+    if (line.opcode == "CALL")
+        return ALL_REGISTERS;
+
+    return registers(line, 'w');
+}
+
+bool is_jump(const CodeLine& line)
+{
+    return (line.opcode == "JUMP" || line.opcode == "JUMPZ" || line.opcode == "JUMPNZ") && !line.operands.empty();
+}
+
+std::optional<long long> integer(const std::string& operand)
+{
+    if (operand.empty())
+        return std::nullopt;
+
+    char* end = nullptr;
+    auto result = std::strtoll(operand.c_str(), &end, 10);
+    if (*end != '\0')
+        return std::nullopt;
+
+    return result;
+}
+
+/**
+ * Amount by which instruction moves $SP, if it only moves $SP by
+ * constant.
+ */
+std::optional<long long> stack_adjust(const CodeLine& line)
+{
+    if ((line.opcode != "ADDI" && line.opcode != "SUBI") || line.operands.size() != 3)
+        return std::nullopt;
+    if (line.operands[0] != "$SP" || line.operands[1] != "$SP")
+        return std::nullopt;
+
+    auto amount = integer(line.operands[2]);
+    if (!amount)
+        return std::nullopt;
+
+    return line.opcode == "ADDI" ? *amount : -*amount;
+}
+
+/**
+ * Index of the first line after i holding instruction, optionally
+ * skipping labels too.
+ */
+std::size_t next_instruction(const Code::Lines& lines, std::size_t i, bool skip_labels)
+{
+    for (i++; i < lines.size(); i++)
+    {
+        if (lines[i].is_instruction() || (lines[i].is_label() && !skip_labels))
+            break;
+    }
+
+    return i;
+}
+
+std::unordered_map<std::string, std::size_t> find_labels(const Code::Lines& lines)
+{
+    std::unordered_map<std::string, std::size_t> result;
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        if (lines[i].is_label() && !lines[i].operands.empty())
+            result[lines[i].operands[0]] = i;
+    }
+
+    return result;
+}
+
+/**
+ * Label named by operand, labels are referenced by jumps and calls,
+ * or by strings holding their names (vtables).
+ */
+std::string label_name(const std::string& operand)
+{
+    if (operand.size() >= 2 && operand.front() == '"')
+        return operand.substr(1, operand.size() - 2);
+
+    return operand;
+}
+
+bool erase(Code::Lines& lines, const std::vector<bool>& removed)
+{
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        if (removed[i])
+            continue;
+
+        if (kept != i)
+            lines[kept] = std::move(lines[i]);
+        kept++;
+    }
+
+    auto changed = kept != lines.size();
+    lines.resize(kept);
+    return changed;
+}
+
+/**
+ * Checks whether value copied into register can be used by the
+ * following instruction directly.
+ */
+bool can_forward(const CodeLine& line, const std::string& reg, const std::string& value, bool live_after)
+{
+    auto sig = signature(line);
+    if (!sig || line.opcode == "CALL")
+        return false;
+
+    bool reads = false, writes_reg = false, writes_stack = false;
+    for (std::size_t i = 0; i < sig->size(); i++)
+    {
+        if ((*sig)[i] == 'w')
+        {
+            writes_reg = writes_reg || line.operands[i] == reg;
+            writes_stack = writes_stack || line.operands[i] == "$SP";
+        }
+        else if ((*sig)[i] == 'r')
+        {
+            reads = reads || line.operands[i] == reg;
+        }
+    }
+
+    // Stack relative value would be read after $SP changes.
+    if (writes_stack && value.find("$SP") != std::string::npos)
+        return false;
+
+    return reads && (writes_reg || !live_after);
+}
+
+}
+
+void vypcomp::Peephole::run(Code& code)
+{
+    auto& lines = code.lines();
+    bool changed;
+    do
+    {
+        compute_liveness(lines);
+        changed = forward_copies(lines);
+        changed |= thread_jumps(lines);
+        changed |= remove_unreachable(lines);
+        changed |= remove_labels(lines);
+        changed |= merge_stack_adjusts(lines);
+    }
+    while (changed);
+}
+
+std::size_t vypcomp::Peephole::hits(Rule rule) const
+{
+    return rule_hits[static_cast<std::size_t>(rule)];
+}
+
+std::string vypcomp::Peephole::name(Rule rule)
+{
+    switch (rule)
+    {
+    case Rule::CopyForwarding:
+        return "copy forwarding";
+    case Rule::JumpThreading:
+        return "jump threading";
+    case Rule::RedundantLabels:
+        return "redundant labels";
+    case Rule::StackAdjustMerging:
+        return "stack adjust merging";
+    }
+
+    return "unknown";
+}
+
+void vypcomp::Peephole::report(std::ostream& out) const
+{
+    for (auto rule : RULES)
+        out << "# peephole " << name(rule) << ": " << hits(rule) << '\n';
+}
+
+void vypcomp::Peephole::hit(Rule rule)
+{
+    rule_hits[static_cast<std::size_t>(rule)]++;
+}
+
+void vypcomp::Peephole::compute_liveness(const Code::Lines& lines)
+{
+    label_positions = find_labels(lines);
+
+    std::vector<Registers> live_in(lines.size(), 0);
+    live_out.assign(lines.size(), 0);
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto i = lines.size(); i-- > 0;)
+        {
+            auto& line = lines[i];
+            Registers out = 0;
+            if (line.opcode != "JUMP" && line.opcode != "RETURN" && i + 1 < lines.size())
+                out |= live_in[i + 1];
+            if (is_jump(line))
+            {
+                auto target = label_positions.find(line.operands[0]);
+                out |= target == label_positions.end() ? ALL_REGISTERS : live_in[target->second];
+            }
+
+            auto in = line.is_instruction() ? uses(line) | (out & ~defs(line)) : out;
+            if (in != live_in[i] || out != live_out[i])
+            {
+                live_in[i] = in;
+                live_out[i] = out;
+                changed = true;
+            }
+        }
+    }
+}
+
+bool vypcomp::Peephole::forward_copies(Code::Lines& lines)
+{
+    std::vector<bool> removed(lines.size(), false);
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        auto& line = lines[i];
+        if (removed[i] || line.opcode != "SET" || line.operands.size() != 2)
+            continue;
+
+        auto destination = line.operands[0];
+        auto value = line.operands[1];
+        auto next = next_instruction(lines, i, false);
+
+        if (auto reg = register_index(destination))
+        {
+            auto live = (live_out[i] >> *reg) & 1;
+            if (destination == value || !live)
+            {
+                removed[i] = true;
+                hit(Rule::CopyForwarding);
+                continue;
+            }
+
+            if (next < lines.size() && lines[next].is_instruction()
+                    && can_forward(lines[next], destination, value, (live_out[next] >> *reg) & 1))
+            {
+                auto sig = signature(lines[next]);
+                for (std::size_t k = 0; k < sig->size(); k++)
+                {
+                    if ((*sig)[k] == 'r' && lines[next].operands[k] == destination)
+                        lines[next].operands[k] = value;
+                }
+
+                removed[i] = true;
+                hit(Rule::CopyForwarding);
+                continue;
+            }
+        }
+
+        // Copy back of just copied value.
+        if (next < lines.size() && lines[next].opcode == "SET" && lines[next].operands.size() == 2
+                && lines[next].operands[0] == value && lines[next].operands[1] == destination)
+        {
+            removed[next] = true;
+            hit(Rule::CopyForwarding);
+        }
+    }
+
+    return erase(lines, removed);
+}
+
+bool vypcomp::Peephole::thread_jumps(Code::Lines& lines)
+{
+    auto labels = find_labels(lines);
+    bool changed = false;
+    std::vector<bool> removed(lines.size(), false);
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        auto& line = lines[i];
+        if (removed[i])
+            continue;
+
+        if (is_jump(line))
+        {
+            // Jump to unconditional jump goes directly to its target.
+            auto target = line.operands[0];
+            std::unordered_set<std::string> visited{target};
+            for (auto label = labels.find(target); label != labels.end(); label = labels.find(target))
+            {
+                auto next = next_instruction(lines, label->second, true);
+                if (next == lines.size() || lines[next].opcode != "JUMP" || !is_jump(lines[next]))
+                    break;
+                if (!visited.insert(lines[next].operands[0]).second)
+                    break;
+
+                target = lines[next].operands[0];
+            }
+
+            if (target != line.operands[0])
+            {
+                line.operands[0] = target;
+                hit(Rule::JumpThreading);
+                changed = true;
+            }
+
+            // Jump to label that directly follows.
+            for (auto k = i + 1; k < lines.size() && !lines[k].is_instruction(); k++)
+            {
+                if (lines[k].is_label() && !lines[k].operands.empty() && lines[k].operands[0] == target)
+                {
+                    removed[i] = true;
+                    hit(Rule::JumpThreading);
+                    break;
+                }
+            }
+
+            if (removed[i])
+                continue;
+        }
+    }
+
+    return erase(lines, removed) || changed;
+}
+
+bool vypcomp::Peephole::remove_unreachable(Code::Lines& lines)
+{
+    // Program runs from its first line, every label named by reachable
+    // instruction is reachable. Code that only jumps to itself, such as
+    // loop of unused builtin, is removed as a whole.
+    auto labels = find_labels(lines);
+    std::vector<bool> reachable(lines.size(), false);
+    std::vector<std::size_t> pending{0};
+    while (!pending.empty())
+    {
+        auto i = pending.back();
+        pending.pop_back();
+        for (; i < lines.size() && !reachable[i]; i++)
+        {
+            reachable[i] = true;
+            auto& line = lines[i];
+            if (!line.is_instruction())
+                continue;
+
+            for (auto& operand : line.operands)
+            {
+                auto label = labels.find(label_name(operand));
+                if (label != labels.end())
+                    pending.push_back(label->second);
+            }
+
+            if (line.opcode == "JUMP" || line.opcode == "RETURN")
+                break;
+        }
+    }
+
+    std::vector<bool> removed(lines.size(), false);
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        if (!reachable[i] && lines[i].is_instruction())
+        {
+            removed[i] = true;
+            hit(Rule::JumpThreading);
+        }
+    }
+
+    return erase(lines, removed);
+}
+
+bool vypcomp::Peephole::remove_labels(Code::Lines& lines)
+{
+    std::unordered_set<std::string> referenced;
+    for (auto& line : lines)
+    {
+        if (line.is_label())
+            continue;
+
+        for (auto& operand : line.operands)
+            referenced.insert(label_name(operand));
+    }
+
+    std::vector<bool> removed(lines.size(), false);
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        if (lines[i].is_label() && !lines[i].operands.empty() && !referenced.count(lines[i].operands[0]))
+        {
+            removed[i] = true;
+            hit(Rule::RedundantLabels);
+        }
+    }
+
+    return erase(lines, removed);
+}
+
+bool vypcomp::Peephole::merge_stack_adjusts(Code::Lines& lines)
+{
+    bool changed = false;
+    std::vector<bool> removed(lines.size(), false);
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        auto amount = stack_adjust(lines[i]);
+        if (removed[i] || !amount)
+            continue;
+
+        auto total = *amount;
+        auto merged = false;
+        for (auto next = next_instruction(lines, i, false); next < lines.size(); next = next_instruction(lines, next, false))
+        {
+            auto next_amount = stack_adjust(lines[next]);
+            if (!next_amount)
+                break;
+
+            total += *next_amount;
+            removed[next] = true;
+            merged = true;
+            hit(Rule::StackAdjustMerging);
+        }
+
+        if (total == 0)
+        {
+            removed[i] = true;
+            if (!merged)
+                hit(Rule::StackAdjustMerging);
+        }
+        else if (merged)
+        {
+            lines[i].opcode = total > 0 ? "ADDI" : "SUBI";
+            lines[i].operands[2] = std::to_string(total > 0 ? total : -total);
+            changed = true;
+        }
+    }
+
+    return erase(lines, removed) || changed;
+}
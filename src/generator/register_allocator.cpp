@@ -0,0 +1,385 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <algorithm>
+#include <cctype>
+
+#include <vypcomp/generator/register_allocator.h>
+
+using namespace vypcomp;
+
+vypcomp::RegisterAllocator::RegisterAllocator(const TempVarMap& temporary_variables_mapping)
+    : temporary_variables_mapping(temporary_variables_mapping)
+{
+}
+
+bool vypcomp::RegisterAllocator::is_allocated_register(const std::string& location)
+{
+    if (location.size() != 2 || location[0] != '$' || !std::isdigit(static_cast<unsigned char>(location[1])))
+        return false;
+    std::size_t reg = location[1] - '0';
+    return reg >= FIRST_REGISTER && reg < REGISTER_COUNT;
+}
+
+vypcomp::RegisterAllocator::RegisterMap vypcomp::RegisterAllocator::allocate(const AllocaVector& args, const AllocaVector& local_variables, vypcomp::ir::BasicBlock::Ptr body)
+{
+    std::vector<AllocaRawPtr> variables;
+    for (auto& list : { &args, &local_variables })
+    {
+        for (auto& alloca_instr : *list)
+        {
+            variable_ids[alloca_instr.get()] = variables.size();
+            variables.push_back(alloca_instr.get());
+        }
+    }
+    loads_saved.assign(variables.size(), 0);
+
+    // arguments are defined by the caller, they are loaded into registers in the function prolog
+    auto prolog = add_point();
+    for (auto& arg : args)
+        points[prolog].defs.push_back(variable_ids[arg.get()]);
+    visit_block(body);
+    // function epilog, end of the last block and branches leaving it lead here
+    points[add_point()].falls_through = false;
+
+    for (std::size_t i = 0; i < points.size(); i++)
+    {
+        if (points[i].falls_through && i + 1 < points.size())
+            points[i].successors.push_back(i + 1);
+    }
+
+    auto live_in = compute_liveness();
+
+    std::vector<std::size_t> references(variables.size(), 0);
+    std::vector<bool> live_across_call(variables.size(), false);
+    std::vector<Interval> intervals;
+    for (auto variable : variables)
+        intervals.push_back(Interval{variable, points.size(), 0});
+    for (std::size_t i = 0; i < points.size(); i++)
+    {
+        auto& point = points[i];
+        for (auto& list : { &point.uses, &point.defs })
+        {
+            for (auto id : *list)
+            {
+                references[id]++;
+                intervals[id].start = std::min(intervals[id].start, i);
+                intervals[id].end = std::max(intervals[id].end, i);
+            }
+        }
+        for (std::size_t id = 0; id < variables.size(); id++)
+        {
+            if (!live_in[i][id]) continue;
+            intervals[id].start = std::min(intervals[id].start, i);
+            intervals[id].end = std::max(intervals[id].end, i);
+        }
+        // every CALL clobbers all registers
+        if (point.call)
+        {
+            for (auto successor : point.successors)
+            {
+                for (std::size_t id = 0; id < variables.size(); id++)
+                    live_across_call[id] = live_across_call[id] || live_in[successor][id];
+            }
+        }
+    }
+
+    std::vector<Interval> candidates;
+    for (std::size_t id = 0; id < variables.size(); id++)
+    {
+        if (live_across_call[id])
+            continue;
+        // loading argument costs an instruction in the prolog, it has to save more than that
+        if (id < args.size() ? loads_saved[id] > 1 : references[id] > 0)
+            candidates.push_back(intervals[id]);
+    }
+
+    return linear_scan(std::move(candidates));
+}
+
+void vypcomp::RegisterAllocator::visit_block(vypcomp::ir::BasicBlock::Ptr block)
+{
+    if (!block) return;
+    for (auto instruction = block->first(); instruction != nullptr; instruction = instruction->next())
+    {
+        visit_instruction(instruction);
+    }
+}
+
+void vypcomp::RegisterAllocator::visit_instruction(vypcomp::ir::Instruction::Ptr input)
+{
+    switch (input->kind())
+    {
+    case ir::Instruction::Kind::Assignment:
+    {
+        auto instr = static_cast<ir::Assignment*>(input.get());
+        visit_expression(instr->getExpr());
+        if (instr->getAlloca())
+            define(instr->getAlloca().get());
+        break;
+    }
+    case ir::Instruction::Kind::ObjectAssignment:
+    {
+        auto instr = static_cast<ir::ObjectAssignment*>(input.get());
+        visit_expression(instr->getExpr());
+        if (auto target = ir::as<ir::ObjectAttributeExpression>(instr->getTarget().get()))
+            use(target->getObject().get());
+        break;
+    }
+    case ir::Instruction::Kind::Return:
+    {
+        auto instr = static_cast<ir::Return*>(input.get());
+        if (!instr->isVoid())
+            visit_expression(instr->getExpr());
+        points[add_point()].falls_through = false;
+        break;
+    }
+    case ir::Instruction::Kind::Branch:
+    {
+        // condition is emitted first, followed by if and else blocks
+        auto instr = static_cast<ir::BranchInstruction*>(input.get());
+        visit_expression(instr->getExpr());
+        auto branch = add_point();
+        visit_block(instr->getIf());
+        auto jump_end = add_point();
+        points[jump_end].falls_through = false;
+        points[branch].successors.push_back(points.size());
+        visit_block(instr->getElse());
+        points[jump_end].successors.push_back(points.size());
+        break;
+    }
+    case ir::Instruction::Kind::Loop:
+    {
+        auto instr = static_cast<ir::LoopInstruction*>(input.get());
+        auto condition = add_point();
+        loop_depth++;
+        visit_expression(instr->getExpr());
+        auto branch = add_point();
+        visit_block(instr->getBody());
+        loop_depth--;
+        auto jump_condition = add_point();
+        points[jump_condition].falls_through = false;
+        points[jump_condition].successors.push_back(condition);
+        points[branch].successors.push_back(points.size());
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void vypcomp::RegisterAllocator::visit_expression(const ir::Expression::ValueType& input)
+{
+    switch (input->kind())
+    {
+    case ir::Expression::Kind::Symbol:
+    case ir::Expression::Kind::Super:
+    {
+        use(static_cast<ir::SymbolExpression*>(input.get())->getValue().get());
+        break;
+    }
+    case ir::Expression::Kind::Function:
+    case ir::Expression::Kind::Constructor:
+    case ir::Expression::Kind::Method:
+    {
+        auto func_expr = static_cast<ir::FunctionExpression*>(input.get());
+        for (auto& argument : func_expr->getArgs())
+            visit_expression(argument);
+        // print is expanded into WRITE instructions at call site
+        if (input->kind() != ir::Expression::Kind::Function || func_expr->getFunction()->name() != "print")
+            points[add_point()].call = true;
+        define_result(input);
+        break;
+    }
+    case ir::Expression::Kind::Add:
+    case ir::Expression::Kind::Subtract:
+    case ir::Expression::Kind::Multiply:
+    case ir::Expression::Kind::Divide:
+    case ir::Expression::Kind::Comparison:
+    case ir::Expression::Kind::And:
+    case ir::Expression::Kind::Or:
+    {
+        auto binop = static_cast<ir::BinaryOpExpression*>(input.get());
+        auto op1 = binop->getOp1();
+        auto op2 = binop->getOp2();
+        if (!op1->is_simple())
+            visit_expression(op1);
+        if (!op2->is_simple())
+            visit_expression(op2);
+        // simple operands are read only after both operands are computed
+        visit_operand(op1, true);
+        visit_operand(op2, true);
+        // string concatenation is done by addStr subroutine
+        if (input->kind() == ir::Expression::Kind::Add && input->type() == ir::Datatype(ir::PrimitiveDatatype::String))
+            points[add_point()].call = true;
+        define_result(input);
+        break;
+    }
+    case ir::Expression::Kind::Concat:
+    {
+        auto& operands = static_cast<ir::ConcatExpression*>(input.get())->getOperands();
+        for (auto& operand : operands)
+        {
+            if (!operand->is_simple())
+                visit_expression(operand);
+        }
+        // operands are stored for concatStr subroutine once all of them are computed
+        for (auto& operand : operands)
+            visit_operand(operand, true);
+        points[add_point()].call = true;
+        define_result(input);
+        break;
+    }
+    case ir::Expression::Kind::ObjectAttribute:
+    {
+        use(static_cast<ir::ObjectAttributeExpression*>(input.get())->getObject().get());
+        define_result(input);
+        break;
+    }
+    case ir::Expression::Kind::StringCast:
+    case ir::Expression::Kind::Not:
+    case ir::Expression::Kind::ObjectCast:
+    {
+        ir::Expression::ValueType operand;
+        if (auto cast = ir::as<ir::StringCastExpression>(input.get()))
+            operand = cast->getOperand();
+        else if (auto not_expr = ir::as<ir::NotExpression>(input.get()))
+            operand = not_expr->getOperand();
+        else
+            operand = static_cast<ir::ObjectCastExpression*>(input.get())->getOperand();
+        if (!operand->is_simple())
+            visit_expression(operand);
+        visit_operand(operand, false);
+        define_result(input);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void vypcomp::RegisterAllocator::visit_operand(const ir::Expression::ValueType& operand, bool in_place)
+{
+    if (auto symbol = ir::as<ir::SymbolExpression>(operand.get()))
+        use(symbol->getValue().get(), in_place);
+    else if (!operand->is_simple())
+        use_result(operand);
+}
+
+std::size_t vypcomp::RegisterAllocator::add_point()
+{
+    points.emplace_back();
+    return points.size() - 1;
+}
+
+void vypcomp::RegisterAllocator::use(AllocaRawPtr variable, bool in_place)
+{
+    if (auto id = variable_ids.find(variable); id != variable_ids.end())
+    {
+        points[add_point()].uses.push_back(id->second);
+        // operand kept in register is not loaded into scratch register, inside of loops it pays off repeatedly
+        if (in_place)
+            loads_saved[id->second] += loop_depth ? 2 : 1;
+    }
+}
+
+void vypcomp::RegisterAllocator::define(AllocaRawPtr variable)
+{
+    if (auto id = variable_ids.find(variable); id != variable_ids.end())
+        points[add_point()].defs.push_back(id->second);
+}
+
+void vypcomp::RegisterAllocator::define_result(const ir::Expression::ValueType& expr)
+{
+    if (auto temporary = temporary_variables_mapping.find(expr.get()); temporary != temporary_variables_mapping.end())
+        define(temporary->second);
+}
+
+void vypcomp::RegisterAllocator::use_result(const ir::Expression::ValueType& expr)
+{
+    if (auto temporary = temporary_variables_mapping.find(expr.get()); temporary != temporary_variables_mapping.end())
+        use(temporary->second);
+}
+
+std::vector<std::vector<bool>> vypcomp::RegisterAllocator::compute_liveness() const
+{
+    std::vector<std::vector<bool>> live_in(points.size(), std::vector<bool>(variable_ids.size(), false));
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto i = points.size(); i > 0; i--)
+        {
+            auto& point = points[i - 1];
+            std::vector<bool> live(variable_ids.size(), false);
+            for (auto successor : point.successors)
+            {
+                for (std::size_t id = 0; id < live.size(); id++)
+                    live[id] = live[id] || live_in[successor][id];
+            }
+            for (auto id : point.defs)
+                live[id] = false;
+            for (auto id : point.uses)
+                live[id] = true;
+            if (live != live_in[i - 1])
+            {
+                live_in[i - 1] = std::move(live);
+                changed = true;
+            }
+        }
+    }
+    return live_in;
+}
+
+vypcomp::RegisterAllocator::RegisterMap vypcomp::RegisterAllocator::linear_scan(std::vector<Interval> candidates) const
+{
+    std::sort(candidates.begin(), candidates.end(), [](const Interval& a, const Interval& b) {
+        return a.start < b.start || (a.start == b.start && a.end < b.end);
+    });
+
+    RegisterMap result;
+    std::vector<std::size_t> free_registers;
+    for (auto reg = REGISTER_COUNT; reg > FIRST_REGISTER; reg--)
+        free_registers.push_back(reg - 1);
+    // active intervals with their registers
+    std::vector<std::pair<Interval, std::size_t>> active;
+
+    for (auto& current : candidates)
+    {
+        // expire intervals that ended before current one starts
+        for (auto i = active.begin(); i != active.end();)
+        {
+            if (i->first.end < current.start)
+            {
+                free_registers.push_back(i->second);
+                i = active.erase(i);
+            }
+            else
+                i++;
+        }
+
+        if (!free_registers.empty())
+        {
+            auto reg = free_registers.back();
+            free_registers.pop_back();
+            active.emplace_back(current, reg);
+            result[current.variable] = "$" + std::to_string(reg);
+            continue;
+        }
+
+        // spill the interval that ends last
+        auto furthest = std::max_element(active.begin(), active.end(), [](const auto& a, const auto& b) {
+            return a.first.end < b.first.end;
+        });
+        if (furthest->first.end > current.end)
+        {
+            auto reg = furthest->second;
+            result.erase(furthest->first.variable);
+            *furthest = std::make_pair(current, reg);
+            result[current.variable] = "$" + std::to_string(reg);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,521 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "vypcomp/interpreter/interpreter.h"
+
+using namespace vypcomp::vypcode;
+
+// Computed goto is GNU extension, other compilers use switch.
+#if defined(__GNUC__) || defined(__clang__)
+#define VYPCODE_THREADED_DISPATCH 1
+#endif
+
+namespace {
+
+const Value zero;
+
+/**
+ * Formats float the way reference vypint does (0x1.8p1, 0x1.0p0),
+ * which differs from C %a by the exponent sign and mandatory fraction.
+ */
+std::string floatString(double f)
+{
+	if (std::isnan(f))
+		return "NaN";
+	if (std::isinf(f))
+		return f < 0 ? "-Infinity" : "Infinity";
+
+	char buf[64] = { 0 };
+	std::snprintf(buf, sizeof(buf), "%a", f);
+	std::string result = buf;
+
+	auto exponent = result.find('p');
+	if (result.compare(0, exponent, f < 0 ? "-0x0" : "0x0") == 0)
+		return f < 0 ? "-0x0.0p0" : "0x0.0p0";
+	if (result[exponent+1] == '+')
+		result.erase(exponent+1, 1);
+	if (result.find('.') == std::string::npos)
+		result.insert(exponent, ".0");
+
+	return result;
+}
+
+}
+
+RuntimeError::RuntimeError(const std::string& msg):
+	msg(msg)
+{
+}
+
+const char * RuntimeError::what() const throw()
+{
+	return msg.c_str();
+}
+
+Interpreter::Interpreter(const Program& program, std::istream& in, std::ostream& out):
+	_program(program),
+	_in(in),
+	_out(out)
+{
+}
+
+std::uint64_t Interpreter::executed() const
+{
+	return _executed;
+}
+
+inline Value& Interpreter::cell(std::int64_t address)
+{
+	if (address < 0)
+		throw RuntimeError("access to negative stack address "+std::to_string(address));
+
+	auto index = static_cast<std::size_t>(address);
+	if (index >= _stack.size())
+		_stack.resize(std::max(index+1, _stack.size()*2));
+
+	return _stack[index];
+}
+
+/**
+ * Reads never resize stack, so references obtained by read stay
+ * valid until next write.
+ */
+inline const Value& Interpreter::read(const Operand& op)
+{
+	std::int64_t address;
+	switch (op.kind) {
+	case Operand::Kind::Register:
+		return _registers[op.reg];
+	case Operand::Kind::Constant:
+		return _program.constants()[op.value];
+	case Operand::Kind::Memory:
+		address = _registers[op.reg].asInt() + op.value;
+		break;
+	default:
+		address = op.value;
+		break;
+	}
+
+	if (address < 0)
+		throw RuntimeError("access to negative stack address "+std::to_string(address));
+	if (static_cast<std::size_t>(address) >= _stack.size())
+		return zero;
+
+	return _stack[address];
+}
+
+inline Value& Interpreter::write(const Operand& op)
+{
+	switch (op.kind) {
+	case Operand::Kind::Register:
+		return _registers[op.reg];
+	case Operand::Kind::Memory:
+		return cell(_registers[op.reg].asInt() + op.value);
+	case Operand::Kind::Absolute:
+		return cell(op.value);
+	default:
+		throw RuntimeError("constant operand cannot be modified");
+	}
+}
+
+inline std::int64_t Interpreter::integer(const Value& v) const
+{
+	if (!v.isInt())
+		throw RuntimeError("expected integer operand");
+
+	return v.asInt();
+}
+
+inline double Interpreter::real(const Value& v) const
+{
+	if (!v.isFloat())
+		throw RuntimeError("expected float operand");
+
+	return v.asFloat();
+}
+
+const std::string& Interpreter::text(const Value& v, std::string& scratch)
+{
+	if (v.isString())
+		return v.asString();
+
+	scratch.clear();
+	for (auto& word: chunk(v).words) {
+		if (!word.isString())
+			throw RuntimeError("expected string operand");
+		scratch += word.asString();
+	}
+
+	return scratch;
+}
+
+Interpreter::Chunk& Interpreter::chunk(const Value& v)
+{
+	auto id = integer(v);
+	if (id <= 0 || static_cast<std::size_t>(id) >= _chunks.size() || !_chunks[id].alive)
+		throw RuntimeError("invalid chunk "+std::to_string(id));
+
+	return _chunks[id];
+}
+
+std::int64_t Interpreter::callTarget(const Operand& op)
+{
+	if (op.kind == Operand::Kind::Label)
+		return op.value;
+
+	auto& target = read(op);
+	if (target.isInt())
+		return target.asInt();
+
+	std::string scratch;
+	auto& label = text(target, scratch);
+	auto address = _program.address(label);
+	if (!address)
+		throw RuntimeError("call to undefined label "+label);
+
+	return *address;
+}
+
+std::string Interpreter::readLine()
+{
+	std::string line;
+	std::getline(_in, line);
+	if (!line.empty() && line.back() == '\r')
+		line.pop_back();
+
+	return line;
+}
+
+void Interpreter::run()
+{
+	const auto& code = _program.code();
+	_registers.assign(_program.registers(), Value());
+	_stack.assign(1024, Value());
+	// Id 0 is never valid chunk.
+	_chunks.assign(1, Chunk{{}, false});
+	_executed = 0;
+
+	std::size_t pc = 0;
+	const Instruction* instr = nullptr;
+	std::string scratch1, scratch2;
+
+#ifdef VYPCODE_THREADED_DISPATCH
+	// Order must match Opcode.
+	static const void* const handlers[] = {
+		&&op_Set, &&op_Create, &&op_Copy, &&op_GetSize, &&op_GetWord,
+		&&op_SetWord, &&op_Resize, &&op_Destroy,
+		&&op_AddI, &&op_SubI, &&op_MulI, &&op_DivI,
+		&&op_AddF, &&op_SubF, &&op_MulF, &&op_DivF,
+		&&op_LtI, &&op_LtF, &&op_LtS, &&op_EqI, &&op_EqF, &&op_EqS,
+		&&op_GtI, &&op_GtF, &&op_GtS,
+		&&op_And, &&op_Or, &&op_Not,
+		&&op_Int2Float, &&op_Float2Int, &&op_Int2String, &&op_Float2String,
+		&&op_Jump, &&op_JumpZ, &&op_JumpNZ, &&op_Call, &&op_Return,
+		&&op_ReadI, &&op_ReadF, &&op_ReadS,
+		&&op_WriteI, &&op_WriteF, &&op_WriteS,
+		&&op_Halt
+	};
+	static_assert(sizeof(handlers)/sizeof(handlers[0]) == static_cast<std::size_t>(Opcode::Halt)+1);
+
+	// Each instruction is replaced by address of its handler.
+	std::vector<const void*> threaded(code.size());
+	for (std::size_t i = 0; i < code.size(); i++)
+		threaded[i] = handlers[static_cast<std::size_t>(code[i].op)];
+
+#define VYPCODE_CASE(name) op_##name:
+#define VYPCODE_DISPATCH() do { _executed++; instr = &code[pc]; goto *threaded[pc++]; } while (0)
+
+	VYPCODE_DISPATCH();
+	{
+#else
+#define VYPCODE_CASE(name) case Opcode::name:
+#define VYPCODE_DISPATCH() continue
+
+	for (;;) {
+		_executed++;
+		instr = &code[pc++];
+		switch (instr->op) {
+#endif
+
+#define VYPCODE_JUMP(address) do { \
+		std::int64_t jumpTarget = (address); \
+		if (jumpTarget < 0 || static_cast<std::size_t>(jumpTarget) >= code.size()) \
+			throw RuntimeError("jump to invalid address "+std::to_string(jumpTarget)); \
+		pc = jumpTarget; \
+	} while (0)
+
+#define VYPCODE_ARITHMETIC(name, type, getter, op) \
+	VYPCODE_CASE(name) { \
+		type result = getter(read(instr->ops[1])) op getter(read(instr->ops[2])); \
+		write(instr->ops[0]) = Value(result); \
+		VYPCODE_DISPATCH(); \
+	}
+
+// Integer operations wrap around on overflow, unsigned arithmetic
+// does so without undefined behaviour.
+#define VYPCODE_INTEGER_ARITHMETIC(name, op) \
+	VYPCODE_CASE(name) { \
+		auto result = static_cast<std::uint64_t>(integer(read(instr->ops[1]))) op static_cast<std::uint64_t>(integer(read(instr->ops[2]))); \
+		write(instr->ops[0]) = Value(static_cast<std::int64_t>(result)); \
+		VYPCODE_DISPATCH(); \
+	}
+
+#define VYPCODE_COMPARISON(name, getter, op) \
+	VYPCODE_CASE(name) { \
+		std::int64_t result = getter(read(instr->ops[1])) op getter(read(instr->ops[2])); \
+		write(instr->ops[0]) = Value(result); \
+		VYPCODE_DISPATCH(); \
+	}
+
+#define VYPCODE_STRING_COMPARISON(name, op) \
+	VYPCODE_CASE(name) { \
+		std::int64_t result = text(read(instr->ops[1]), scratch1) op text(read(instr->ops[2]), scratch2); \
+		write(instr->ops[0]) = Value(result); \
+		VYPCODE_DISPATCH(); \
+	}
+
+	VYPCODE_CASE(Set) {
+		Value& dst = write(instr->ops[0]);
+		dst = read(instr->ops[1]);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Create) {
+		auto size = integer(read(instr->ops[1]));
+		if (size < 0)
+			throw RuntimeError("negative chunk size");
+
+		_chunks.push_back(Chunk{std::vector<Value>(size), true});
+		write(instr->ops[0]) = Value(static_cast<std::int64_t>(_chunks.size()-1));
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Copy) {
+		Value src = read(instr->ops[1]);
+		if (!src.isString()) {
+			auto words = chunk(src).words;
+			_chunks.push_back(Chunk{std::move(words), true});
+			src = Value(static_cast<std::int64_t>(_chunks.size()-1));
+		}
+		write(instr->ops[0]) = std::move(src);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(GetSize) {
+		auto& src = read(instr->ops[1]);
+		std::int64_t size = src.isString() ? src.asString().size() : chunk(src).words.size();
+		write(instr->ops[0]) = Value(size);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(GetWord) {
+		auto& src = read(instr->ops[1]);
+		auto index = integer(read(instr->ops[2]));
+		Value result;
+		if (src.isString()) {
+			auto& s = src.asString();
+			if (index < 0 || static_cast<std::size_t>(index) >= s.size())
+				throw RuntimeError("string index out of range");
+			result = Value(std::string(1, s[index]));
+		}
+		else {
+			auto& words = chunk(src).words;
+			if (index < 0 || static_cast<std::size_t>(index) >= words.size())
+				throw RuntimeError("chunk index out of range");
+			result = words[index];
+		}
+		write(instr->ops[0]) = std::move(result);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(SetWord) {
+		auto index = integer(read(instr->ops[1]));
+		if (read(instr->ops[0]).isString()) {
+			auto& c = text(read(instr->ops[2]), scratch1);
+			if (c.empty())
+				throw RuntimeError("expected character");
+
+			auto ch = c[0];
+			auto& s = write(instr->ops[0]).mutableString();
+			if (index < 0 || static_cast<std::size_t>(index) >= s.size())
+				throw RuntimeError("string index out of range");
+			s[index] = ch;
+		}
+		else {
+			Value value = read(instr->ops[2]);
+			auto& words = chunk(read(instr->ops[0])).words;
+			if (index < 0 || static_cast<std::size_t>(index) >= words.size())
+				throw RuntimeError("chunk index out of range");
+			words[index] = std::move(value);
+		}
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Resize) {
+		auto size = integer(read(instr->ops[1]));
+		if (size < 0)
+			throw RuntimeError("negative size");
+
+		if (read(instr->ops[0]).isString())
+			write(instr->ops[0]).mutableString().resize(size, '\0');
+		else
+			chunk(read(instr->ops[0])).words.resize(size);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Destroy) {
+		auto& c = chunk(read(instr->ops[0]));
+		c.words.clear();
+		c.words.shrink_to_fit();
+		c.alive = false;
+		VYPCODE_DISPATCH();
+	}
+
+	VYPCODE_INTEGER_ARITHMETIC(AddI, +)
+	VYPCODE_INTEGER_ARITHMETIC(SubI, -)
+	VYPCODE_INTEGER_ARITHMETIC(MulI, *)
+	VYPCODE_CASE(DivI) {
+		auto lhs = integer(read(instr->ops[1]));
+		auto rhs = integer(read(instr->ops[2]));
+		if (rhs == 0)
+			throw RuntimeError("division by zero");
+		// The only overflowing quotient wraps around to the dividend.
+		if (rhs == -1)
+			write(instr->ops[0]) = Value(static_cast<std::int64_t>(0 - static_cast<std::uint64_t>(lhs)));
+		else
+			write(instr->ops[0]) = Value(lhs / rhs);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_ARITHMETIC(AddF, double, real, +)
+	VYPCODE_ARITHMETIC(SubF, double, real, -)
+	VYPCODE_ARITHMETIC(MulF, double, real, *)
+	VYPCODE_CASE(DivF) {
+		auto lhs = real(read(instr->ops[1]));
+		auto rhs = real(read(instr->ops[2]));
+		if (rhs == 0.0)
+			throw RuntimeError("division by zero");
+		write(instr->ops[0]) = Value(lhs / rhs);
+		VYPCODE_DISPATCH();
+	}
+
+	VYPCODE_COMPARISON(LtI, integer, <)
+	VYPCODE_COMPARISON(LtF, real, <)
+	VYPCODE_STRING_COMPARISON(LtS, <)
+	VYPCODE_COMPARISON(EqI, integer, ==)
+	VYPCODE_COMPARISON(EqF, real, ==)
+	VYPCODE_STRING_COMPARISON(EqS, ==)
+	VYPCODE_COMPARISON(GtI, integer, >)
+	VYPCODE_COMPARISON(GtF, real, >)
+	VYPCODE_STRING_COMPARISON(GtS, >)
+
+	VYPCODE_CASE(And) {
+		std::int64_t result = read(instr->ops[1]).truthy() && read(instr->ops[2]).truthy();
+		write(instr->ops[0]) = Value(result);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Or) {
+		std::int64_t result = read(instr->ops[1]).truthy() || read(instr->ops[2]).truthy();
+		write(instr->ops[0]) = Value(result);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Not) {
+		std::int64_t result = !read(instr->ops[1]).truthy();
+		write(instr->ops[0]) = Value(result);
+		VYPCODE_DISPATCH();
+	}
+
+	VYPCODE_CASE(Int2Float) {
+		double result = integer(read(instr->ops[1]));
+		write(instr->ops[0]) = Value(result);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Float2Int) {
+		auto result = static_cast<std::int64_t>(real(read(instr->ops[1])));
+		write(instr->ops[0]) = Value(result);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Int2String) {
+		auto result = std::to_string(integer(read(instr->ops[1])));
+		write(instr->ops[0]) = Value(std::move(result));
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Float2String) {
+		auto result = floatString(real(read(instr->ops[1])));
+		write(instr->ops[0]) = Value(std::move(result));
+		VYPCODE_DISPATCH();
+	}
+
+	VYPCODE_CASE(Jump) {
+		pc = instr->ops[0].value;
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(JumpZ) {
+		if (!read(instr->ops[1]).truthy())
+			pc = instr->ops[0].value;
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(JumpNZ) {
+		if (read(instr->ops[1]).truthy())
+			pc = instr->ops[0].value;
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Call) {
+		// Target may be stored in the same place as return address.
+		auto target = callTarget(instr->ops[1]);
+		write(instr->ops[0]) = Value(static_cast<std::int64_t>(pc));
+		VYPCODE_JUMP(target);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(Return) {
+		VYPCODE_JUMP(integer(read(instr->ops[0])));
+		VYPCODE_DISPATCH();
+	}
+
+	VYPCODE_CASE(ReadI) {
+		auto line = readLine();
+		std::int64_t result = std::strtoll(line.c_str(), nullptr, 10);
+		write(instr->ops[0]) = Value(result);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(ReadF) {
+		auto line = readLine();
+		double result = std::strtod(line.c_str(), nullptr);
+		write(instr->ops[0]) = Value(result);
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(ReadS) {
+		write(instr->ops[0]) = Value(readLine());
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(WriteI) {
+		_out << integer(read(instr->ops[0]));
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(WriteF) {
+		_out << floatString(real(read(instr->ops[0])));
+		VYPCODE_DISPATCH();
+	}
+	VYPCODE_CASE(WriteS) {
+		_out << text(read(instr->ops[0]), scratch1);
+		VYPCODE_DISPATCH();
+	}
+
+	VYPCODE_CASE(Halt) {
+		// Halt itself is not part of the program.
+		_executed--;
+		_out.flush();
+		return;
+	}
+
+#ifndef VYPCODE_THREADED_DISPATCH
+		}
+#endif
+	}
+
+#undef VYPCODE_STRING_COMPARISON
+#undef VYPCODE_COMPARISON
+#undef VYPCODE_ARITHMETIC
+#undef VYPCODE_JUMP
+#undef VYPCODE_DISPATCH
+#undef VYPCODE_CASE
+}
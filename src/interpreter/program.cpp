@@ -0,0 +1,411 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+
+#include "vypcomp/interpreter/program.h"
+
+using namespace vypcomp::vypcode;
+
+LoadError::LoadError(const std::string& msg):
+	msg(msg)
+{
+}
+
+const char * LoadError::what() const throw()
+{
+	return msg.c_str();
+}
+
+namespace {
+
+/**
+ * Describes operands of instruction:
+ *  - w: register or memory written by instruction,
+ *  - r: any value (register, memory or constant),
+ *  - l: label,
+ *  - t: label or value holding name of the label.
+ */
+struct Mnemonic {
+	Opcode op;
+	const char* operands;
+};
+
+const std::unordered_map<std::string, Mnemonic>& mnemonics()
+{
+	static const std::unordered_map<std::string, Mnemonic> table = {
+		{"SET", {Opcode::Set, "wr"}},
+		{"CREATE", {Opcode::Create, "wr"}},
+		{"COPY", {Opcode::Copy, "wr"}},
+		{"GETSIZE", {Opcode::GetSize, "wr"}},
+		{"GETWORD", {Opcode::GetWord, "wrr"}},
+		{"SETWORD", {Opcode::SetWord, "rrr"}},
+		{"RESIZE", {Opcode::Resize, "rr"}},
+		{"DESTROY", {Opcode::Destroy, "r"}},
+		{"ADDI", {Opcode::AddI, "wrr"}},
+		{"SUBI", {Opcode::SubI, "wrr"}},
+		{"MULI", {Opcode::MulI, "wrr"}},
+		{"DIVI", {Opcode::DivI, "wrr"}},
+		{"ADDF", {Opcode::AddF, "wrr"}},
+		{"SUBF", {Opcode::SubF, "wrr"}},
+		{"MULF", {Opcode::MulF, "wrr"}},
+		{"DIVF", {Opcode::DivF, "wrr"}},
+		{"LTI", {Opcode::LtI, "wrr"}},
+		{"LTF", {Opcode::LtF, "wrr"}},
+		{"LTS", {Opcode::LtS, "wrr"}},
+		{"EQI", {Opcode::EqI, "wrr"}},
+		{"EQF", {Opcode::EqF, "wrr"}},
+		{"EQS", {Opcode::EqS, "wrr"}},
+		{"GTI", {Opcode::GtI, "wrr"}},
+		{"GTF", {Opcode::GtF, "wrr"}},
+		{"GTS", {Opcode::GtS, "wrr"}},
+		{"AND", {Opcode::And, "wrr"}},
+		{"OR", {Opcode::Or, "wrr"}},
+		{"NOT", {Opcode::Not, "wr"}},
+		{"INT2FLOAT", {Opcode::Int2Float, "wr"}},
+		{"FLOAT2INT", {Opcode::Float2Int, "wr"}},
+		{"INT2STRING", {Opcode::Int2String, "wr"}},
+		{"FLOAT2STRING", {Opcode::Float2String, "wr"}},
+		{"JUMP", {Opcode::Jump, "l"}},
+		{"JUMPZ", {Opcode::JumpZ, "lr"}},
+		{"JUMPNZ", {Opcode::JumpNZ, "lr"}},
+		{"CALL", {Opcode::Call, "wt"}},
+		{"RETURN", {Opcode::Return, "r"}},
+		{"READI", {Opcode::ReadI, "w"}},
+		{"READF", {Opcode::ReadF, "w"}},
+		{"READS", {Opcode::ReadS, "w"}},
+		{"WRITEI", {Opcode::WriteI, "r"}},
+		{"WRITEF", {Opcode::WriteF, "r"}},
+		{"WRITES", {Opcode::WriteS, "r"}},
+	};
+
+	return table;
+}
+
+std::string error(std::size_t lineno, const std::string& msg)
+{
+	return "line " + std::to_string(lineno) + ": " + msg;
+}
+
+/**
+ * Splits operands of instruction. Operands are separated by commas
+ * or white spaces, '#' outside of string literal starts comment.
+ */
+std::vector<std::string> splitOperands(const std::string& line, std::size_t pos, std::size_t lineno)
+{
+	std::vector<std::string> result;
+	while (pos < line.size()) {
+		char c = line[pos];
+		if (std::isspace(static_cast<unsigned char>(c)) || c == ',') {
+			pos++;
+			continue;
+		}
+		if (c == '#')
+			break;
+
+		auto start = pos;
+		if (c == '"') {
+			for (pos++; pos < line.size() && line[pos] != '"'; pos++) {
+				if (line[pos] == '\\')
+					pos++;
+			}
+			if (pos >= line.size())
+				throw LoadError(error(lineno, "unterminated string literal"));
+			pos++;
+		}
+		else if (c == '[') {
+			pos = line.find(']', pos);
+			if (pos == std::string::npos)
+				throw LoadError(error(lineno, "expected ']'"));
+			pos++;
+		}
+		else {
+			while (pos < line.size() && line[pos] != ',' && line[pos] != '#'
+					&& !std::isspace(static_cast<unsigned char>(line[pos])))
+				pos++;
+		}
+		result.push_back(line.substr(start, pos-start));
+	}
+
+	return result;
+}
+
+void appendUtf8(std::string& out, unsigned long cp)
+{
+	if (cp < 0x80) {
+		out += static_cast<char>(cp);
+	}
+	else if (cp < 0x800) {
+		out += static_cast<char>(0xc0 | (cp >> 6));
+		out += static_cast<char>(0x80 | (cp & 0x3f));
+	}
+	else if (cp < 0x10000) {
+		out += static_cast<char>(0xe0 | (cp >> 12));
+		out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+		out += static_cast<char>(0x80 | (cp & 0x3f));
+	}
+	else {
+		out += static_cast<char>(0xf0 | ((cp >> 18) & 0x07));
+		out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+		out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+		out += static_cast<char>(0x80 | (cp & 0x3f));
+	}
+}
+
+/**
+ * Decodes escape sequences of string literal (without quotes).
+ */
+std::string unescape(const std::string& text, std::size_t lineno)
+{
+	std::string result;
+	result.reserve(text.size());
+	for (std::size_t i = 0; i < text.size(); i++) {
+		if (text[i] != '\\') {
+			result += text[i];
+			continue;
+		}
+		if (++i == text.size())
+			throw LoadError(error(lineno, "invalid escape sequence"));
+
+		switch (text[i]) {
+		case 'n':
+			result += '\n';
+			break;
+		case 't':
+			result += '\t';
+			break;
+		case '"':
+		case '\\':
+			result += text[i];
+			break;
+		case 'x': {
+			auto start = i+1;
+			auto end = start;
+			while (end < text.size() && end-start < 6 && std::isxdigit(static_cast<unsigned char>(text[end])))
+				end++;
+			if (end == start)
+				throw LoadError(error(lineno, "invalid escape sequence"));
+
+			appendUtf8(result, std::stoul(text.substr(start, end-start), nullptr, 16));
+			i = end-1;
+			break;
+		}
+		default:
+			throw LoadError(error(lineno, "invalid escape sequence \\"+std::string(1, text[i])));
+		}
+	}
+
+	return result;
+}
+
+bool isLabel(const std::string& text)
+{
+	if (text.empty() || !(std::isalpha(static_cast<unsigned char>(text[0])) || text[0] == '_'))
+		return false;
+
+	for (char c: text) {
+		if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+			return false;
+	}
+
+	return true;
+}
+
+bool isWritable(const Operand& op)
+{
+	return op.kind == Operand::Kind::Register
+		|| op.kind == Operand::Kind::Memory
+		|| op.kind == Operand::Kind::Absolute;
+}
+
+}
+
+Program Program::load(std::istream& in)
+{
+	Program program;
+	std::string line;
+	for (std::size_t lineno = 1; std::getline(in, line); lineno++)
+		program.parseLine(line, lineno);
+
+	program.resolveLabels();
+
+	Instruction halt{Opcode::Halt, {}};
+	program._code.push_back(halt);
+	return program;
+}
+
+Program Program::load(const std::string& path)
+{
+	std::ifstream in(path);
+	if (!in)
+		throw LoadError("unable to open "+path);
+
+	return load(in);
+}
+
+const std::vector<Instruction>& Program::code() const
+{
+	return _code;
+}
+
+const std::vector<Value>& Program::constants() const
+{
+	return _constants;
+}
+
+std::size_t Program::registers() const
+{
+	return _registers;
+}
+
+const std::int64_t* Program::address(const std::string& label) const
+{
+	auto it = _labels.find(label);
+	return it == _labels.end() ? nullptr : &it->second;
+}
+
+void Program::parseLine(const std::string& line, std::size_t lineno)
+{
+	std::size_t pos = 0;
+	while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos])))
+		pos++;
+	if (pos == line.size() || line[pos] == '#')
+		return;
+
+	auto end = pos;
+	while (end < line.size() && !std::isspace(static_cast<unsigned char>(line[end])) && line[end] != '#')
+		end++;
+
+	std::string name = line.substr(pos, end-pos);
+	auto operands = splitOperands(line, end, lineno);
+
+	if (name == "LABEL") {
+		if (operands.size() != 1 || !isLabel(operands[0]))
+			throw LoadError(error(lineno, "invalid label"));
+		if (!_labels.emplace(operands[0], _code.size()).second)
+			throw LoadError(error(lineno, "redefinition of label "+operands[0]));
+		return;
+	}
+
+	auto mnemonic = mnemonics().find(name);
+	if (mnemonic == mnemonics().end())
+		throw LoadError(error(lineno, "unknown instruction "+name));
+
+	const std::string signature = mnemonic->second.operands;
+	if (operands.size() != signature.size())
+		throw LoadError(error(lineno, name+" expects "+std::to_string(signature.size())+" operands"));
+
+	Instruction instr{mnemonic->second.op, {}};
+	for (std::size_t i = 0; i < signature.size(); i++) {
+		bool label = signature[i] == 'l' || (signature[i] == 't' && isLabel(operands[i]));
+		if (label) {
+			if (!isLabel(operands[i]))
+				throw LoadError(error(lineno, "expected label, got "+operands[i]));
+
+			instr.ops[i].kind = Operand::Kind::Label;
+			_fixups.push_back({_code.size(), i, operands[i], lineno});
+			continue;
+		}
+
+		instr.ops[i] = parseOperand(operands[i], lineno);
+		if (signature[i] == 'w' && !isWritable(instr.ops[i]))
+			throw LoadError(error(lineno, "operand "+operands[i]+" of "+name+" is not writable"));
+	}
+
+	_code.push_back(instr);
+}
+
+std::uint32_t Program::parseRegister(const std::string& text, std::size_t lineno)
+{
+	if (text == "$SP")
+		return Operand::SP;
+
+	if (text.size() < 2 || text[0] != '$')
+		throw LoadError(error(lineno, "invalid register "+text));
+	for (std::size_t i = 1; i < text.size(); i++) {
+		if (!std::isdigit(static_cast<unsigned char>(text[i])))
+			throw LoadError(error(lineno, "invalid register "+text));
+	}
+
+	auto reg = std::stoul(text.substr(1)) + 1;
+	if (reg >= _registers)
+		_registers = reg + 1;
+
+	return reg;
+}
+
+Operand Program::parseOperand(const std::string& text, std::size_t lineno)
+{
+	Operand result;
+	if (text[0] == '$') {
+		result.kind = Operand::Kind::Register;
+		result.reg = parseRegister(text, lineno);
+		return result;
+	}
+
+	if (text[0] == '[') {
+		auto inner = text.substr(1, text.size()-2);
+		if (inner.empty())
+			throw LoadError(error(lineno, "invalid memory operand "+text));
+
+		if (inner[0] != '$') {
+			result.kind = Operand::Kind::Absolute;
+			char* end = nullptr;
+			result.value = std::strtoll(inner.c_str(), &end, 10);
+			if (*end != '\0' || result.value < 0)
+				throw LoadError(error(lineno, "invalid memory operand "+text));
+			return result;
+		}
+
+		auto sign = inner.find_first_of("+-");
+		result.kind = Operand::Kind::Memory;
+		result.reg = parseRegister(inner.substr(0, sign), lineno);
+		if (sign != std::string::npos) {
+			char* end = nullptr;
+			result.value = std::strtoll(inner.c_str()+sign+1, &end, 10);
+			if (*end != '\0' || end == inner.c_str()+sign+1)
+				throw LoadError(error(lineno, "invalid memory operand "+text));
+			if (inner[sign] == '-')
+				result.value = -result.value;
+		}
+		return result;
+	}
+
+	result.kind = Operand::Kind::Constant;
+	result.value = _constants.size();
+	if (text[0] == '"') {
+		_constants.emplace_back(unescape(text.substr(1, text.size()-2), lineno));
+		return result;
+	}
+
+	char* end = nullptr;
+	auto integer = std::strtoll(text.c_str(), &end, 10);
+	if (*end == '\0' && end != text.c_str()) {
+		_constants.emplace_back(static_cast<std::int64_t>(integer));
+		return result;
+	}
+
+	auto real = std::strtod(text.c_str(), &end);
+	if (*end == '\0' && end != text.c_str()) {
+		_constants.emplace_back(real);
+		return result;
+	}
+
+	throw LoadError(error(lineno, "invalid operand "+text));
+}
+
+void Program::resolveLabels()
+{
+	for (auto& fixup: _fixups) {
+		auto label = _labels.find(fixup.label);
+		if (label == _labels.end())
+			throw LoadError(error(fixup.line, "undefined label "+fixup.label));
+
+		_code[fixup.instruction].ops[fixup.operand].value = label->second;
+	}
+	_fixups.clear();
+}
@@ -0,0 +1,91 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <algorithm>
+#include <cstdint>
+
+#include "vypcomp/ir/arena.h"
+
+using namespace vypcomp::ir;
+
+namespace {
+
+thread_local Arena* currentArena = nullptr;
+
+}
+
+// ------------------------------
+// Arena
+// ------------------------------
+
+Arena::Arena(std::size_t chunkSize):
+	_chunkSize(chunkSize)
+{
+}
+
+Arena::~Arena()
+{
+	// Objects are destroyed in reverse order of creation.
+	for (auto node = _last; node != nullptr; node = node->prev) {
+		node->destroy(node);
+	}
+}
+
+void* Arena::allocate(std::size_t size, std::size_t align)
+{
+	auto aligned = [align](char* ptr) {
+		auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+		return reinterpret_cast<char*>((addr + align - 1) / align * align);
+	};
+
+	char* mem = _cursor ? aligned(_cursor) : nullptr;
+	if (mem == nullptr || mem + size > _end) {
+		// Objects larger than chunk get their own chunk.
+		std::size_t chunkSize = std::max(_chunkSize, size + align);
+		_chunks.push_back(std::unique_ptr<char[]>(new char[chunkSize]));
+		_cursor = _chunks.back().get();
+		_end = _cursor + chunkSize;
+		mem = aligned(_cursor);
+	}
+
+	_cursor = mem + size;
+	_bytes += size;
+	return mem;
+}
+
+std::size_t Arena::objects() const
+{
+	return _objects;
+}
+
+std::size_t Arena::bytes() const
+{
+	return _bytes;
+}
+
+std::size_t Arena::chunks() const
+{
+	return _chunks.size();
+}
+
+Arena* Arena::current()
+{
+	return currentArena;
+}
+
+// ------------------------------
+// Arena::Scope
+// ------------------------------
+
+Arena::Scope::Scope(Arena* arena):
+	_previous(currentArena)
+{
+	currentArena = arena;
+}
+
+Arena::Scope::~Scope()
+{
+	currentArena = _previous;
+}
@@ -467,3 +467,27 @@ AllocaInstruction::Ptr ObjectAttributeExpression::getAttribute() const
 {
 	return _attribute;
 }
+
+//
+// Concat Expression
+//
+ConcatExpression::ConcatExpression(Operands operands)
+	: Expression(Datatype(PrimitiveDatatype::String)), _operands(std::move(operands))
+{
+	for (auto& operand : _operands)
+	{
+		if (operand->type() != Datatype(PrimitiveDatatype::String))
+			throw IncompabilityError("Only strings can be concatenated: " + operand->to_string());
+	}
+}
+std::string ConcatExpression::to_string() const
+{
+	std::string result = "(";
+	for (std::size_t i = 0; i < _operands.size(); i++)
+		result += (i == 0 ? "" : " + ") + _operands[i]->to_string();
+	return result + ")";
+}
+const ConcatExpression::Operands& ConcatExpression::getOperands() const
+{
+	return _operands;
+}
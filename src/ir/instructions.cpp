@@ -6,8 +6,10 @@
 #include <sstream>
 #include <variant>
 #include <algorithm>
+#include <atomic>
 #include <stdexcept>
 
+#include "vypcomp/ir/arena.h"
 #include "vypcomp/ir/instructions.h"
 
 using namespace vypcomp;
@@ -19,20 +21,19 @@ using namespace vypcomp::ir;
 
 BasicBlock::BasicBlock(const std::string& name, const std::string& suf)
 {
-	static uint64_t ID = 0;
+	// blocks may be created by parsers running in parallel
+	static std::atomic<uint64_t> ID = 0;
 
 	std::string suffix(suf);
-	if (suffix.empty()) {
-		suffix = "_"+std::to_string(ID);
-		ID++;
-	}
+	if (suffix.empty())
+		suffix = "_"+std::to_string(ID++);
 
 	_name = name+suffix;
 }
 
 BasicBlock::Ptr BasicBlock::create()
 {
-	return BasicBlock::Ptr(new BasicBlock("label", ""));
+	return make<BasicBlock>("label", "");
 }
 
 void BasicBlock::setNext(BasicBlock::Ptr instr)
@@ -69,6 +70,25 @@ Instruction::Ptr BasicBlock::last() const
 	return prev;
 }
 
+std::vector<Instruction::Ptr> BasicBlock::instructions() const
+{
+	std::vector<Instruction::Ptr> result;
+	for (auto it = _first; it != nullptr; it = it->next()) {
+		result.push_back(it);
+	}
+
+	return result;
+}
+
+void BasicBlock::setInstructions(const std::vector<Instruction::Ptr>& instructions)
+{
+	for (std::size_t i = 0; i < instructions.size(); i++) {
+		instructions[i]->setNext(i+1 < instructions.size() ? instructions[i+1] : nullptr);
+	}
+
+	_first = instructions.empty() ? nullptr : instructions.front();
+}
+
 std::string BasicBlock::str(const std::string& prefix) const
 {
 	std::ostringstream out;
@@ -112,7 +132,7 @@ void Function::setSignature(const Function::Signature& sig)
 	_args.clear();
 	for (auto decl: args) {
 		_args.push_back(
-			AllocaInstruction::Ptr(new AllocaInstruction(decl))
+			make<AllocaInstruction>(decl)
 		);
 	}
 }
@@ -147,7 +167,7 @@ bool Function::isVoid() const
 	return !_type.has_value();
 }
 
-std::string Function::name() const
+const Name& Function::name() const
 {
 	return _name;
 }
@@ -181,6 +201,19 @@ std::vector<Datatype> Function::argTypes() const
 	return types;
 }
 
+bool Function::hasArgTypes(const std::vector<Datatype>& types) const
+{
+	if (_args.size() != types.size())
+		return false;
+
+	for (std::size_t i = 0; i < types.size(); i++) {
+		if (_args[i]->type() != types[i])
+			return false;
+	}
+
+	return true;
+}
+
 std::string Function::str(const std::string& prefix) const
 {
 	std::ostringstream out;
@@ -247,6 +280,11 @@ Expression::ValueType BranchInstruction::getExpr() const
 	return _expr;
 }
 
+void BranchInstruction::setExpr(Expression::ValueType expr)
+{
+	_expr = expr;
+}
+
 // ------------------------------
 // Return
 // ------------------------------
@@ -274,6 +312,11 @@ Expression::ValueType Return::getExpr() const
 	return _expr;
 }
 
+void Return::setExpr(Expression::ValueType expr)
+{
+	_expr = expr;
+}
+
 // ------------------------------
 // LoopInstruction
 // ------------------------------
@@ -304,6 +347,11 @@ Expression::ValueType LoopInstruction::getExpr() const
 	return _expr;
 }
 
+void LoopInstruction::setExpr(Expression::ValueType expr)
+{
+	_expr = expr;
+}
+
 // ------------------------------
 // AllocaInstruction
 // ------------------------------
@@ -328,7 +376,7 @@ void AllocaInstruction::setType(const Datatype &t)
 	_type = t;
 }
 
-std::string AllocaInstruction::name() const
+const Name& AllocaInstruction::name() const
 {
 	return _varName;
 }
@@ -375,6 +423,11 @@ Expression::ValueType Assignment::getExpr() const
 	return _expr;
 }
 
+void Assignment::setExpr(Expression::ValueType expr)
+{
+	_expr = expr;
+}
+
 // ------------------------------
 // ObjectAssignment
 // ------------------------------
@@ -403,12 +456,17 @@ Expression::ValueType ObjectAssignment::getExpr() const
 	return _expr;
 }
 
+void ObjectAssignment::setExpr(Expression::ValueType expr)
+{
+	_expr = expr;
+}
+
 
 // ------------------------------
 // Class
 // ------------------------------
 
-Class::Class(const std::string& name, Class::Ptr parent):
+Class::Class(const Name& name, Class::Ptr parent):
 	_name(name),
 	_parent(parent)
 {
@@ -422,6 +480,7 @@ Function::Ptr Class::constructor() const
 void Class::setBase(Class::Ptr base)
 {
 	_parent = base;
+	_version++;
 }
 
 Class::Ptr Class::getBase() const
@@ -440,6 +499,7 @@ void Class::add(Function::Ptr method, const Visibility& v)
 		return;
 	}
 	method->addPrefix(_name);
+	_version++;
 	
 	if (method->name() == name()) {
 		_constructor = method;
@@ -458,6 +518,18 @@ void Class::add(Function::Ptr method, const Visibility& v)
 	}
 }
 
+void Class::remove(const Function::Ptr& method)
+{
+	for (auto methods: {&_publicMethods, &_protectedMethods, &_privateMethods}) {
+		auto it = std::find(methods->begin(), methods->end(), method);
+		if (it != methods->end()) {
+			methods->erase(it);
+			_version++;
+			return;
+		}
+	}
+}
+
 void Class::add(AllocaInstruction::Ptr attr, const Visibility& v)
 {
 	if (auto mymethod = getAttribute(attr->name(), v)) {
@@ -487,27 +559,91 @@ std::vector<Instruction::Ptr> Class::implicit() const
 	return _implicit;
 }
 
-Function::Ptr Class::getMethod(const std::string& name, const std::vector<Datatype>& argtypes, const Visibility& v) const
+namespace {
+
+bool isAccessible(Class::Visibility access, Class::Visibility v)
+{
+	switch (v) {
+	case Class::Visibility::Private:
+		return true;
+	case Class::Visibility::Protected:
+		return access != Class::Visibility::Private;
+	default:
+		return access == Class::Visibility::Public;
+	}
+}
+
+}
+
+void Class::resolveMethods()
+{
+	auto table = std::make_unique<MethodTable>();
+
+	// Order of candidates follows search of getMethod: private,
+	// protected and public methods of this class, then protected
+	// and public methods of bases.
+	auto insert = [&table](const std::vector<Function::Ptr>& methods, Visibility access) {
+		for (const auto& method: methods)
+			table->methods[method->name()].push_back({method, access});
+	};
+
+	insert(_privateMethods, Visibility::Private);
+	for (const Class* c = this; c != nullptr; c = c->_parent.get()) {
+		insert(c->_protectedMethods, Visibility::Protected);
+		insert(c->_publicMethods, Visibility::Public);
+		table->versions.push_back({c, c->_version});
+	}
+
+	_methodTable = std::move(table);
+}
+
+const Class::MethodTable* Class::methodTable() const
 {
+	if (_methodTable == nullptr)
+		return nullptr;
+
+	const Class* c = this;
+	for (const auto& [cl, version]: _methodTable->versions) {
+		if (c != cl || c->_version != version)
+			return nullptr;
+		c = c->_parent.get();
+	}
+
+	return c == nullptr ? _methodTable.get() : nullptr;
+}
+
+Function::Ptr Class::getMethod(const Name& name, const std::vector<Datatype>& argtypes, const Visibility& v) const
+{
+	if (auto table = methodTable()) {
+		if (auto candidates = table->methods.find(name)) {
+			for (const auto& candidate: *candidates) {
+				if (isAccessible(candidate.access, v) && candidate.method->hasArgTypes(argtypes))
+					return candidate.method;
+			}
+		}
+
+		return nullptr;
+	}
+
 	switch (v) {
 		case Visibility::Private: {
-			auto it = std::find_if(_privateMethods.begin(), _privateMethods.end(), [name, argtypes](const auto& method) {
-				return method->name() == name && method->argTypes() == argtypes;
+			auto it = std::find_if(_privateMethods.begin(), _privateMethods.end(), [&name, &argtypes](const auto& method) {
+				return method->name() == name && method->hasArgTypes(argtypes);
 				});
 			if (it != _privateMethods.end())
 				return *it;
 		}
 		case Visibility::Protected: {
-			auto pit = std::find_if(_protectedMethods.begin(), _protectedMethods.end(), [name, argtypes](const auto& method) {
-				return method->name() == name && method->argTypes() == argtypes;
+			auto pit = std::find_if(_protectedMethods.begin(), _protectedMethods.end(), [&name, &argtypes](const auto& method) {
+				return method->name() == name && method->hasArgTypes(argtypes);
 			});
 			if (pit != _protectedMethods.end())
 				return *pit;
 		}
 		case Visibility::Public:
 		default: {
-			auto it = std::find_if(_publicMethods.begin(), _publicMethods.end(), [name, argtypes](const auto& method) {
-				return method->name() == name && method->argTypes() == argtypes;
+			auto it = std::find_if(_publicMethods.begin(), _publicMethods.end(), [&name, &argtypes](const auto& method) {
+				return method->name() == name && method->hasArgTypes(argtypes);
 			});
 			if (it != _publicMethods.end())
 				return *it;
@@ -520,18 +656,29 @@ Function::Ptr Class::getMethod(const std::string& name, const std::vector<Dataty
 	return nullptr;
 }
 
-Function::Ptr Class::getMethod(const std::string& name, const Visibility& v) const
+Function::Ptr Class::getMethod(const Name& name, const Visibility& v) const
 {
+	if (auto table = methodTable()) {
+		if (auto candidates = table->methods.find(name)) {
+			for (const auto& candidate: *candidates) {
+				if (isAccessible(candidate.access, v))
+					return candidate.method;
+			}
+		}
+
+		return nullptr;
+	}
+
 	switch (v) {
 		case Visibility::Private: {
-			auto it = std::find_if(_privateMethods.begin(), _privateMethods.end(), [name](const auto& method) {
+			auto it = std::find_if(_privateMethods.begin(), _privateMethods.end(), [&name](const auto& method) {
 				return method->name() == name;
 				});
 			if (it != _privateMethods.end())
 				return *it;
 		}
 		case Visibility::Protected: {
-			auto pit = std::find_if(_protectedMethods.begin(), _protectedMethods.end(), [name](const auto& method) {
+			auto pit = std::find_if(_protectedMethods.begin(), _protectedMethods.end(), [&name](const auto& method) {
 				return method->name() == name;
 			});
 			if (pit != _protectedMethods.end())
@@ -539,7 +686,7 @@ Function::Ptr Class::getMethod(const std::string& name, const Visibility& v) con
 		}
 		case Visibility::Public:
 		default: {
-			auto it = std::find_if(_publicMethods.begin(), _publicMethods.end(), [name](const auto& method) {
+			auto it = std::find_if(_publicMethods.begin(), _publicMethods.end(), [&name](const auto& method) {
 				return method->name() == name;
 			});
 			if (it != _publicMethods.end())
@@ -553,7 +700,7 @@ Function::Ptr Class::getMethod(const std::string& name, const Visibility& v) con
 	return nullptr;
 }
 
-Function::Ptr Class::getOriginalMethod(const std::string& name, const Visibility& v) const
+Function::Ptr Class::getOriginalMethod(const Name& name, const Visibility& v) const
 {
 	Function::Ptr result;
 	if (_parent)
@@ -565,14 +712,14 @@ Function::Ptr Class::getOriginalMethod(const std::string& name, const Visibility
 	
 	switch (v) {
 	case Visibility::Private: {
-		auto it = std::find_if(_privateMethods.begin(), _privateMethods.end(), [name](const auto& method) {
+		auto it = std::find_if(_privateMethods.begin(), _privateMethods.end(), [&name](const auto& method) {
 			return method->name() == name;
 			});
 		if (it != _privateMethods.end())
 			return *it;
 	}
 	case Visibility::Protected: {
-		auto pit = std::find_if(_protectedMethods.begin(), _protectedMethods.end(), [name](const auto& method) {
+		auto pit = std::find_if(_protectedMethods.begin(), _protectedMethods.end(), [&name](const auto& method) {
 			return method->name() == name;
 			});
 		if (pit != _protectedMethods.end())
@@ -580,7 +727,7 @@ Function::Ptr Class::getOriginalMethod(const std::string& name, const Visibility
 	}
 	case Visibility::Public:
 	default: {
-		auto it = std::find_if(_publicMethods.begin(), _publicMethods.end(), [name](const auto& method) {
+		auto it = std::find_if(_publicMethods.begin(), _publicMethods.end(), [&name](const auto& method) {
 			return method->name() == name;
 			});
 		if (it != _publicMethods.end())
@@ -592,10 +739,10 @@ Function::Ptr Class::getOriginalMethod(const std::string& name, const Visibility
 	return nullptr;
 }
 
-AllocaInstruction::Ptr Class::getAttribute(const std::string& name, const Visibility& v) const
+AllocaInstruction::Ptr Class::getAttribute(const Name& name, const Visibility& v) const
 {
 	if (v == Visibility::Private) {
-		auto it = std::find_if(_privateAttrs.begin(), _privateAttrs.end(), [name](const auto& attr) {
+		auto it = std::find_if(_privateAttrs.begin(), _privateAttrs.end(), [&name](const auto& attr) {
 			return attr->name() == name;
 		});
 		if (it != _privateAttrs.end())
@@ -603,7 +750,7 @@ AllocaInstruction::Ptr Class::getAttribute(const std::string& name, const Visibi
 	}
 
 	if ((v == Visibility::Private) || (v == Visibility::Protected)) {
-		auto pit = std::find_if(_protectedAttrs.begin(), _protectedAttrs.end(), [name](const auto& attr) {
+		auto pit = std::find_if(_protectedAttrs.begin(), _protectedAttrs.end(), [&name](const auto& attr) {
 			return attr->name() == name;
 		});
 		if (pit != _protectedAttrs.end()) {
@@ -611,7 +758,7 @@ AllocaInstruction::Ptr Class::getAttribute(const std::string& name, const Visibi
 		}
 	}
 
-	auto it = std::find_if(_publicAttrs.begin(), _publicAttrs.end(), [name](const auto& attr) {
+	auto it = std::find_if(_publicAttrs.begin(), _publicAttrs.end(), [&name](const auto& attr) {
 		return attr->name() == name;
 	});
 	if (it != _publicAttrs.end())
@@ -628,7 +775,7 @@ std::size_t vypcomp::ir::Class::getAttributeCount() const
 	return _privateAttrs.size() + _protectedAttrs.size() + _publicAttrs.size();
 }
 
-std::string Class::name() const
+const Name& Class::name() const
 {
 	return _name;
 }
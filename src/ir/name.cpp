@@ -0,0 +1,85 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "vypcomp/ir/name.h"
+
+using namespace vypcomp::ir;
+
+namespace {
+
+/**
+ * Storage of all interned names. Keys view the owned strings, so
+ * lookup does not allocate. Strings are never released.
+ */
+class Interner {
+public:
+	const std::string* intern(std::string_view name)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _names.find(name);
+		if (it != _names.end())
+			return it->second.get();
+
+		auto str = std::make_unique<std::string>(name);
+		auto result = str.get();
+		_names.emplace(*result, std::move(str));
+		return result;
+	}
+
+	std::size_t size()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _names.size();
+	}
+
+private:
+	std::mutex _mutex;
+	std::unordered_map<std::string_view, std::unique_ptr<std::string>> _names;
+};
+
+Interner& interner()
+{
+	// Intentionally leaked so that names stay valid during
+	// destruction of other static objects.
+	static auto instance = new Interner();
+	return *instance;
+}
+
+const std::string* emptyName()
+{
+	static auto empty = interner().intern({});
+	return empty;
+}
+
+}
+
+Name::Name():
+	_str(emptyName())
+{
+}
+
+Name::Name(std::string_view name):
+	_str(interner().intern(name))
+{
+}
+
+Name::Name(const std::string& name):
+	Name(std::string_view(name))
+{
+}
+
+Name::Name(const char* name):
+	Name(std::string_view(name))
+{
+}
+
+std::size_t Name::interned()
+{
+	return interner().size();
+}
@@ -0,0 +1,365 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "vypcomp/ir/arena.h"
+#include "vypcomp/optimizer/constant_folding.h"
+#include "vypcomp/optimizer/walk.h"
+
+using namespace vypcomp;
+
+namespace {
+
+using Kind = ir::Expression::Kind;
+using ValueType = ir::Expression::ValueType;
+
+std::optional<ir::Literal::Impl> literalValue(const ValueType& expr)
+{
+	// NullObject is literal too but it must stay an object.
+	if (expr->kind() != Kind::Literal)
+		return std::nullopt;
+
+	return static_cast<ir::LiteralExpression*>(expr.get())->getValue().value();
+}
+
+/**
+ * Integers are folded only while values fit into 32 bits, so the
+ * result does not depend on width of integers of the interpreter.
+ */
+std::optional<std::int64_t> intValue(const std::optional<ir::Literal::Impl>& value)
+{
+	if (!value || !std::holds_alternative<unsigned long long>(*value))
+		return std::nullopt;
+
+	auto result = static_cast<std::int64_t>(std::get<unsigned long long>(*value));
+	if (result < std::numeric_limits<std::int32_t>::min() || result > std::numeric_limits<std::int32_t>::max())
+		return std::nullopt;
+
+	return result;
+}
+
+std::optional<double> floatValue(const std::optional<ir::Literal::Impl>& value)
+{
+	if (!value || !std::holds_alternative<double>(*value))
+		return std::nullopt;
+
+	return std::get<double>(*value);
+}
+
+std::optional<std::string> stringValue(const std::optional<ir::Literal::Impl>& value)
+{
+	if (!value || !std::holds_alternative<std::string>(*value))
+		return std::nullopt;
+
+	return std::get<std::string>(*value);
+}
+
+/**
+ * Strings keep escape sequences of the source. They can be compared
+ * at compile time only if they have none and are plain ASCII.
+ */
+bool isPlain(const std::string& str)
+{
+	for (auto c: str) {
+		if (c == '\\' || c < ' ' || c > '~')
+			return false;
+	}
+
+	return true;
+}
+
+ValueType makeInt(std::int64_t value)
+{
+	if (value < std::numeric_limits<std::int32_t>::min() || value > std::numeric_limits<std::int32_t>::max())
+		return nullptr;
+
+	return ir::make<ir::LiteralExpression>(ir::Literal(static_cast<unsigned long long>(value)));
+}
+
+ValueType makeFloat(double value)
+{
+	if (!std::isfinite(value))
+		return nullptr;
+
+	return ir::make<ir::LiteralExpression>(ir::Literal(value));
+}
+
+template<class T>
+std::optional<bool> compare(ir::ComparisonExpression::Operation operation, const T& a, const T& b)
+{
+	switch (operation) {
+	case ir::ComparisonExpression::GREATER:
+		return a > b;
+	case ir::ComparisonExpression::GEQ:
+		return a >= b;
+	case ir::ComparisonExpression::LESS:
+		return a < b;
+	case ir::ComparisonExpression::LEQ:
+		return a <= b;
+	case ir::ComparisonExpression::EQUALS:
+		return a == b;
+	case ir::ComparisonExpression::NOTEQUALS:
+		return a != b;
+	}
+
+	return std::nullopt;
+}
+
+ValueType foldInt(Kind kind, std::int64_t a, std::int64_t b)
+{
+	switch (kind) {
+	case Kind::Add:
+		return makeInt(a + b);
+	case Kind::Subtract:
+		return makeInt(a - b);
+	case Kind::Multiply:
+		return makeInt(a * b);
+	case Kind::Divide:
+		// Division by zero is left to be reported at runtime.
+		return b == 0 ? nullptr : makeInt(a / b);
+	case Kind::And:
+		return makeInt(a != 0 && b != 0);
+	case Kind::Or:
+		return makeInt(a != 0 || b != 0);
+	default:
+		return nullptr;
+	}
+}
+
+ValueType foldFloat(Kind kind, double a, double b)
+{
+	switch (kind) {
+	case Kind::Add:
+		return makeFloat(a + b);
+	case Kind::Subtract:
+		return makeFloat(a - b);
+	case Kind::Multiply:
+		return makeFloat(a * b);
+	case Kind::Divide:
+		return b == 0.0 ? nullptr : makeFloat(a / b);
+	default:
+		return nullptr;
+	}
+}
+
+ValueType foldBinary(const ir::BinaryOpExpression* binop)
+{
+	auto op1 = literalValue(binop->getOp1());
+	auto op2 = literalValue(binop->getOp2());
+	if (!op1 || !op2)
+		return nullptr;
+
+	if (auto comparison = ir::as<ir::ComparisonExpression>(binop)) {
+		std::optional<bool> result;
+		if (auto a = intValue(op1), b = intValue(op2); a && b)
+			result = compare(comparison->getOperation(), *a, *b);
+		else if (auto a = floatValue(op1), b = floatValue(op2); a && b)
+			result = compare(comparison->getOperation(), *a, *b);
+		else if (auto a = stringValue(op1), b = stringValue(op2); a && b && isPlain(*a) && isPlain(*b))
+			result = compare(comparison->getOperation(), *a, *b);
+
+		return result ? makeInt(*result) : nullptr;
+	}
+
+	if (auto a = intValue(op1), b = intValue(op2); a && b)
+		return foldInt(binop->kind(), *a, *b);
+	if (auto a = floatValue(op1), b = floatValue(op2); a && b)
+		return foldFloat(binop->kind(), *a, *b);
+	if (auto a = stringValue(op1), b = stringValue(op2); a && b && binop->kind() == Kind::Add)
+		return ir::make<ir::LiteralExpression>(ir::Literal(*a + *b));
+
+	return nullptr;
+}
+
+}
+
+void ConstantFolding::run(const ir::Function::Ptr& function)
+{
+	if (!function->first())
+		return;
+
+	do {
+		_changed = false;
+		collectConstants(function);
+		visitBlock(function->first());
+	} while (_changed);
+}
+
+ValueType ConstantFolding::fold(const ValueType& expr)
+{
+	ValueType result = nullptr;
+	if (auto binop = ir::as<ir::BinaryOpExpression>(expr.get())) {
+		result = foldBinary(binop);
+	}
+	else if (auto notExpr = ir::as<ir::NotExpression>(expr.get())) {
+		if (auto value = intValue(literalValue(notExpr->getOperand())))
+			result = makeInt(*value == 0);
+	}
+	else if (auto cast = ir::as<ir::StringCastExpression>(expr.get())) {
+		if (auto value = intValue(literalValue(cast->getOperand())))
+			result = ir::make<ir::LiteralExpression>(ir::Literal(std::to_string(*value)));
+	}
+
+	return result ? result : expr;
+}
+
+void ConstantFolding::collectConstants(const ir::Function::Ptr& function)
+{
+	std::unordered_map<ir::AllocaInstruction*, ir::Assignment*> assignments;
+	std::unordered_map<ir::AllocaInstruction*, std::size_t> counts;
+	countAssignments(function->first(), assignments, counts);
+
+	// Arguments are assigned by the caller.
+	for (auto& arg: function->args())
+		counts[arg.get()]++;
+
+	_constants.clear();
+	for (auto& [alloca, count]: counts) {
+		auto assignment = assignments.find(alloca);
+		if (count != 1 || assignment == assignments.end())
+			continue;
+
+		auto expr = assignment->second->getExpr();
+		if (literalValue(expr))
+			_constants[alloca] = expr;
+	}
+}
+
+void ConstantFolding::countAssignments(
+		const ir::BasicBlock::Ptr& block,
+		std::unordered_map<ir::AllocaInstruction*, ir::Assignment*>& assignments,
+		std::unordered_map<ir::AllocaInstruction*, std::size_t>& counts) const
+{
+	if (!block)
+		return;
+
+	for (auto instr = block->first(); instr != nullptr; instr = instr->next()) {
+		if (auto assignment = ir::as<ir::Assignment>(instr.get())) {
+			if (auto alloca = assignment->getAlloca()) {
+				assignments[alloca.get()] = assignment;
+				counts[alloca.get()]++;
+			}
+		}
+		else if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+			countAssignments(branch->getIf(), assignments, counts);
+			countAssignments(branch->getElse(), assignments, counts);
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+			countAssignments(loop->getBody(), assignments, counts);
+		}
+	}
+}
+
+void ConstantFolding::visitBlock(const ir::BasicBlock::Ptr& block)
+{
+	if (!block)
+		return;
+
+	std::vector<ir::Instruction::Ptr> instructions;
+	for (auto instr = block->first(); instr != nullptr; instr = instr->next()) {
+		if (auto assignment = ir::as<ir::Assignment>(instr.get())) {
+			assignment->setExpr(visit(assignment->getExpr()));
+		}
+		else if (auto assignment = ir::as<ir::ObjectAssignment>(instr.get())) {
+			assignment->setExpr(visit(assignment->getExpr()));
+		}
+		else if (auto ret = ir::as<ir::Return>(instr.get())) {
+			if (!ret->isVoid())
+				ret->setExpr(visit(ret->getExpr()));
+		}
+		else if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+			branch->setExpr(visit(branch->getExpr()));
+			visitBlock(branch->getIf());
+			visitBlock(branch->getElse());
+
+			if (auto condition = intValue(literalValue(branch->getExpr()))) {
+				// Instructions of the taken block replace the branch.
+				auto taken = *condition ? branch->getIf() : branch->getElse();
+				for (auto i = taken ? taken->first() : nullptr; i != nullptr; i = i->next())
+					instructions.push_back(i);
+
+				_changed = true;
+				continue;
+			}
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+			loop->setExpr(visit(loop->getExpr()));
+			if (auto condition = intValue(literalValue(loop->getExpr())); condition && *condition == 0) {
+				_changed = true;
+				continue;
+			}
+
+			visitBlock(loop->getBody());
+		}
+
+		instructions.push_back(instr);
+	}
+
+	block->setInstructions(instructions);
+}
+
+ValueType ConstantFolding::foldVisited(const ValueType& expr)
+{
+	auto result = fold(expr);
+	if (result != expr)
+		_changed = true;
+
+	return result;
+}
+
+ValueType ConstantFolding::visit(const ValueType& expr)
+{
+	switch (expr->kind()) {
+	case Kind::Symbol: {
+		auto symbol = static_cast<ir::SymbolExpression*>(expr.get());
+		auto constant = _constants.find(symbol->getValue().get());
+		if (constant == _constants.end())
+			return expr;
+
+		_changed = true;
+		return constant->second;
+	}
+	case Kind::Function:
+	case Kind::Method: {
+		auto function = static_cast<ir::FunctionExpression*>(expr.get());
+		auto args = function->getArgs();
+		for (auto& arg: args)
+			arg = visit(arg);
+
+		function->setArgs(args);
+		return expr;
+	}
+	case Kind::Add:
+	case Kind::Subtract:
+	case Kind::Multiply:
+	case Kind::Divide:
+	case Kind::Comparison:
+	case Kind::And:
+	case Kind::Or: {
+		auto binop = static_cast<ir::BinaryOpExpression*>(expr.get());
+		auto op1 = visit(binop->getOp1());
+		auto op2 = visit(binop->getOp2());
+		return foldVisited(op1 == binop->getOp1() && op2 == binop->getOp2() ? expr : rebuild(binop, op1, op2));
+	}
+	case Kind::Not: {
+		auto operand = static_cast<ir::NotExpression*>(expr.get())->getOperand();
+		auto visited = visit(operand);
+		return foldVisited(visited == operand ? expr : ir::make<ir::NotExpression>(visited));
+	}
+	case Kind::StringCast: {
+		auto operand = static_cast<ir::StringCastExpression*>(expr.get())->getOperand();
+		auto visited = visit(operand);
+		return foldVisited(visited == operand ? expr : ir::make<ir::StringCastExpression>(visited));
+	}
+	default:
+		return expr;
+	}
+}
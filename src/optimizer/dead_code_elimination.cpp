@@ -0,0 +1,354 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "vypcomp/ir/arena.h"
+#include "vypcomp/optimizer/dead_code_elimination.h"
+#include "vypcomp/optimizer/walk.h"
+
+using namespace vypcomp;
+
+namespace {
+
+using Kind = ir::Expression::Kind;
+
+template<class Set>
+void addUses(const ir::Expression::ValueType& expr, Set& variables)
+{
+	forEachExpression(expr, [&variables](const ir::Expression::ValueType& e) {
+		if (auto symbol = ir::as<ir::SymbolExpression>(e.get()))
+			variables.insert(symbol->getValue().get());
+		else if (auto attribute = ir::as<ir::ObjectAttributeExpression>(e.get()))
+			variables.insert(attribute->getObject().get());
+	});
+}
+
+bool isNonZeroLiteral(const ir::Expression::ValueType& expr)
+{
+	if (expr->kind() != Kind::Literal)
+		return false;
+
+	auto value = static_cast<ir::LiteralExpression*>(expr.get())->getValue().value();
+	if (auto i = std::get_if<unsigned long long>(&value))
+		return *i != 0;
+	if (auto f = std::get_if<double>(&value))
+		return *f != 0.0;
+
+	return false;
+}
+
+ir::Class::Ptr findClass(const SymbolTable& table, const ir::Name& name)
+{
+	auto symbol = table.find(name);
+	if (!symbol || !std::holds_alternative<ir::Class::Ptr>(*symbol))
+		return nullptr;
+
+	return std::get<ir::Class::Ptr>(*symbol);
+}
+
+}
+
+// ------------------------------
+// Program
+// ------------------------------
+
+void DeadCodeElimination::run(SymbolTable& table)
+{
+	auto main = table.find("main");
+	if (!main || !std::holds_alternative<ir::Function::Ptr>(*main))
+		return;
+
+	std::unordered_set<ir::Function*> reached;
+	std::unordered_set<ir::Class*> kept;
+	ir::NameMap<bool> called;
+	std::vector<ir::Function::Ptr> functions;
+	std::vector<ir::Class::Ptr> classes, newClasses;
+
+	auto reach = [&](const ir::Function::Ptr& function) {
+		if (function && reached.insert(function.get()).second)
+			functions.push_back(function);
+	};
+	auto keep = [&](const ir::Class::Ptr& cl) {
+		if (cl && kept.insert(cl.get()).second)
+			newClasses.push_back(cl);
+	};
+	auto visit = [&](const ir::Expression::ValueType& expr) {
+		// Static type of object is needed even if no instance of it is
+		// created, its vtable is used for method lookup and its class id
+		// range is checked by casts of the object.
+		auto type = expr->type();
+		if (type.is<ir::Datatype::ClassName>())
+			keep(findClass(table, type.get<ir::Datatype::ClassName>()));
+
+		if (expr->kind() == Kind::Function) {
+			auto symbol = table.find(static_cast<ir::FunctionExpression*>(expr.get())->getFunction()->name());
+			if (symbol && std::holds_alternative<ir::Function::Ptr>(*symbol))
+				reach(std::get<ir::Function::Ptr>(*symbol));
+		}
+		else if (expr->kind() == Kind::Method) {
+			auto method = static_cast<ir::MethodExpression*>(expr.get());
+			called[method->getFunction()->name()] = true;
+		}
+		else if (expr->kind() == Kind::Constructor) {
+			keep(findClass(table, static_cast<ir::ConstructorExpression*>(expr.get())->getFunctionName()));
+		}
+		else if (expr->kind() == Kind::ObjectCast) {
+			// Class id of the object is checked against the id range
+			// of the target class.
+			keep(findClass(table, static_cast<ir::ObjectCastExpression*>(expr.get())->getTargetClass()->name()));
+		}
+	};
+
+	reach(std::get<ir::Function::Ptr>(*main));
+	for (;;) {
+		if (!functions.empty()) {
+			auto function = functions.back();
+			functions.pop_back();
+			forEachInstruction(function->first(), [&visit](const ir::Instruction::Ptr& instr) {
+				forEachExpression(instr, visit);
+			});
+		}
+		else if (!newClasses.empty()) {
+			auto cl = newClasses.back();
+			newClasses.pop_back();
+			classes.push_back(cl);
+			keep(cl->getBase());
+			reach(cl->constructor());
+			for (auto& instr: cl->implicit())
+				forEachExpression(instr, visit);
+		}
+		else {
+			// Methods are called through vtables, every method of kept
+			// class that has name of called method may be invoked.
+			for (auto& cl: classes) {
+				for (auto methods: {&cl->publicMethods(), &cl->protectedMethods(), &cl->privateMethods()}) {
+					for (auto& method: *methods) {
+						if (called.find(method->name()))
+							reach(method);
+					}
+				}
+			}
+
+			if (functions.empty())
+				break;
+		}
+	}
+
+	for (auto& [name, symbol]: table.data()) {
+		if (auto function = std::get_if<ir::Function::Ptr>(&symbol)) {
+			if (!reached.count(function->get()))
+				table.erase(name);
+		}
+		else if (auto cl = std::get_if<ir::Class::Ptr>(&symbol)) {
+			if (!kept.count(cl->get())) {
+				table.erase(name);
+				continue;
+			}
+
+			std::vector<ir::Function::Ptr> unreached;
+			for (auto methods: {&(*cl)->publicMethods(), &(*cl)->protectedMethods(), &(*cl)->privateMethods()}) {
+				std::copy_if(methods->begin(), methods->end(), std::back_inserter(unreached), [&reached](const auto& method) {
+					return !reached.count(method.get());
+				});
+			}
+			for (auto& method: unreached)
+				(*cl)->remove(method);
+		}
+	}
+}
+
+// ------------------------------
+// Function
+// ------------------------------
+
+void DeadCodeElimination::run(const ir::Function::Ptr& function)
+{
+	auto body = function->first();
+	if (!body)
+		return;
+
+	removeUnreachable(body);
+
+	// Removed store might have been the last read of other variable.
+	for (bool changed = true; changed;) {
+		Variables live;
+		changed = removeDeadStores(body, live, true);
+	}
+
+	Variables used;
+	for (auto& arg: function->args())
+		used.insert(arg.get());
+	forEachInstruction(body, [&used](const ir::Instruction::Ptr& instr) {
+		if (auto assignment = ir::as<ir::Assignment>(instr.get()))
+			used.insert(assignment->getAlloca().get());
+		forEachExpression(instr, [&used](const ir::Expression::ValueType& expr) {
+			addUses(expr, used);
+		});
+	});
+	removeUnused(body, used);
+}
+
+bool DeadCodeElimination::hasSideEffects(const ir::Expression::ValueType& expr)
+{
+	bool result = false;
+	forEachExpression(expr, [&result](const ir::Expression::ValueType& e) {
+		switch (e->kind()) {
+		case Kind::Function:
+		case Kind::Constructor:
+		case Kind::Method:
+		// Invalid cast and access to attribute of null are runtime errors.
+		case Kind::ObjectCast:
+		case Kind::ObjectAttribute:
+			result = true;
+			break;
+		case Kind::Divide:
+			result = result || !isNonZeroLiteral(static_cast<ir::DivideExpression*>(e.get())->getOp2());
+			break;
+		default:
+			break;
+		}
+	});
+
+	return result;
+}
+
+bool DeadCodeElimination::removeUnreachable(const ir::BasicBlock::Ptr& block) const
+{
+	if (!block)
+		return false;
+
+	auto instructions = block->instructions();
+	for (std::size_t i = 0; i < instructions.size(); i++) {
+		bool terminates = false;
+		if (ir::is<ir::Return>(instructions[i])) {
+			terminates = true;
+		}
+		else if (auto branch = ir::as<ir::BranchInstruction>(instructions[i].get())) {
+			// Both blocks have to be visited.
+			auto ifTerminates = removeUnreachable(branch->getIf());
+			auto elseTerminates = removeUnreachable(branch->getElse());
+			terminates = ifTerminates && elseTerminates;
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instructions[i].get())) {
+			removeUnreachable(loop->getBody());
+		}
+
+		if (terminates) {
+			if (i+1 < instructions.size()) {
+				instructions.resize(i+1);
+				block->setInstructions(instructions);
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool DeadCodeElimination::removeDeadStores(const ir::BasicBlock::Ptr& block, Variables& live, bool remove) const
+{
+	if (!block)
+		return false;
+
+	bool changed = false;
+	auto instructions = block->instructions();
+	std::vector<ir::Instruction::Ptr> result;
+	for (auto i = instructions.rbegin(); i != instructions.rend(); i++) {
+		auto instr = *i;
+		if (auto assignment = ir::as<ir::Assignment>(instr.get())) {
+			auto alloca = assignment->getAlloca().get();
+			auto expr = assignment->getExpr();
+			if (alloca && !live.count(alloca) && remove) {
+				if (!hasSideEffects(expr)) {
+					changed = true;
+					continue;
+				}
+
+				// Result of call is discarded.
+				if (ir::is<ir::FunctionExpression>(expr)) {
+					instr = ir::make<ir::Assignment>(nullptr, expr);
+					changed = true;
+				}
+			}
+
+			live.erase(alloca);
+			addUses(expr, live);
+		}
+		else if (auto assignment = ir::as<ir::ObjectAssignment>(instr.get())) {
+			addUses(assignment->getTarget(), live);
+			addUses(assignment->getExpr(), live);
+		}
+		else if (auto ret = ir::as<ir::Return>(instr.get())) {
+			live.clear();
+			if (!ret->isVoid())
+				addUses(ret->getExpr(), live);
+		}
+		else if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+			auto elseLive = live;
+			changed = removeDeadStores(branch->getIf(), live, remove) || changed;
+			changed = removeDeadStores(branch->getElse(), elseLive, remove) || changed;
+			live.insert(elseLive.begin(), elseLive.end());
+			addUses(branch->getExpr(), live);
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+			// Variables live at condition are live after the body too.
+			auto exit = live;
+			addUses(loop->getExpr(), live);
+			for (;;) {
+				auto next = live;
+				removeDeadStores(loop->getBody(), next, false);
+				next.insert(exit.begin(), exit.end());
+				addUses(loop->getExpr(), next);
+				if (next == live)
+					break;
+
+				live = std::move(next);
+			}
+
+			if (remove) {
+				auto body = live;
+				changed = removeDeadStores(loop->getBody(), body, true) || changed;
+			}
+		}
+
+		result.push_back(instr);
+	}
+
+	if (changed) {
+		std::reverse(result.begin(), result.end());
+		block->setInstructions(result);
+	}
+
+	return changed;
+}
+
+void DeadCodeElimination::removeUnused(const ir::BasicBlock::Ptr& block, const Variables& used) const
+{
+	if (!block)
+		return;
+
+	auto instructions = block->instructions();
+	auto end = std::remove_if(instructions.begin(), instructions.end(), [&used](const auto& instr) {
+		auto alloca = ir::as<ir::AllocaInstruction>(instr.get());
+		return alloca && !used.count(alloca);
+	});
+	if (end != instructions.end()) {
+		instructions.erase(end, instructions.end());
+		block->setInstructions(instructions);
+	}
+
+	for (auto& instr: instructions) {
+		if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+			removeUnused(branch->getIf(), used);
+			removeUnused(branch->getElse(), used);
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+			removeUnused(loop->getBody(), used);
+		}
+	}
+}
@@ -0,0 +1,513 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <stdexcept>
+#include <unordered_map>
+
+#include "vypcomp/ir/arena.h"
+#include "vypcomp/optimizer/dead_code_elimination.h"
+#include "vypcomp/optimizer/inliner.h"
+#include "vypcomp/optimizer/walk.h"
+
+using namespace vypcomp;
+
+namespace {
+
+using Kind = ir::Expression::Kind;
+using ValueType = ir::Expression::ValueType;
+
+/**
+ * Creates copy of function body for the caller. Variables declared
+ * by the copied code are replaced by new ones, parameters are either
+ * replaced by new variables or by expressions of arguments.
+ */
+class Copier {
+public:
+	ir::AllocaInstruction::Ptr variable(const ir::AllocaInstruction::Ptr& alloca) const
+	{
+		auto variable = variables.find(alloca.get());
+		return variable == variables.end() ? alloca : variable->second;
+	}
+
+	ir::AllocaInstruction::Ptr declare(const ir::AllocaInstruction::Ptr& alloca)
+	{
+		auto result = ir::make<ir::AllocaInstruction>(ir::Declaration{alloca->type(), alloca->name()});
+		variables[alloca.get()] = result;
+		return result;
+	}
+
+	ValueType expression(const ValueType& expr) const
+	{
+		switch (expr->kind()) {
+		case Kind::Symbol: {
+			auto symbol = static_cast<ir::SymbolExpression*>(expr.get());
+			auto value = values.find(symbol->getValue().get());
+			if (value == values.end())
+				return ir::make<ir::SymbolExpression>(variable(symbol->getValue()));
+
+			// Each use of argument gets its own node.
+			auto argument = ir::as<ir::SymbolExpression>(value->second.get());
+			return argument ? ir::make<ir::SymbolExpression>(argument->getValue()) : value->second;
+		}
+		case Kind::Super: {
+			auto super = static_cast<ir::SuperExpression*>(expr.get());
+			return ir::make<ir::SuperExpression>(object(super->getValue()), super->getClass());
+		}
+		case Kind::ObjectCast: {
+			auto cast = static_cast<ir::ObjectCastExpression*>(expr.get());
+			return ir::make<ir::ObjectCastExpression>(cast->getTargetClass(), expression(cast->getOperand()));
+		}
+		case Kind::StringCast: {
+			auto cast = static_cast<ir::StringCastExpression*>(expr.get());
+			return ir::make<ir::StringCastExpression>(expression(cast->getOperand()));
+		}
+		case Kind::Function: {
+			auto call = static_cast<ir::FunctionExpression*>(expr.get());
+			return ir::make<ir::FunctionExpression>(call->getFunction(), expressions(call->getArgs()));
+		}
+		case Kind::Method: {
+			auto call = static_cast<ir::MethodExpression*>(expr.get());
+			auto args = call->getArgs();
+			auto copiedArgs = expressions(args);
+			// Context object is shared with the first argument.
+			auto context = !args.empty() && args[0] == call->getContextObj()
+				? copiedArgs[0]
+				: expression(call->getContextObj());
+
+			auto result = ir::make<ir::MethodExpression>(call->getFunction(), context);
+			result->setArgs(copiedArgs);
+			return result;
+		}
+		case Kind::Add:
+		case Kind::Subtract:
+		case Kind::Multiply:
+		case Kind::Divide:
+		case Kind::Comparison:
+		case Kind::And:
+		case Kind::Or: {
+			auto binop = static_cast<ir::BinaryOpExpression*>(expr.get());
+			return rebuild(binop, expression(binop->getOp1()), expression(binop->getOp2()));
+		}
+		case Kind::Not: {
+			auto notExpr = static_cast<ir::NotExpression*>(expr.get());
+			return ir::make<ir::NotExpression>(expression(notExpr->getOperand()));
+		}
+		case Kind::ObjectAttribute: {
+			auto attribute = static_cast<ir::ObjectAttributeExpression*>(expr.get());
+			return ir::make<ir::ObjectAttributeExpression>(
+				object(attribute->getObject()), attribute->getAttribute(), attribute->getClass());
+		}
+		case Kind::Constructor:
+			throw std::runtime_error("Constructor call cannot be copied: " + expr->to_string());
+		default:
+			// Literals are never modified in place.
+			return expr;
+		}
+	}
+
+	ir::Instruction::Ptr instruction(const ir::Instruction::Ptr& instr)
+	{
+		if (auto alloca = ir::as<ir::AllocaInstruction>(instr)) {
+			return declare(alloca);
+		}
+		else if (auto assignment = ir::as<ir::Assignment>(instr.get())) {
+			auto alloca = assignment->getAlloca();
+			return ir::make<ir::Assignment>(alloca ? variable(alloca) : nullptr, expression(assignment->getExpr()));
+		}
+		else if (auto assignment = ir::as<ir::ObjectAssignment>(instr.get())) {
+			return ir::make<ir::ObjectAssignment>(expression(assignment->getTarget()), expression(assignment->getExpr()));
+		}
+		else if (auto ret = ir::as<ir::Return>(instr.get())) {
+			return ir::make<ir::Return>(ret->isVoid() ? nullptr : expression(ret->getExpr()));
+		}
+		else if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+			auto condition = expression(branch->getExpr());
+			auto ifBlock = block(branch->getIf());
+			return ir::make<ir::BranchInstruction>(condition, ifBlock, block(branch->getElse()));
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+			auto condition = expression(loop->getExpr());
+			return ir::make<ir::LoopInstruction>(condition, block(loop->getBody()));
+		}
+
+		throw std::runtime_error("Unexpected instruction in function body:\n" + instr->str(""));
+	}
+
+	ir::BasicBlock::Ptr block(const ir::BasicBlock::Ptr& block)
+	{
+		if (!block)
+			return nullptr;
+
+		std::vector<ir::Instruction::Ptr> instructions;
+		for (auto instr = block->first(); instr != nullptr; instr = instr->next())
+			instructions.push_back(instruction(instr));
+
+		auto result = ir::BasicBlock::create();
+		result->setInstructions(instructions);
+		return result;
+	}
+
+	/// Variables of callee replaced by variables of caller.
+	std::unordered_map<ir::AllocaInstruction*, ir::AllocaInstruction::Ptr> variables;
+	/// Parameters of callee replaced by arguments.
+	std::unordered_map<ir::AllocaInstruction*, ValueType> values;
+
+private:
+	std::vector<ValueType> expressions(std::vector<ValueType> exprs) const
+	{
+		for (auto& expr: exprs)
+			expr = expression(expr);
+
+		return exprs;
+	}
+
+	/**
+	 * Object variable of attribute access. Parameter is replaced by
+	 * symbol passed as its argument.
+	 */
+	ir::AllocaInstruction::Ptr object(const ir::AllocaInstruction::Ptr& alloca) const
+	{
+		auto value = values.find(alloca.get());
+		if (value == values.end())
+			return variable(alloca);
+
+		return static_cast<ir::SymbolExpression*>(value->second.get())->getValue();
+	}
+};
+
+bool hasReturn(const ir::BasicBlock::Ptr& block)
+{
+	bool result = false;
+	forEachInstruction(block, [&result](const ir::Instruction::Ptr& instr) {
+		result = result || ir::is<ir::Return>(instr);
+	});
+
+	return result;
+}
+
+}
+
+void Inliner::run(SymbolTable& table)
+{
+	std::vector<ir::Function::Ptr> functions;
+	std::vector<ir::Class::Ptr> classes;
+	for (auto& [_, symbol]: table.data()) {
+		if (auto function = std::get_if<ir::Function::Ptr>(&symbol))
+			functions.push_back(*function);
+		else if (auto cl = std::get_if<ir::Class::Ptr>(&symbol))
+			classes.push_back(*cl);
+	}
+
+	_recursive.clear();
+	for (auto& function: functions) {
+		Functions visited;
+		if (reaches(function, function.get(), visited))
+			_recursive.insert(function.get());
+	}
+
+	// Callees are finished before their bodies are copied.
+	Functions visited;
+	std::vector<ir::Function::Ptr> ordered;
+	for (auto& function: functions)
+		order(function, visited, ordered);
+
+	for (auto& function: ordered)
+		run(function);
+
+	for (auto& cl: classes) {
+		run(cl->constructor());
+		for (auto methods: {&cl->publicMethods(), &cl->protectedMethods(), &cl->privateMethods()}) {
+			for (auto& method: *methods) {
+				if (method != cl->constructor())
+					run(method);
+			}
+		}
+	}
+}
+
+void Inliner::run(const ir::Function::Ptr& function)
+{
+	if (!function || !function->first())
+		return;
+
+	_current = function.get();
+	visitBlock(function->first());
+	_current = nullptr;
+}
+
+std::size_t Inliner::size(const ir::Function::Ptr& function)
+{
+	std::size_t result = 0;
+	forEachInstruction(function->first(), [&result](const ir::Instruction::Ptr& instr) {
+		result++;
+		forEachExpression(instr, [&result](const ValueType&) {
+			result++;
+		});
+	});
+
+	return result;
+}
+
+std::vector<ir::Function::Ptr> Inliner::callees(const ir::Function::Ptr& function)
+{
+	std::vector<ir::Function::Ptr> result;
+	forEachInstruction(function->first(), [&result](const ir::Instruction::Ptr& instr) {
+		forEachExpression(instr, [&result](const ValueType& expr) {
+			// Builtins have no body.
+			if (expr->kind() == Kind::Function) {
+				auto callee = static_cast<ir::FunctionExpression*>(expr.get())->getFunction();
+				if (callee->first())
+					result.push_back(callee);
+			}
+		});
+	});
+
+	return result;
+}
+
+void Inliner::order(const ir::Function::Ptr& function, Functions& visited, std::vector<ir::Function::Ptr>& result) const
+{
+	if (!visited.insert(function.get()).second || !function->first())
+		return;
+
+	for (auto& callee: callees(function))
+		order(callee, visited, result);
+
+	result.push_back(function);
+}
+
+bool Inliner::reaches(const ir::Function::Ptr& from, const ir::Function* to, Functions& visited) const
+{
+	if (!from->first())
+		return false;
+
+	for (auto& callee: callees(from)) {
+		if (callee.get() == to)
+			return true;
+		if (visited.insert(callee.get()).second && reaches(callee, to, visited))
+			return true;
+	}
+
+	return false;
+}
+
+bool Inliner::canInline(const ir::Function::Ptr& callee) const
+{
+	if (!callee->first() || callee.get() == _current || _recursive.count(callee.get()))
+		return false;
+
+	if (size(callee) > MaxSize)
+		return false;
+
+	// Return is allowed only at the end of the body.
+	auto last = callee->first()->last();
+	for (auto instr = callee->first()->first(); instr != nullptr; instr = instr->next()) {
+		if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+			if (hasReturn(branch->getIf()) || hasReturn(branch->getElse()))
+				return false;
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+			if (hasReturn(loop->getBody()))
+				return false;
+		}
+		else if (ir::is<ir::Return>(instr) && instr != last) {
+			return false;
+		}
+	}
+
+	if (!callee->isVoid()) {
+		auto ret = ir::as<ir::Return>(last);
+		if (!ret || ret->isVoid())
+			return false;
+	}
+
+	bool constructs = false;
+	forEachInstruction(callee->first(), [&constructs](const ir::Instruction::Ptr& instr) {
+		forEachExpression(instr, [&constructs](const ValueType& expr) {
+			constructs = constructs || expr->kind() == Kind::Constructor;
+		});
+	});
+
+	return !constructs;
+}
+
+bool Inliner::canSubstitute(const ir::FunctionExpression* call) const
+{
+	auto callee = call->getFunction();
+	if (!canInline(callee) || callee->isVoid() || callee->first()->first() != callee->first()->last())
+		return false;
+
+	// Arguments without side effects depend only on local variables,
+	// so moving their evaluation into the body does not change them.
+	auto args = call->getArgs();
+	for (auto& arg: args) {
+		if (DeadCodeElimination::hasSideEffects(arg))
+			return false;
+	}
+
+	std::unordered_map<ir::AllocaInstruction*, std::size_t> uses;
+	std::unordered_set<ir::AllocaInstruction*> objects;
+	auto ret = ir::as<ir::Return>(callee->first()->first());
+	forEachExpression(ret->getExpr(), [&uses, &objects](const ValueType& expr) {
+		if (auto symbol = ir::as<ir::SymbolExpression>(expr.get()))
+			uses[symbol->getValue().get()]++;
+		else if (auto attribute = ir::as<ir::ObjectAttributeExpression>(expr.get()))
+			objects.insert(attribute->getObject().get());
+	});
+
+	auto& params = callee->args();
+	for (std::size_t i = 0; i < params.size(); i++) {
+		// Arguments are not evaluated repeatedly unless they are simple.
+		if (uses[params[i].get()] > 1 && !args[i]->is_simple())
+			return false;
+		// Attribute is accessed only through variable.
+		if (objects.count(params[i].get()) && args[i]->kind() != Kind::Symbol)
+			return false;
+	}
+
+	return true;
+}
+
+void Inliner::visitBlock(const ir::BasicBlock::Ptr& block)
+{
+	if (!block)
+		return;
+
+	std::vector<ir::Instruction::Ptr> instructions;
+	for (auto instr = block->first(); instr != nullptr; instr = instr->next()) {
+		if (auto assignment = ir::as<ir::Assignment>(instr.get())) {
+			assignment->setExpr(visit(assignment->getExpr()));
+		}
+		else if (auto assignment = ir::as<ir::ObjectAssignment>(instr.get())) {
+			assignment->setExpr(visit(assignment->getExpr()));
+		}
+		else if (auto ret = ir::as<ir::Return>(instr.get())) {
+			if (!ret->isVoid())
+				ret->setExpr(visit(ret->getExpr()));
+		}
+		else if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+			branch->setExpr(visit(branch->getExpr()));
+			visitBlock(branch->getIf());
+			visitBlock(branch->getElse());
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+			loop->setExpr(visit(loop->getExpr()));
+			visitBlock(loop->getBody());
+		}
+
+		if (!expand(instr, instructions))
+			instructions.push_back(instr);
+	}
+
+	block->setInstructions(instructions);
+}
+
+ValueType Inliner::visit(const ValueType& expr)
+{
+	switch (expr->kind()) {
+	case Kind::Function:
+	case Kind::Method: {
+		auto call = static_cast<ir::FunctionExpression*>(expr.get());
+		auto args = call->getArgs();
+		for (auto& arg: args)
+			arg = visit(arg);
+
+		call->setArgs(args);
+		if (expr->kind() != Kind::Function || !canSubstitute(call))
+			return expr;
+
+		auto callee = call->getFunction();
+		Copier copier;
+		for (std::size_t i = 0; i < args.size(); i++)
+			copier.values[callee->args()[i].get()] = args[i];
+
+		return copier.expression(ir::as<ir::Return>(callee->first()->first())->getExpr());
+	}
+	case Kind::Add:
+	case Kind::Subtract:
+	case Kind::Multiply:
+	case Kind::Divide:
+	case Kind::Comparison:
+	case Kind::And:
+	case Kind::Or: {
+		auto binop = static_cast<ir::BinaryOpExpression*>(expr.get());
+		auto op1 = visit(binop->getOp1());
+		auto op2 = visit(binop->getOp2());
+		return op1 == binop->getOp1() && op2 == binop->getOp2() ? expr : rebuild(binop, op1, op2);
+	}
+	case Kind::Not: {
+		auto operand = static_cast<ir::NotExpression*>(expr.get())->getOperand();
+		auto visited = visit(operand);
+		return visited == operand ? expr : ir::make<ir::NotExpression>(visited);
+	}
+	case Kind::StringCast: {
+		auto operand = static_cast<ir::StringCastExpression*>(expr.get())->getOperand();
+		auto visited = visit(operand);
+		return visited == operand ? expr : ir::make<ir::StringCastExpression>(visited);
+	}
+	case Kind::ObjectCast: {
+		auto cast = static_cast<ir::ObjectCastExpression*>(expr.get());
+		auto visited = visit(cast->getOperand());
+		return visited == cast->getOperand() ? expr : ir::make<ir::ObjectCastExpression>(cast->getTargetClass(), visited);
+	}
+	default:
+		return expr;
+	}
+}
+
+bool Inliner::expand(const ir::Instruction::Ptr& instr, std::vector<ir::Instruction::Ptr>& result)
+{
+	ValueType expr;
+	ir::AllocaInstruction::Ptr destination;
+	auto assignment = ir::as<ir::Assignment>(instr.get());
+	auto ret = ir::as<ir::Return>(instr.get());
+	if (assignment) {
+		expr = assignment->getExpr();
+		destination = assignment->getAlloca();
+	}
+	else if (ret && !ret->isVoid()) {
+		expr = ret->getExpr();
+	}
+
+	if (!expr || expr->kind() != Kind::Function)
+		return false;
+
+	auto call = static_cast<ir::FunctionExpression*>(expr.get());
+	auto callee = call->getFunction();
+	if (!canInline(callee))
+		return false;
+
+	// Arguments are evaluated in order into new variables.
+	Copier copier;
+	auto args = call->getArgs();
+	for (std::size_t i = 0; i < args.size(); i++) {
+		auto param = copier.declare(callee->args()[i]);
+		result.push_back(param);
+		result.push_back(ir::make<ir::Assignment>(param, args[i]));
+	}
+
+	ValueType value;
+	for (auto i = callee->first()->first(); i != nullptr; i = i->next()) {
+		if (auto calleeRet = ir::as<ir::Return>(i.get()))
+			value = calleeRet->isVoid() ? nullptr : copier.expression(calleeRet->getExpr());
+		else
+			result.push_back(copier.instruction(i));
+	}
+
+	if (ret) {
+		result.push_back(ir::make<ir::Return>(value));
+	}
+	else if (destination) {
+		result.push_back(ir::make<ir::Assignment>(destination, value));
+	}
+	else if (value) {
+		// Discarded value is left for dead code elimination.
+		auto discarded = ir::make<ir::AllocaInstruction>(ir::Declaration{value->type(), callee->name()});
+		result.push_back(discarded);
+		result.push_back(ir::make<ir::Assignment>(discarded, value));
+	}
+
+	return true;
+}
@@ -0,0 +1,52 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include "vypcomp/optimizer/optimizer.h"
+#include "vypcomp/optimizer/constant_folding.h"
+#include "vypcomp/optimizer/dead_code_elimination.h"
+#include "vypcomp/optimizer/inliner.h"
+#include "vypcomp/optimizer/string_concatenation.h"
+
+using namespace vypcomp;
+
+void Optimizer::run(SymbolTable& table)
+{
+	// Nodes created by passes are owned by arena of the program.
+	ir::Arena::Scope scope(table.arena().get());
+
+	// Inlined bodies are simplified together with the caller.
+	Inliner().run(table);
+
+	for (auto& [_, symbol]: table.data()) {
+		if (auto function = std::get_if<ir::Function::Ptr>(&symbol))
+			run(*function);
+		else if (auto cl = std::get_if<ir::Class::Ptr>(&symbol))
+			run(*cl);
+	}
+
+	DeadCodeElimination().run(table);
+}
+
+void Optimizer::run(const ir::Function::Ptr& function)
+{
+	if (!function || !function->first())
+		return;
+
+	ConstantFolding().run(function);
+	DeadCodeElimination().run(function);
+	// Runs last, folding and inlining do not look into concatenations.
+	StringConcatenation().run(function);
+}
+
+void Optimizer::run(const ir::Class::Ptr& cl)
+{
+	run(cl->constructor());
+	for (auto methods: {&cl->publicMethods(), &cl->protectedMethods(), &cl->privateMethods()}) {
+		for (auto& method: *methods) {
+			if (method != cl->constructor())
+				run(method);
+		}
+	}
+}
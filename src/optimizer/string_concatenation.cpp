@@ -0,0 +1,138 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include "vypcomp/ir/arena.h"
+#include "vypcomp/optimizer/constant_folding.h"
+#include "vypcomp/optimizer/string_concatenation.h"
+#include "vypcomp/optimizer/walk.h"
+
+using namespace vypcomp;
+
+namespace {
+
+using Kind = ir::Expression::Kind;
+using ValueType = ir::Expression::ValueType;
+
+bool isStringAddition(const ValueType& expr)
+{
+	return expr->kind() == Kind::Add && expr->type() == ir::Datatype(ir::PrimitiveDatatype::String);
+}
+
+}
+
+void StringConcatenation::run(const ir::Function::Ptr& function)
+{
+	visitBlock(function->first());
+}
+
+void StringConcatenation::visitBlock(const ir::BasicBlock::Ptr& block)
+{
+	if (!block)
+		return;
+
+	for (auto instr = block->first(); instr != nullptr; instr = instr->next()) {
+		if (auto assignment = ir::as<ir::Assignment>(instr.get())) {
+			assignment->setExpr(flatten(assignment->getExpr()));
+		}
+		else if (auto assignment = ir::as<ir::ObjectAssignment>(instr.get())) {
+			assignment->setExpr(flatten(assignment->getExpr()));
+		}
+		else if (auto ret = ir::as<ir::Return>(instr.get())) {
+			if (!ret->isVoid())
+				ret->setExpr(flatten(ret->getExpr()));
+		}
+		else if (auto branch = ir::as<ir::BranchInstruction>(instr.get())) {
+			branch->setExpr(flatten(branch->getExpr()));
+			visitBlock(branch->getIf());
+			visitBlock(branch->getElse());
+		}
+		else if (auto loop = ir::as<ir::LoopInstruction>(instr.get())) {
+			loop->setExpr(flatten(loop->getExpr()));
+			visitBlock(loop->getBody());
+		}
+	}
+}
+
+ValueType StringConcatenation::flatten(const ValueType& expr)
+{
+	switch (expr->kind()) {
+	case Kind::Function:
+	case Kind::Method: {
+		auto function = static_cast<ir::FunctionExpression*>(expr.get());
+		auto args = function->getArgs();
+		for (auto& arg: args)
+			arg = flatten(arg);
+
+		function->setArgs(args);
+		return expr;
+	}
+	case Kind::Add:
+	case Kind::Subtract:
+	case Kind::Multiply:
+	case Kind::Divide:
+	case Kind::Comparison:
+	case Kind::And:
+	case Kind::Or: {
+		auto binop = static_cast<ir::BinaryOpExpression*>(expr.get());
+		if (isStringAddition(expr)) {
+			ir::ConcatExpression::Operands operands;
+			collectOperands(expr, operands);
+			if (operands.size() > 2)
+				return ir::make<ir::ConcatExpression>(operands);
+			if (operands.size() == 1)
+				return operands.front();
+
+			// Operands were flattened already, they must not be visited again.
+			if (operands[0] == binop->getOp1() && operands[1] == binop->getOp2())
+				return expr;
+			return rebuild(binop, operands[0], operands[1]);
+		}
+
+		auto op1 = flatten(binop->getOp1());
+		auto op2 = flatten(binop->getOp2());
+		return op1 == binop->getOp1() && op2 == binop->getOp2() ? expr : rebuild(binop, op1, op2);
+	}
+	case Kind::Not: {
+		auto operand = static_cast<ir::NotExpression*>(expr.get())->getOperand();
+		auto flattened = flatten(operand);
+		return flattened == operand ? expr : ir::make<ir::NotExpression>(flattened);
+	}
+	case Kind::StringCast: {
+		auto operand = static_cast<ir::StringCastExpression*>(expr.get())->getOperand();
+		auto flattened = flatten(operand);
+		return flattened == operand ? expr : ir::make<ir::StringCastExpression>(flattened);
+	}
+	case Kind::ObjectCast: {
+		auto cast = static_cast<ir::ObjectCastExpression*>(expr.get());
+		auto flattened = flatten(cast->getOperand());
+		return flattened == cast->getOperand() ? expr : ir::make<ir::ObjectCastExpression>(cast->getTargetClass(), flattened);
+	}
+	default:
+		return expr;
+	}
+}
+
+void StringConcatenation::collectOperands(const ValueType& expr, ir::ConcatExpression::Operands& operands)
+{
+	if (isStringAddition(expr)) {
+		// Operands are evaluated left to right, as the additions were.
+		auto binop = static_cast<ir::BinaryOpExpression*>(expr.get());
+		collectOperands(binop->getOp1(), operands);
+		collectOperands(binop->getOp2(), operands);
+		return;
+	}
+
+	auto operand = flatten(expr);
+	if (!operands.empty()) {
+		// Literals separated only by parentheses are joined at compile time.
+		auto joined = ConstantFolding::fold(ir::make<ir::AddExpression>(operands.back(), operand));
+		if (joined->kind() == Kind::Literal) {
+			operands.back() = joined;
+			return;
+		}
+	}
+
+	operands.push_back(operand);
+}
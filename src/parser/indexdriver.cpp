@@ -12,25 +12,37 @@ IndexParserDriver::IndexParserDriver():
 {
 }
 
+IndexParserDriver::IndexParserDriver(ir::Arena::Ptr arena):
+	ParserDriver(arena)
+{
+}
+
 IndexParserDriver::IndexParserDriver(const SymbolTable &global):
 	ParserDriver(global)
 {
 }
 
-AllocaInstruction::Ptr IndexParserDriver::newDeclaration(const Datatype& t, const std::string& id)
+AllocaInstruction::Ptr IndexParserDriver::newDeclaration(const Datatype& t, const Name& id)
 {
-	auto decl = AllocaInstruction::Ptr(new AllocaInstruction({t, id}));
+	ir::Arena::Scope scope(ParserDriver::arena());
+	auto decl = ir::make<AllocaInstruction>(Declaration{t, id});
 	add(decl);
 	return decl;
 }
 
-Class::Ptr IndexParserDriver::newClass(const std::string& name, const std::string& base) const
+ir::Arena* IndexParserDriver::arena() const
+{
+	return nullptr;
+}
+
+Class::Ptr IndexParserDriver::newClass(const Name& name, const Name& base) const
 {
         if (searchGlobal(name)) {
 		throw SemanticError("Redefinition of "+name);
         }
 	auto newBase = searchTables(base).has_value() ? base : "Object";
 
+	ir::Arena::Scope scope(ParserDriver::arena());
 	return ParserDriver::newClass(name, newBase);
 }
 
@@ -40,10 +52,11 @@ Function::Ptr IndexParserDriver::newFunction(const ir::Function::Signature& sig)
         if (searchCurrent(name)) {
 		throw SemanticError("Redefinition of "+name);
         }
+	ir::Arena::Scope scope(ParserDriver::arena());
 	return ParserDriver::newFunction({type, name, args});
 }
 
-Datatype IndexParserDriver::customDatatype(const std::string& dt) const
+Datatype IndexParserDriver::customDatatype(const Name& dt) const
 {
 	if (auto symbol = searchTables(dt)) {
 		if (!std::holds_alternative<Class::Ptr>(*symbol))
@@ -57,12 +70,12 @@ Datatype IndexParserDriver::customDatatype(const std::string& dt) const
 
 Instruction::Ptr IndexParserDriver::assign(ir::Expression::ValueType dest_expr, const ir::Expression::ValueType &val) const
 {
-	return DummyInstruction::Ptr(new DummyInstruction);
+	return ir::make<DummyInstruction>();
 }
 
-Instruction::Ptr IndexParserDriver::assign(const std::string& name, const ir::Expression::ValueType& val) const
+Instruction::Ptr IndexParserDriver::assign(const Name& name, const ir::Expression::ValueType& val) const
 {
-	return DummyInstruction::Ptr(new DummyInstruction);
+	return ir::make<DummyInstruction>();
 }
 
 Expression::ValueType IndexParserDriver::createCastExpr(const Datatype& dt, Expression::ValueType expr) const
@@ -72,127 +85,127 @@ Expression::ValueType IndexParserDriver::createCastExpr(const Datatype& dt, Expr
 
 // Expressions
 
-ir::Expression::ValueType IndexParserDriver::identifierExpr(const std::string& name) const
+ir::Expression::ValueType IndexParserDriver::identifierExpr(const Name& name) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::functionCall(
 	const ir::Expression::ValueType& identifier,
 	std::vector<ir::Expression::ValueType>& args) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::notExpr(const ir::Expression::ValueType& expr) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::thisExpr() const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::superExpr() const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
-ir::Expression::ValueType IndexParserDriver::newExpr(const std::string& class_name) const
+ir::Expression::ValueType IndexParserDriver::newExpr(const Name& class_name) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::addExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::subExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::mulExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::divExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::geqExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::gtExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::leqExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::ltExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::eqExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::neqExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::andExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::orExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 ir::Expression::ValueType IndexParserDriver::dotExpr(
 	const ir::Expression::ValueType& e1,
-	const std::string& identifier) const
+	const Name& identifier) const
 {
-	return std::make_shared<DummyExpression>();
+	return _dummy;
 }
 
 std::vector<Instruction::Ptr> IndexParserDriver::call_func(ir::Expression::ValueType func_expr, std::vector<ir::Expression::ValueType>& args) const
@@ -202,7 +215,7 @@ std::vector<Instruction::Ptr> IndexParserDriver::call_func(ir::Expression::Value
 
 Return::Ptr IndexParserDriver::createReturn(const ir::Expression::ValueType& val) const
 {
-	return Return::Ptr(new Return(val));
+	return ir::make<Return>(val);
 }
 
 Instruction::Ptr IndexParserDriver::createIf(
@@ -210,12 +223,12 @@ Instruction::Ptr IndexParserDriver::createIf(
 	const ir::BasicBlock::Ptr& if_block,
 	const ir::BasicBlock::Ptr& else_block) const
 {
-	return DummyInstruction::Ptr(new DummyInstruction);
+	return ir::make<DummyInstruction>();
 }
 
 Instruction::Ptr IndexParserDriver::createWhile(
 	const ir::Expression::ValueType& val,
 	const ir::BasicBlock::Ptr& block) const
 {
-	return DummyInstruction::Ptr(new DummyInstruction);
+	return ir::make<DummyInstruction>();
 }
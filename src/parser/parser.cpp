@@ -3,7 +3,6 @@
  * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
  */
 
-#include <fstream>
 #include <stdexcept>
 #include <variant>
 
@@ -12,45 +11,46 @@
 using namespace vypcomp;
 using namespace std::string_literals;
 
-SymbolTable initSymbolTable()
+SymbolTable initSymbolTable(ir::Arena::Ptr arena)
 {
-	auto table = SymbolTable(true);
-	auto object = ir::Class::Ptr(new ir::Class("Object", nullptr));
+	ir::Arena::Scope scope(arena.get());
+	auto table = SymbolTable(true, arena);
+	auto object = ir::make<ir::Class>("Object", nullptr);
 	table.insert({ "Object", object });
 	// Object built-in functions
 	// string toString(void)
 	{
-		auto toString_fn = Function::Ptr(new Function(Function::Signature(
+		auto toString_fn = ir::make<Function>(Function::Signature(
 			PrimitiveDatatype::String,
 			std::string("toString"),
 			Arglist{ {
 				std::make_pair(Datatype(object->name()), "this"s),
 			} }
-		)));
+		));
 		object->add(toString_fn);
 	}
 	// string getClass(void)
 	{
-		auto getClass_fn = Function::Ptr(new Function(Function::Signature(
+		auto getClass_fn = ir::make<Function>(Function::Signature(
 			PrimitiveDatatype::String,
 			std::string("getClass"),
 			Arglist{ {
 				std::make_pair(Datatype(object->name()), "this"s),
 			} }
-		)));
+		));
 		object->add(getClass_fn);
 	}
 	
 	// free built-in functions
 	// int readInt(void)
-	table.insert({ "readInt", std::make_shared<ir::Function>(std::make_tuple(Datatype(PrimitiveDatatype::Int), "readInt", Arglist())) });
+	table.insert({ "readInt", ir::make<ir::Function>(std::make_tuple(Datatype(PrimitiveDatatype::Int), "readInt", Arglist())) });
 	// int readFloat(void)
-	table.insert({ "readFloat", std::make_shared<ir::Function>(std::make_tuple(Datatype(PrimitiveDatatype::Float), "readFloat", Arglist())) });
+	table.insert({ "readFloat", ir::make<ir::Function>(std::make_tuple(Datatype(PrimitiveDatatype::Float), "readFloat", Arglist())) });
 	// string readString(void)
-	table.insert({ "readString", std::make_shared<ir::Function>(std::make_tuple(Datatype(PrimitiveDatatype::String), "readString", Arglist())) });
+	table.insert({ "readString", ir::make<ir::Function>(std::make_tuple(Datatype(PrimitiveDatatype::String), "readString", Arglist())) });
 	// int length(string s)
-	table.insert({ "length", std::make_shared<ir::Function>(std::make_tuple(Datatype(PrimitiveDatatype::Int), std::string("length"), Arglist{ std::make_pair(Datatype(PrimitiveDatatype::String), "s")} )) });
-	auto subStr_ptr = std::make_shared<ir::Function>(Function::Signature(
+	table.insert({ "length", ir::make<ir::Function>(std::make_tuple(Datatype(PrimitiveDatatype::Int), std::string("length"), Arglist{ std::make_pair(Datatype(PrimitiveDatatype::String), "s")} )) });
+	auto subStr_ptr = ir::make<ir::Function>(Function::Signature(
 		PrimitiveDatatype::String, 
 		std::string("subStr"), 
 		Arglist{ { 
@@ -62,18 +62,23 @@ SymbolTable initSymbolTable()
 	// string subStr(string s, int i, int n)
 	table.insert({ "subStr", subStr_ptr });
 	// void print(PrimitiveDatatype i, ...)
-	table.insert({ "print", std::make_shared<ir::Function>(std::make_tuple(std::nullopt, "print", Arglist())) }); // a special one handled differently in parser
+	table.insert({ "print", ir::make<ir::Function>(std::make_tuple(std::nullopt, "print", Arglist())) }); // a special one handled differently in parser
 	return table;
 }
 
-ParserDriver::ParserDriver()
+ParserDriver::ParserDriver():
+	ParserDriver(std::make_shared<ir::Arena>())
 {
-	_tables.push_back(initSymbolTable());
 }
 
-ParserDriver::ParserDriver(const SymbolTable& global)
+ParserDriver::ParserDriver(ir::Arena::Ptr arena):
+	_symbols(initSymbolTable(arena))
+{
+}
+
+ParserDriver::ParserDriver(const SymbolTable& global):
+	_symbols(global)
 {
-	_tables.push_back(global);
 }
 
 ParserDriver::~ParserDriver()
@@ -82,11 +87,15 @@ ParserDriver::~ParserDriver()
 
 const SymbolTable& ParserDriver::table() const
 {
-	// First table is global.
-	return _tables[0];
+	return _symbols.global();
+}
+
+ir::Arena* ParserDriver::arena() const
+{
+	return table().arena().get();
 }
 
-Class::Ptr ParserDriver::getClass(const std::string &name) const
+Class::Ptr ParserDriver::getClass(const Name& name) const
 {
 	if (auto symbol = searchTables(name)) {
 		if (!std::holds_alternative<Class::Ptr>(*symbol)) {
@@ -105,16 +114,29 @@ Class::Ptr ParserDriver::getClass(const std::string &name) const
 
 void ParserDriver::parse(const std::string &filename)
 {
-	std::ifstream input(filename);
-	if (!input.good())
-		throw std::runtime_error("invalid file: "+filename);
-
-	parse(input);
+	parse(Source::map(filename));
 }
 
 void ParserDriver::parse(std::istream &file)
 {
-	_scanner = std::unique_ptr<Scanner>(new vypcomp::Scanner(file, Parser::token::PROGRAM_START) );
+	parse(Source::read(file));
+}
+
+void ParserDriver::parse(const Source::Ptr &source)
+{
+	ir::Arena::Scope scope(arena());
+	_scanner = std::unique_ptr<Scanner>(new vypcomp::Scanner(source, Parser::token::PROGRAM_START) );
+	_parser = std::unique_ptr<Parser>(new vypcomp::Parser(*_scanner, this));
+
+	if (int err = _parser->parse()) {
+		throw SyntaxError("parser returned: "+std::to_string(err));
+	}
+}
+
+void ParserDriver::parse(const TokenBuffer &tokens)
+{
+	ir::Arena::Scope scope(arena());
+	_scanner = std::unique_ptr<Scanner>(new vypcomp::Scanner(tokens, Parser::token::PROGRAM_START) );
 	_parser = std::unique_ptr<Parser>(new vypcomp::Parser(*_scanner, this));
 
 	if (int err = _parser->parse()) {
@@ -122,8 +144,14 @@ void ParserDriver::parse(std::istream &file)
 	}
 }
 
+TokenBuffer ParserDriver::scan(const std::string &filename)
+{
+	return Scanner::scanAll(Source::map(filename));
+}
+
 void ParserDriver::parseExpression(std::istream& file, bool debug_on)
 {
+	ir::Arena::Scope scope(arena());
 	_scanner = std::unique_ptr<Scanner>(new vypcomp::Scanner(file, Parser::token::EXPR_PARSE_START));
 	_parser = std::unique_ptr<Parser>(new vypcomp::Parser(*_scanner, this));
 	if (debug_on)
@@ -136,7 +164,7 @@ void ParserDriver::parseExpression(std::istream& file, bool debug_on)
 
 void ParserDriver::parseStart(ir::Function::Ptr fun)
 {
-	_tables.back().insert({fun->name(), fun});
+	_symbols.insert({fun->name(), fun});
 
 	pushSymbolTable();
 	for (auto arg: fun->args()) {
@@ -147,8 +175,8 @@ void ParserDriver::parseStart(ir::Function::Ptr fun)
 	if (_currClass) {
 		auto& args = fun->args();
 		if (args.size() == 0 || (args.front()->name() != "this")) {
-			auto thisArg = AllocaInstruction::Ptr(new AllocaInstruction({
-						Datatype(_currClass->name()), "this"}));
+			auto thisArg = ir::make<AllocaInstruction>(Declaration{
+						Datatype(_currClass->name()), "this"});
 			args.insert(args.begin(), thisArg);
 		}
 
@@ -181,32 +209,32 @@ void ParserDriver::parseStart(ir::Function::Ptr fun)
 
 void ParserDriver::parseStart(ir::Class::Ptr cl)
 {
-	_tables.back().insert({cl->name(), cl});
+	_symbols.insert({cl->name(), cl});
 	pushSymbolTable(true);
 	_currClass = cl;
 
 	cl->clear();
 	for (auto a: cl->publicMethods()) {
-		_tables.back().insert({a->name(), a});
+		_symbols.insert({a->name(), a});
 	}
 	for (auto a: cl->privateMethods()) {
-		_tables.back().insert({a->name(), a});
+		_symbols.insert({a->name(), a});
 	}
 	for (auto a: cl->protectedMethods()) {
-		_tables.back().insert({a->name(), a});
+		_symbols.insert({a->name(), a});
 	}
 	for (auto a: cl->publicAttributes()) {
-		_tables.back().insert({a->name(), a});
+		_symbols.insert({a->name(), a});
 	}
 	for (auto a: cl->privateAttributes()) {
-		_tables.back().insert({a->name(), a});
+		_symbols.insert({a->name(), a});
 	}
 	for (auto a: cl->protectedAttributes()) {
-		_tables.back().insert({a->name(), a});
+		_symbols.insert({a->name(), a});
 	}
 }
 
-Class::Ptr ParserDriver::newClass(const std::string &name, const std::string& base) const
+Class::Ptr ParserDriver::newClass(const Name& name, const Name& base) const
 {
         if (auto symbol = searchGlobal(name)) {
 		if (!std::holds_alternative<Class::Ptr>(*symbol))
@@ -225,7 +253,7 @@ Class::Ptr ParserDriver::newClass(const std::string &name, const std::string& ba
 		return cl;
         }
 
-	return Class::Ptr(new Class(name, getClass(base)));
+	return ir::make<Class>(name, getClass(base));
 }
 
 Function::Ptr ParserDriver::newFunction(const ir::Function::Signature& sig) const
@@ -240,20 +268,20 @@ Function::Ptr ParserDriver::newFunction(const ir::Function::Signature& sig) cons
 		return fun;
         }
 
-        return Function::Ptr(new Function({type, name, args}));
+        return ir::make<Function>(Function::Signature{type, name, args});
 }
 
 Instruction::Ptr ParserDriver::assign(ir::Expression::ValueType dest_expr,
                        const ir::Expression::ValueType &val) const
 {
-		std::string name;
-		if (auto symbexp = std::dynamic_pointer_cast<SymbolExpression>(dest_expr))
+		Name name;
+		if (auto symbexp = ir::as<SymbolExpression>(dest_expr))
 		{
 			name = symbexp->getValue()->name();
 		}
-		else if (auto obj_attr = std::dynamic_pointer_cast<ObjectAttributeExpression>(dest_expr))
+		else if (auto obj_attr = ir::as<ObjectAttributeExpression>(dest_expr))
 		{
-			return std::make_shared<ObjectAssignment>(dest_expr, val);
+			return ir::make<ObjectAssignment>(dest_expr, val);
 		}
 		else
 		{
@@ -277,7 +305,7 @@ Instruction::Ptr ParserDriver::assign(ir::Expression::ValueType dest_expr,
 	throw SemanticError("Assignment to undefined variable "+name);
 }
 
-Instruction::Ptr ParserDriver::assign(const std::string& name,
+Instruction::Ptr ParserDriver::assign(const Name& name,
 	const ir::Expression::ValueType& val) const
 {
 	if (auto symbol = searchTables(name)) {
@@ -325,7 +353,8 @@ void ParserDriver::checkAssignmentTypes(const Datatype& dest_type, const Datatyp
 void ParserDriver::checkArgTypes(const Function::Ptr& function_ptr, const FunctionExpression::ArgExpressions& real_args) const
 {
 	// function object was found, verify arguments
-	if (function_ptr->name() == "print")
+	static const Name print("print");
+	if (function_ptr->name() == print)
 	{
 		if (real_args.size() < 1) throw SemanticError("print has to have at least 1 parameter");
 		for (const ir::Expression::ValueType& argument : real_args)
@@ -344,24 +373,22 @@ void ParserDriver::checkArgTypes(const Function::Ptr& function_ptr, const Functi
 
 		for (std::size_t i = 0; i < real_args.size(); i++)
 		{
-			auto formal_type = function_ptr->argTypes()[i];
-			auto actual_type = real_args[i]->type();
-			checkAssignmentTypes(formal_type, actual_type);
+			checkAssignmentTypes(function_ptr->args()[i]->type(), real_args[i]->type());
 		}
 	}
 }
 
 std::vector<Instruction::Ptr> ParserDriver::call_func(ir::Expression::ValueType func_expr, std::vector<ir::Expression::ValueType>& args) const
 {
-	std::string name;
+	Name name;
 	Function::Ptr function;
-	if (auto methodexp = std::dynamic_pointer_cast<MethodExpression>(func_expr))
+	if (auto methodexp = ir::as<MethodExpression>(func_expr))
 	{
 		function = methodexp->getFunction();
 		// push the preceding expression as the implicit `this` argument
 		args.insert(args.begin(), methodexp->getContextObj());
 	}
-	else if (auto funcexp = std::dynamic_pointer_cast<FunctionExpression>(func_expr))
+	else if (auto funcexp = ir::as<FunctionExpression>(func_expr))
 	{
 		name = funcexp->getFunction()->name();
 		auto search_result = searchTables(name);
@@ -386,10 +413,10 @@ std::vector<Instruction::Ptr> ParserDriver::call_func(ir::Expression::ValueType
 	{
 		throw SyntaxError("Only function or assignment allowed on statement level, got: " + func_expr->to_string());
 	}
-	auto funcexp = std::dynamic_pointer_cast<FunctionExpression>(func_expr);
+	auto funcexp = ir::as<FunctionExpression>(func_expr);
 	checkArgTypes(funcexp->getFunction(), args);
 	funcexp->setArgs(args);
-	return { std::make_shared<Assignment>(nullptr, func_expr) };
+	return { ir::make<Assignment>(nullptr, func_expr) };
 }
 
 Instruction::Ptr ParserDriver::createIf(
@@ -399,7 +426,7 @@ Instruction::Ptr ParserDriver::createIf(
 {
 	if (val->type() != Datatype(PrimitiveDatatype::Int) && !val->type().is<Datatype::ClassName>())
 		throw IncompabilityError("Expression in if statement has to be either int or object type.");
-	return BranchInstruction::Ptr(new BranchInstruction(val, if_block, else_block));
+	return ir::make<BranchInstruction>(val, if_block, else_block);
 }
 
 Instruction::Ptr ParserDriver::createWhile(
@@ -408,7 +435,7 @@ Instruction::Ptr ParserDriver::createWhile(
 {
 	if (val->type() != Datatype(PrimitiveDatatype::Int) && !val->type().is<Datatype::ClassName>())
 		throw IncompabilityError("Expression in while statement has to be either int or object type.");
-	return LoopInstruction::Ptr(new LoopInstruction(val, block));
+	return ir::make<LoopInstruction>(val, block);
 }
 
 
@@ -421,7 +448,7 @@ Return::Ptr ParserDriver::createReturn(const ir::Expression::ValueType& val) con
 	if (val == nullptr) {
 		if (!_currFunction->isVoid())
 			throw IncompabilityError("Invalid return for function "+_currFunction->name()+" with type: "+_currFunction->type()->to_string());
-		return Return::Ptr(new Return());
+		return ir::make<Return>();
 	}
 	else if (_currFunction->isVoid()) {
 		throw IncompabilityError("Returning non-void expression from function that is void.");
@@ -429,7 +456,7 @@ Return::Ptr ParserDriver::createReturn(const ir::Expression::ValueType& val) con
 
 	checkAssignmentTypes(*_currFunction->type(), val->type());
 
-	return Return::Ptr(new Return(val));
+	return ir::make<Return>(val);
 }
 
 Expression::ValueType ParserDriver::createCastExpr(const Datatype& dest_datatype, Expression::ValueType expr) const
@@ -444,11 +471,11 @@ Expression::ValueType ParserDriver::createCastExpr(const Datatype& dest_datatype
 		if (!target_search_result) throw SemanticError("Target class " + class_name + " does not exist for cast expression.");
 		if (!std::holds_alternative<Class::Ptr>(target_search_result.value())) throw SemanticError("Target class name " + class_name + " is not a class in cast expression.");
 		auto class_ptr = std::get<Class::Ptr>(target_search_result.value());
-		return std::make_shared<ObjectCastExpression>(class_ptr, expr);
+		return ir::make<ObjectCastExpression>(class_ptr, expr);
 	}
 	else
 	{
-		return std::make_shared<StringCastExpression>(expr);
+		return ir::make<StringCastExpression>(expr);
 	}
 }
 
@@ -468,10 +495,10 @@ void ParserDriver::verify(const ir::AllocaInstruction::Ptr& decl) const
 void ParserDriver::add(const AllocaInstruction::Ptr& decl)
 {
 	verify(decl);
-	_tables.back().insert({decl->name(), decl});
+	_symbols.insert({decl->name(), decl});
 }
 
-ir::AllocaInstruction::Ptr ParserDriver::newDeclaration(const Datatype& t, const std::string& id)
+ir::AllocaInstruction::Ptr ParserDriver::newDeclaration(const Datatype& t, const Name& id)
 {
 	if (auto symbol = searchCurrent(id)) {
 		if (!std::holds_alternative<AllocaInstruction::Ptr>(*symbol))
@@ -482,8 +509,8 @@ ir::AllocaInstruction::Ptr ParserDriver::newDeclaration(const Datatype& t, const
 		return al;
 	}
 
-	auto decl = AllocaInstruction::Ptr(new AllocaInstruction({t, id}));
-	_tables.back().insert({decl->name(), decl});
+	auto decl = ir::make<AllocaInstruction>(Declaration{t, id});
+	_symbols.insert({decl->name(), decl});
 	return decl;
 }
 
@@ -508,16 +535,16 @@ void ParserDriver::ensureMainDefined() const
 
 void ParserDriver::pushSymbolTable(bool storeFunctions)
 {
-	_tables.push_back(SymbolTable(storeFunctions));
+	_symbols.push(storeFunctions);
 }
 
 void ParserDriver::popSymbolTable()
 {
 	// We must preserve global table.
-	if (_tables.size() <= 1)
+	if (_symbols.depth() == 0)
 		return;
 
-	_tables.pop_back();
+	_symbols.pop();
 }
 
 void ParserDriver::parseClassEnd()
@@ -525,6 +552,7 @@ void ParserDriver::parseClassEnd()
 	if (_currClass == nullptr)
 		throw std::runtime_error("Invalid usage of parseClassEnd");
 
+	_currClass->resolveMethods();
 	popSymbolTable();
 	_currClass = nullptr;
 }
@@ -540,26 +568,24 @@ void ParserDriver::parseFunctionEnd()
 
 std::optional<SymbolTable::Symbol> ParserDriver::searchTables(const SymbolTable::Key& key) const
 {
-	for (auto it = _tables.rbegin(); it != _tables.rend(); ++it) {
-		if (it->has(key))
-			return it->get(key);
-	}
+	if (auto symbol = _symbols.find(key))
+		return *symbol;
 
 	return {};
 }
 
 std::optional<SymbolTable::Symbol> ParserDriver::searchGlobal(const SymbolTable::Key& key) const
 {
-	if (_tables[0].has(key))
-		return _tables[0].get(key);
+	if (auto symbol = _symbols.findGlobal(key))
+		return *symbol;
 
 	return {};
 }
 
 std::optional<SymbolTable::Symbol> ParserDriver::searchCurrent(const SymbolTable::Key& key) const
 {
-	if (_tables[_tables.size()-1].has(key))
-		return _tables[_tables.size()-1].get(key);
+	if (auto symbol = _symbols.findCurrent(key))
+		return *symbol;
 
 	return {};
 }
@@ -569,7 +595,7 @@ Class::Ptr ParserDriver::getCurrentClass() const
 	return _currClass;
 }
 
-Datatype ParserDriver::customDatatype(const std::string& dt) const
+Datatype ParserDriver::customDatatype(const Name& dt) const
 {
 	if (auto symbol = searchTables(dt)) {
 		if (!std::holds_alternative<Class::Ptr>(*symbol))
@@ -583,7 +609,7 @@ Datatype ParserDriver::customDatatype(const std::string& dt) const
 
 // Expressions
 
-ir::Expression::ValueType ParserDriver::identifierExpr(const std::string& name) const
+ir::Expression::ValueType ParserDriver::identifierExpr(const Name& name) const
 {
 	auto search_result = searchTables(name);
 	if (search_result)
@@ -592,12 +618,12 @@ ir::Expression::ValueType ParserDriver::identifierExpr(const std::string& name)
 		if (std::holds_alternative<AllocaInstruction::Ptr>(symbol))
 		{
 			auto instruction = std::get<AllocaInstruction::Ptr>(symbol);
-			return std::make_shared<SymbolExpression>(instruction);
+			return ir::make<SymbolExpression>(instruction);
 		}
 		else if (std::holds_alternative<Function::Ptr>(symbol))
 		{
 			auto func = std::get<Function::Ptr>(symbol);
-			return std::make_shared<FunctionExpression>(func);
+			return ir::make<FunctionExpression>(func);
 		}
 		else
 		{
@@ -620,12 +646,12 @@ ir::Expression::ValueType ParserDriver::functionCall(
 	}
 	else
 	{
-		if (auto methodexp = dynamic_cast<MethodExpression*>(function_expr.get()))
+		if (auto methodexp = ir::as<MethodExpression>(function_expr.get()))
 		{
 			// push the preceding expression as the implicit `this` argument
 			args.insert(args.begin(), methodexp->getContextObj());
 		}
-		auto function_expr_childptr = dynamic_cast<FunctionExpression*>(function_expr.get());
+		auto function_expr_childptr = ir::as<FunctionExpression>(function_expr.get());
 		checkArgTypes(function_expr_childptr->getFunction(), args);
 		function_expr_childptr->setArgs(args);
 		return function_expr;
@@ -634,7 +660,7 @@ ir::Expression::ValueType ParserDriver::functionCall(
 
 ir::Expression::ValueType ParserDriver::notExpr(const ir::Expression::ValueType& expr) const
 {
-	return std::make_shared<NotExpression>(expr);
+	return ir::make<NotExpression>(expr);
 }
 
 ir::Expression::ValueType ParserDriver::thisExpr() const
@@ -646,7 +672,7 @@ ir::Expression::ValueType ParserDriver::thisExpr() const
 	}
 	else
 	{
-		return std::make_shared<SymbolExpression>(_currFunction->args()[0]);
+		return ir::make<SymbolExpression>(_currFunction->args()[0]);
 	}
 }
 
@@ -666,53 +692,53 @@ ir::Expression::ValueType ParserDriver::superExpr() const
 		}
 		else
 		{
-			return std::make_shared<SuperExpression>(_currFunction->args()[0], current_class);
+			return ir::make<SuperExpression>(_currFunction->args()[0], current_class);
 		}
 	}
 }
 
-ir::Expression::ValueType ParserDriver::newExpr(const std::string& class_name) const
+ir::Expression::ValueType ParserDriver::newExpr(const Name& class_name) const
 {
 	auto search_result = searchTables(class_name);
 	if (!search_result) throw SemanticError("class " + class_name + " in constructor not found.");
 	if (!std::holds_alternative<Class::Ptr>(search_result.value())) throw IncompabilityError("Identifier " + class_name + " is not a class.");
 	auto class_ptr = std::get<Class::Ptr>(search_result.value());
-	return std::make_shared<ConstructorExpression>(class_ptr);
+	return ir::make<ConstructorExpression>(class_ptr);
 }
 
 ir::Expression::ValueType ParserDriver::addExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::AddExpression>(e1, e2);
+	return ir::make<ir::AddExpression>(e1, e2);
 }
 
 ir::Expression::ValueType ParserDriver::subExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::SubtractExpression>(e1, e2);
+	return ir::make<ir::SubtractExpression>(e1, e2);
 }
 
 ir::Expression::ValueType ParserDriver::mulExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::MultiplyExpression>(e1, e2);
+	return ir::make<ir::MultiplyExpression>(e1, e2);
 }
 
 ir::Expression::ValueType ParserDriver::divExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::DivideExpression>(e1, e2);
+	return ir::make<ir::DivideExpression>(e1, e2);
 }
 
 ir::Expression::ValueType ParserDriver::geqExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::ComparisonExpression>(
+	return ir::make<ir::ComparisonExpression>(
 		ComparisonExpression::GEQ, e1, e2
 	);
 }
@@ -721,7 +747,7 @@ ir::Expression::ValueType ParserDriver::gtExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::ComparisonExpression>(
+	return ir::make<ir::ComparisonExpression>(
 		ComparisonExpression::GREATER, e1, e2
 	);
 }
@@ -730,7 +756,7 @@ ir::Expression::ValueType ParserDriver::leqExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::ComparisonExpression>(
+	return ir::make<ir::ComparisonExpression>(
 		ComparisonExpression::LEQ, e1, e2
 	);
 }
@@ -739,7 +765,7 @@ ir::Expression::ValueType ParserDriver::ltExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::ComparisonExpression>(
+	return ir::make<ir::ComparisonExpression>(
 		ComparisonExpression::LESS, e1, e2
 	);
 }
@@ -748,7 +774,7 @@ ir::Expression::ValueType ParserDriver::eqExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::ComparisonExpression>(
+	return ir::make<ir::ComparisonExpression>(
 		ComparisonExpression::EQUALS, e1, e2
 	);
 }
@@ -757,7 +783,7 @@ ir::Expression::ValueType ParserDriver::neqExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::ComparisonExpression>(
+	return ir::make<ir::ComparisonExpression>(
 		ComparisonExpression::NOTEQUALS, e1, e2
 	);
 }
@@ -766,19 +792,19 @@ ir::Expression::ValueType ParserDriver::andExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::AndExpression>(e1, e2);
+	return ir::make<ir::AndExpression>(e1, e2);
 }
 
 ir::Expression::ValueType ParserDriver::orExpr(
 	const ir::Expression::ValueType& e1,
 	const ir::Expression::ValueType& e2) const
 {
-	return std::make_shared<ir::OrExpression>(e1, e2);
+	return ir::make<ir::OrExpression>(e1, e2);
 }
 
 ir::Expression::ValueType ParserDriver::dotExpr(
 	const ir::Expression::ValueType& context_object,
-	const std::string& identifier) const
+	const Name& identifier) const
 {
 	if (!context_object->type().is<ir::Datatype::ClassName>())
 	{
@@ -805,9 +831,9 @@ ir::Expression::ValueType ParserDriver::dotExpr(
 		AllocaInstruction::Ptr attribute = expr_class->getAttribute(identifier, vis);
 		if (attribute)
 		{
-			if (auto context_object_symexp = dynamic_cast<SymbolExpression*>(context_object.get()))
+			if (auto context_object_symexp = ir::as<SymbolExpression>(context_object.get()))
 			{
-				return std::make_shared<ObjectAttributeExpression>(context_object_symexp->getValue(), attribute, expr_class);
+				return ir::make<ObjectAttributeExpression>(context_object_symexp->getValue(), attribute, expr_class);
 			}
 			else
 			{
@@ -820,7 +846,7 @@ ir::Expression::ValueType ParserDriver::dotExpr(
 			Function::Ptr method = expr_class->getMethod(identifier, vis);
 			if (method)
 			{
-				return std::make_shared<MethodExpression>(method, context_object);
+				return ir::make<MethodExpression>(method, context_object);
 			}
 			else
 			{
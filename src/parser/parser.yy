@@ -23,6 +23,7 @@
 	#include <iostream>
 	#include <variant>
 	#include <string>
+	#include <string_view>
 	#include <utility>
 
 	#include "vypcomp/ir/expression.h"
@@ -41,6 +42,8 @@
 	 */
 	using TokenImpl = std::variant<
 		std::string,
+		std::string_view,
+		Name,
 		unsigned long long,
 		double,
 		PrimitiveDatatype,
@@ -51,13 +54,13 @@
 		Instruction::Ptr,
 		OptLiteral,
 		std::vector<Instruction::Ptr>,
-		std::vector<std::pair<std::string, Expression::ValueType>>,
+		std::vector<std::pair<Name, Expression::ValueType>>,
 		BasicBlock::Ptr,
 		Function::Ptr,
 		Class::Ptr,
 		Expression::ValueType,
 		std::vector<std::shared_ptr<Expression>>,
-		std::optional<std::pair<Datatype, std::string>>
+		std::optional<std::pair<Datatype, Name>>
 	>;
 
 	/**
@@ -165,9 +168,9 @@
 
 %token <terminal<PrimitiveDatatype>()> PRIMITIVE_DATA_TYPE
 
-%token <terminal<std::string>()>IDENTIFIER
+%token <terminal<Name>()>IDENTIFIER
 
-%token <terminal<std::string>()>STRING_LITERAL
+%token <terminal<std::string_view>()>STRING_LITERAL
 %token <terminal<unsigned long long>()>INT_LITERAL
 %token <terminal<double>()>FLOAT_LITERAL
 
@@ -215,11 +218,11 @@
 %nterm <nonterminal<std::vector<Instruction::Ptr>>()> declaration
 %nterm <nonterminal<Instruction::Ptr>()> return
 %nterm <nonterminal<Class::Ptr>()> class_declaration
-%nterm <nonterminal<std::vector<std::pair<std::string, Expression::ValueType>>>()> id2init
+%nterm <nonterminal<std::vector<std::pair<Name, Expression::ValueType>>>()> id2init
 %nterm <nonterminal<std::shared_ptr<Expression>>()> expr
 %nterm <nonterminal<std::shared_ptr<Expression>>()> binary_operation
 %nterm <nonterminal<std::vector<std::shared_ptr<Expression>>>()> func_call_args
-%nterm <nonterminal<std::optional<std::pair<Datatype, std::string>>>()> named_data
+%nterm <nonterminal<std::optional<std::pair<Datatype, Name>>>()> named_data
 
 %%
 
@@ -397,7 +400,7 @@ expr
 	$$ = std::move($2);
 }
 | literal {
-	$$ = std::make_shared<LiteralExpression>($1.value());
+	$$ = ir::make<LiteralExpression>($1.value());
 }
 | expr LPAR func_call_args {
 	$$ = parser->functionCall($1, $3);
@@ -507,7 +510,7 @@ declaration : named_data optional_assignment id2init {
 			result.push_back(parser->assign(id, literal));
 		}
 		else if (decl->type().is<ir::Datatype::ClassName>()) {
-			auto literal = std::make_shared<ir::NullObject>(decl->type().get<ir::Datatype::ClassName>());
+			auto literal = ir::make<ir::NullObject>(decl->type().get<ir::Datatype::ClassName>());
 			result.push_back(parser->assign(id, literal));
 		}
 	}
@@ -534,7 +537,7 @@ optional_assignment : {
 	$$ = $2;
 };
 
-literal : STRING_LITERAL { $$ = Literal($1); }
+literal : STRING_LITERAL { $$ = Literal(std::string($1)); }
 	| INT_LITERAL { $$ = Literal($1); }
 	| FLOAT_LITERAL { $$ = Literal($1); }
 	;
@@ -606,7 +609,7 @@ auto curr = parser->getCurrentClass();
 	if (curr == nullptr)
 		throw std::runtime_error("expected class to be parsed! "+std::to_string(__LINE__));
 	for (auto i: $1) {
-		if (auto var = std::dynamic_pointer_cast<AllocaInstruction>(i)) {
+		if (auto var = ir::as<AllocaInstruction>(i)) {
 			curr->add(var, ir::Class::Visibility::Public);
 		}
 		else {
@@ -620,7 +623,7 @@ auto curr = parser->getCurrentClass();
 	if (curr == nullptr)
 		throw std::runtime_error("expected class to be parsed! "+std::to_string(__LINE__));
 	for (auto i: $2) {
-		if (auto var = std::dynamic_pointer_cast<AllocaInstruction>(i)) {
+		if (auto var = ir::as<AllocaInstruction>(i)) {
 			curr->add(var, ir::Class::Visibility::Public);
 		}
 		else {
@@ -634,7 +637,7 @@ auto curr = parser->getCurrentClass();
 	if (curr == nullptr)
 		throw std::runtime_error("expected class to be parsed! "+std::to_string(__LINE__));
 	for (auto i: $2) {
-		if (auto var = std::dynamic_pointer_cast<AllocaInstruction>(i)) {
+		if (auto var = ir::as<AllocaInstruction>(i)) {
 			curr->add(var, ir::Class::Visibility::Private);
 		}
 		else {
@@ -648,7 +651,7 @@ auto curr = parser->getCurrentClass();
 	if (curr == nullptr)
 		throw std::runtime_error("expected class to be parsed! "+std::to_string(__LINE__));
 	for (auto i: $2) {
-		if (auto var = std::dynamic_pointer_cast<AllocaInstruction>(i)) {
+		if (auto var = ir::as<AllocaInstruction>(i)) {
 			curr->add(var, ir::Class::Visibility::Protected);
 		}
 		else {
@@ -0,0 +1,115 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "vypcomp/parser/scanner.h"
+
+using namespace vypcomp;
+
+// ------------------------------
+// TokenBuffer
+// ------------------------------
+
+void TokenBuffer::push(int kind, const Parser::semantic_type& value, const Parser::location_type& location)
+{
+	_tokens.push_back({kind, value, location});
+}
+
+void TokenBuffer::setError(std::exception_ptr error)
+{
+	_error = error;
+}
+
+void TokenBuffer::setSource(Source::Ptr source)
+{
+	_source = std::move(source);
+}
+
+const std::vector<TokenBuffer::Entry>& TokenBuffer::tokens() const
+{
+	return _tokens;
+}
+
+std::exception_ptr TokenBuffer::error() const
+{
+	return _error;
+}
+
+// ------------------------------
+// Scanner
+// ------------------------------
+
+TokenBuffer Scanner::scanAll(std::istream &in)
+{
+	return scanAll(Source::read(in));
+}
+
+TokenBuffer Scanner::scanAll(Source::Ptr source)
+{
+	TokenBuffer result;
+	result.setSource(source);
+	Scanner scanner(std::move(source));
+	Parser::location_type location;
+
+	try {
+		int token;
+		do {
+			Parser::semantic_type value;
+			token = scanner.scan(&value, &location);
+			result.push(token, value, location);
+		}
+		while (token != Parser::token::END);
+	}
+	catch (...) {
+		// Error is reported once parser reaches it.
+		result.setError(std::current_exception());
+	}
+
+	return result;
+}
+
+int Scanner::yylex(Parser::semantic_type *lval, Parser::location_type *location)
+{
+	if (prepend_first_token) {
+		prepend_first_token = false;
+		return start_token;
+	}
+
+	if (buffer)
+		return replay(lval, location);
+
+	return scan(lval, location);
+}
+
+int Scanner::replay(Parser::semantic_type *lval, Parser::location_type *location)
+{
+	const auto& tokens = buffer->tokens();
+	if (position >= tokens.size()) {
+		if (buffer->error())
+			std::rethrow_exception(buffer->error());
+
+		// Buffer without error always ends with END token.
+		return Parser::token::END;
+	}
+
+	const auto& entry = tokens[position++];
+	*lval = entry.value;
+	*location = entry.location;
+	return entry.kind;
+}
+
+int Scanner::LexerInput(char *buf, int max_size)
+{
+	if (!source)
+		return 0;
+
+	auto text = source->text();
+	auto size = std::min(text.size() - input_offset, static_cast<std::size_t>(max_size));
+	std::memcpy(buf, text.data() + input_offset, size);
+	input_offset += size;
+	return static_cast<int>(size);
+}
@@ -0,0 +1,86 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VYPCOMP_HAS_MMAP
+#endif
+
+#include "vypcomp/parser/source.h"
+
+using namespace vypcomp;
+
+Source::Ptr Source::map(const std::string& filename)
+{
+#ifdef VYPCOMP_HAS_MMAP
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("invalid file: "+filename);
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+		auto size = static_cast<std::size_t>(info.st_size);
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (mapping == MAP_FAILED)
+			throw std::runtime_error("cannot map file: "+filename);
+
+		// Scanner reads the file once from the start to the end.
+		madvise(mapping, size, MADV_SEQUENTIAL);
+
+		std::shared_ptr<Source> result(new Source());
+		result->_mapping = static_cast<const char*>(mapping);
+		result->_mappingSize = size;
+		return result;
+	}
+	close(fd);
+#endif
+
+	std::ifstream input(filename, std::ios::binary);
+	if (!input.good())
+		throw std::runtime_error("invalid file: "+filename);
+
+	return read(input);
+}
+
+Source::Ptr Source::read(std::istream& in)
+{
+	return copy(std::string(std::istreambuf_iterator<char>(in), {}));
+}
+
+Source::Ptr Source::copy(std::string text)
+{
+	std::shared_ptr<Source> result(new Source());
+	result->_text = std::move(text);
+	return result;
+}
+
+Source::~Source()
+{
+#ifdef VYPCOMP_HAS_MMAP
+	if (_mapping)
+		munmap(const_cast<char*>(_mapping), _mappingSize);
+#endif
+}
+
+std::string_view Source::text() const
+{
+	if (_mapping)
+		return std::string_view(_mapping, _mappingSize);
+
+	return _text;
+}
+
+bool Source::mapped() const
+{
+	return _mapping != nullptr;
+}
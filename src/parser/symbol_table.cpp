@@ -4,18 +4,24 @@
  */
 
 #include "vypcomp/parser/symbol_table.h"
+#include <algorithm>
 #include <stdexcept>
 
 using namespace vypcomp;
 
-SymbolTable::SymbolTable(bool storesFunctions):
-	_storesFunctions(storesFunctions)
+// ------------------------------
+// SymbolTable
+// ------------------------------
+
+SymbolTable::SymbolTable(bool storesFunctions, ir::Arena::Ptr arena):
+	_storesFunctions(storesFunctions),
+	_arena(arena)
 {
 }
 
 bool SymbolTable::insert(const std::pair<Key, Symbol>& element)
 {
-	auto [k,v] = element;
+	auto& [k,v] = element;
 	if (!_storesFunctions) {
 		if (std::holds_alternative<ir::Function::Ptr>(v)) {
 			return false;
@@ -27,20 +33,151 @@ bool SymbolTable::insert(const std::pair<Key, Symbol>& element)
         return true;
 }
 
+bool SymbolTable::erase(const Key& key)
+{
+	return _table.erase(key);
+}
+
 bool SymbolTable::has(const Key& symb) const
 {
-	return _table.count(symb);
+	return _table.find(symb) != nullptr;
 }
 
 SymbolTable::Symbol SymbolTable::get(const Key& key) const
 {
-	if (!has(key))
+	auto symbol = _table.find(key);
+	if (symbol == nullptr)
 		throw std::runtime_error("Symbol table does not contain value: "+key);
 
-	return _table.at(key);
+	return *symbol;
+}
+
+const SymbolTable::Symbol* SymbolTable::find(const Key& key) const
+{
+	return _table.find(key);
+}
+
+std::vector<std::pair<SymbolTable::Key, SymbolTable::Symbol>> SymbolTable::data() const
+{
+	std::vector<std::pair<Key, Symbol>> result;
+	result.reserve(_table.size());
+	_table.forEach([&result](const Key& key, const Symbol& symbol) {
+		result.emplace_back(key, symbol);
+	});
+
+	std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+	});
+
+	return result;
+}
+
+bool SymbolTable::storesFunctions() const
+{
+	return _storesFunctions;
+}
+
+ir::Arena::Ptr SymbolTable::arena() const
+{
+	return _arena;
+}
+
+// ------------------------------
+// ScopedSymbolTable
+// ------------------------------
+
+ScopedSymbolTable::ScopedSymbolTable(const SymbolTable& global):
+	_global(global)
+{
+	_scopes.push_back({0, global.storesFunctions()});
+	for (auto& [key, symbol]: global.data()) {
+		_visible[key] = _bindings.size();
+		_bindings.push_back({key, symbol, 0, None});
+	}
+}
+
+const SymbolTable& ScopedSymbolTable::global() const
+{
+	return _global;
+}
+
+void ScopedSymbolTable::push(bool storesFunctions)
+{
+	_scopes.push_back({_bindings.size(), storesFunctions});
+}
+
+void ScopedSymbolTable::pop()
+{
+	if (_scopes.size() <= 1)
+		throw std::runtime_error("Global scope cannot be popped.");
+
+	auto first = _scopes.back().firstBinding;
+	for (auto i = _bindings.size(); i > first; i--) {
+		auto& b = _bindings[i-1];
+		_visible[b.key] = b.shadowed;
+	}
+
+	_bindings.erase(_bindings.begin() + first, _bindings.end());
+	_scopes.pop_back();
+}
+
+std::size_t ScopedSymbolTable::depth() const
+{
+	return _scopes.size() - 1;
+}
+
+bool ScopedSymbolTable::insert(const std::pair<Key, Symbol>& element)
+{
+	auto& [key, symbol] = element;
+	if (!_scopes.back().storesFunctions) {
+		if (std::holds_alternative<ir::Function::Ptr>(symbol)) {
+			return false;
+		}
+	}
+
+	if (depth() == 0)
+		_global.insert(element);
+
+	auto visible = _visible.find(key);
+	if (visible == nullptr) {
+		_visible[key] = _bindings.size();
+		_bindings.push_back({key, symbol, depth(), None});
+		return true;
+	}
+
+	if (*visible != None && _bindings[*visible].scope == depth()) {
+		_bindings[*visible].symbol = symbol;
+		return true;
+	}
+
+	// New binding shadows the visible one until scope is popped.
+	_bindings.push_back({key, symbol, depth(), *visible});
+	*visible = _bindings.size() - 1;
+	return true;
+}
+
+const ScopedSymbolTable::Binding* ScopedSymbolTable::binding(const Key& key) const
+{
+	auto visible = _visible.find(key);
+	if (visible == nullptr || *visible == None)
+		return nullptr;
+
+	return &_bindings[*visible];
+}
+
+const ScopedSymbolTable::Symbol* ScopedSymbolTable::find(const Key& key) const
+{
+	auto b = binding(key);
+	return b ? &b->symbol : nullptr;
+}
+
+const ScopedSymbolTable::Symbol* ScopedSymbolTable::findCurrent(const Key& key) const
+{
+	auto b = binding(key);
+	return b && b->scope == depth() ? &b->symbol : nullptr;
 }
 
-const std::map<SymbolTable::Key, SymbolTable::Symbol>& SymbolTable::data() const
+const ScopedSymbolTable::Symbol* ScopedSymbolTable::findGlobal(const Key& key) const
 {
-	return _table;
+	return _global.find(key);
 }
@@ -3,12 +3,23 @@
  * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
  */
 
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "vypcomp/parser/parser.h"
 #include "vypcomp/parser/indexdriver.h"
+#include "vypcomp/optimizer/optimizer.h"
 #include "vypcomp/generator/generator.h"
+#include "vypcomp/driver/batch.h"
+#include "vypcomp/driver/cache.h"
+#include "vypcomp/driver/report.h"
+#include "vypcomp/driver/server.h"
+#include "vypcomp/ir/name.h"
 
 using namespace vypcomp;
 
@@ -16,9 +27,34 @@ struct Args {
 	std::string inputFile = "";
 	std::string outputFile = "out.vc";
 	bool verbose = false;
+	bool singleScan = false;
+	bool optimize = false;
+	// batch mode compiles every input into file with .vc extension
+	bool batch = false;
+	std::vector<std::string> inputFiles;
+	std::size_t jobs = 0;
+	// serve compilation requests on the unix socket
+	std::string socketPath;
+	// generated code is cached in the directory, verbose runs bypass the cache
+	std::string cacheDirectory;
+	std::uintmax_t cacheLimit = 256*1024*1024;
+	bool cacheStats = false;
+	// phase timing report printed to stderr after single file compilation
+	enum class ReportFormat { None, Text, Json } timeReport = ReportFormat::None;
 
         static std::string usage(const std::string& name) {
-		return name+": [-v|--verbose] FILE [FILE]";
+		return name+": [OPTIONS] FILE [FILE]\n"
+			+name+": [OPTIONS] [-j|--jobs N] (-b|--batch FILE... | -m|--manifest FILE)\n"
+			+name+": [OPTIONS] [-j|--jobs N] --serve SOCKET\n"
+			+"OPTIONS: [-v|--verbose] [-s|--single-scan] [-O|--optimize] [--cache DIR [--cache-limit BYTES] [--cache-stats]] [--time-report[=json]]";
+	}
+
+	static std::string outputFor(const std::string& input) {
+		auto dot = input.rfind('.');
+		auto slash = input.rfind('/');
+		if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+			return input+".vc";
+		return input.substr(0, dot)+".vc";
 	}
 
         static Args parse(int argc, char** argv) {
@@ -27,9 +63,47 @@ struct Args {
 			throw std::runtime_error("expected arguments\n"+ Args::usage(std::string(argv[0])));
 
 		int base = 1;
-		if (std::string(argv[1]) == "-v" || std::string(argv[1]) == "--verbose") {
-			args.verbose = true;
-			base = 2;
+		for (; base < argc; base++) {
+			std::string opt(argv[base]);
+			if (opt == "-v" || opt == "--verbose")
+				args.verbose = true;
+			else if (opt == "-s" || opt == "--single-scan")
+				args.singleScan = true;
+			else if (opt == "-O" || opt == "--optimize")
+				args.optimize = true;
+			else if (opt == "-b" || opt == "--batch")
+				args.batch = true;
+			else if ((opt == "-m" || opt == "--manifest") && base+1 < argc) {
+				args.batch = true;
+				auto listed = readManifest(argv[++base]);
+				args.inputFiles.insert(args.inputFiles.end(), listed.begin(), listed.end());
+			}
+			else if ((opt == "-j" || opt == "--jobs") && base+1 < argc)
+				args.jobs = std::stoul(argv[++base]);
+			else if (opt == "--serve" && base+1 < argc)
+				args.socketPath = argv[++base];
+			else if (opt == "--cache" && base+1 < argc)
+				args.cacheDirectory = argv[++base];
+			else if (opt == "--cache-limit" && base+1 < argc)
+				args.cacheLimit = std::stoull(argv[++base]);
+			else if (opt == "--cache-stats")
+				args.cacheStats = true;
+			else if (opt == "--time-report")
+				args.timeReport = ReportFormat::Text;
+			else if (opt == "--time-report=json")
+				args.timeReport = ReportFormat::Json;
+			else
+				break;
+		}
+
+		if (!args.socketPath.empty())
+			return args;
+
+		if (args.batch) {
+			args.inputFiles.insert(args.inputFiles.end(), argv+base, argv+argc);
+			if (args.inputFiles.empty())
+				throw std::runtime_error("no input files\n"+Args::usage(std::string(argv[0])));
+			return args;
 		}
 
 		if (argc < base+1)
@@ -42,44 +116,252 @@ struct Args {
 	}
 };
 
-int main(int argc, char** argv)
+/**
+ * Prints exception being handled and returns exit code matching its
+ * category.
+ */
+int reportError(std::ostream& err)
 {
 	try {
-		auto args = Args::parse(argc, argv);
+		throw;
+	} catch (const LexicalError &le) {
+		err << "lexical error: " << le.what() << std::endl;
+		return 11;
+	} catch (const SyntaxError &pe) {
+		err << "syntax error: " << pe.what() << std::endl;
+		return 12;
+	} catch (const IncompabilityError &pe) {
+		err << "semantic error: " << pe.what() << std::endl;
+		return 13;
+	} catch (const SemanticError &pe) {
+		err << "semantic error: " << pe.what() << std::endl;
+		return 14;
+	} catch (const std::exception &e) {
+		err << "error: " << e.what() << std::endl;
+		return 19;
+	}
+}
+
+/**
+ * Compiles program of the source. Output is opened only after the
+ * program is successfully parsed. Debug output goes to out, error
+ * messages to err. Returns exit code of the compilation. Phases are
+ * measured into report if given.
+ */
+int compile(const Args& args, const Source::Ptr& source, const std::function<std::unique_ptr<std::ostream>()>& output,
+		std::size_t generatorThreads, std::ostream& out, std::ostream& err, TimeReport* report = nullptr)
+{
+	try {
+		// In single scan mode input is scanned once and both
+		// runs consume same tokens.
+		TokenBuffer tokens;
+		if (args.singleScan) {
+			TimeReport::Phase phase(report, "scan");
+			tokens = Scanner::scanAll(source);
+		}
+
 		IndexParserDriver indexRun;
-		indexRun.parse(args.inputFile);
+		{
+			TimeReport::Phase phase(report, "index run");
+			if (args.singleScan)
+				indexRun.parse(tokens);
+			else
+				indexRun.parse(source);
+		}
+
 		ParserDriver parser(indexRun.table());
-		parser.parse(args.inputFile);
+		{
+			TimeReport::Phase phase(report, "parse");
+			if (args.singleScan)
+				parser.parse(tokens);
+			else
+				parser.parse(source);
+		}
+
+		auto table = parser.table();
+		if (args.optimize) {
+			TimeReport::Phase phase(report, "optimize");
+			Optimizer().run(table);
+		}
 
 		// Debug: print intermediet representation to the
 		// stdout.
 		if (args.verbose) {
-			for (auto [_, v]: parser.table().data()) {
-				std::visit([](auto&& arg) {
-					std::cout << arg->str("");
+			for (auto [_, v]: table.data()) {
+				std::visit([&out](auto&& arg) {
+					out << arg->str("");
 				}, v);
-				std::cout << std::endl;
+				out << std::endl;
 			}
 		}
 
-		Generator gen(args.outputFile, args.verbose);
-		gen.generate(parser.table());
-	} catch (const LexicalError &le) {
-		std::cerr << "lexical error: " << le.what() << std::endl;
-		return 11;
-	} catch (const SyntaxError &pe) {
-		std::cerr << "syntax error: " << pe.what() << std::endl;
-		return 12;
-	} catch (const IncompabilityError &pe) {
-		std::cerr << "semantic error: " << pe.what() << std::endl;
-		return 13;
-	} catch (const SemanticError &pe) {
-		std::cerr << "semantic error: " << pe.what() << std::endl;
-		return 14;
+		TimeReport::Phase phase(report, "generate");
+		Generator gen(output(), args.verbose, args.optimize, generatorThreads);
+		gen.generate(table);
+	} catch (...) {
+		return reportError(err);
+	}
+
+	return 0;
+}
+
+/**
+ * Looks the source up in the cache, compiles it on a miss. Only
+ * successful compilations are cached.
+ */
+int compileCached(const Args& args, Cache& cache, const Source::Ptr& source, std::string& code,
+		std::size_t generatorThreads, std::ostream& out, std::ostream& err, TimeReport* report = nullptr)
+{
+	std::string key;
+	{
+		TimeReport::Phase phase(report, "cache");
+		key = cache.key(source->text());
+		if (auto cached = cache.load(key)) {
+			code = std::move(*cached);
+			return 0;
+		}
+	}
+
+	std::stringbuf generated;
+	auto result = compile(args, source, [&generated]() {
+		return std::make_unique<std::ostream>(&generated);
+	}, generatorThreads, out, err, report);
+	if (result != 0)
+		return result;
+
+	TimeReport::Phase phase(report, "cache store");
+	code = generated.str();
+	cache.store(key, code);
+	return 0;
+}
+
+int compileFile(const Args& args, Cache* cache, const std::string& inputFile, const std::string& outputFile,
+		std::size_t generatorThreads, std::ostream& out, std::ostream& err, TimeReport* report = nullptr)
+{
+	// Input file is mapped into memory, tokens refer to it directly.
+	Source::Ptr source;
+	try {
+		source = Source::map(inputFile);
+	} catch (const std::exception &e) {
+		err << "error: " << e.what() << std::endl;
+		return 19;
+	}
+
+	if (!cache) {
+		return compile(args, source, [&outputFile]() {
+			return std::make_unique<std::ofstream>(outputFile);
+		}, generatorThreads, out, err, report);
+	}
+
+	std::string code;
+	auto result = compileCached(args, *cache, source, code, generatorThreads, out, err, report);
+	if (result == 0)
+		std::ofstream(outputFile) << code;
+	return result;
+}
+
+/**
+ * Distinct names interned by server worker process before it is
+ * replaced, roughly 100 MiB of memory.
+ */
+const std::size_t ServerNameLimit = 1024*1024;
+
+/**
+ * Compiles source received by the server.
+ */
+int compileSource(const Args& args, Cache* cache, const std::string& source, std::ostream& code, std::ostream& errors)
+{
+	// debug output is not sent to clients
+	std::ostream discard(nullptr);
+	auto input = Source::copy(source);
+	// requests are compiled in parallel already
+	if (cache) {
+		std::string cached;
+		auto result = compileCached(args, *cache, input, cached, 1, discard, errors);
+		code << cached;
+		return result;
+	}
+
+	return compile(args, input, [&code]() {
+		return std::make_unique<std::ostream>(code.rdbuf());
+	}, 1, discard, errors);
+}
+
+/**
+ * Identifies the compiler binary and options that affect generated
+ * code, so that cached code is not reused by different compiler.
+ */
+std::string configuration(const Args& args, const std::string& executable)
+{
+	std::error_code error;
+	std::filesystem::path self("/proc/self/exe");
+	if (!std::filesystem::exists(self, error))
+		self = executable;
+	return Cache::hashFile(self)+(args.optimize ? " -O" : "");
+}
+
+/**
+ * Compiles all inputs of the batch, see vypcomp::compileBatch.
+ */
+int compileBatch(const Args& args, Cache* cache)
+{
+	auto result = compileBatch(args.inputFiles, args.jobs, [&args, cache](const std::string& input, std::ostream& out, std::ostream& err) {
+		// files are compiled in parallel already
+		return compileFile(args, cache, input, Args::outputFor(input), 1, out, err);
+	}, std::cout, std::cerr);
+	if (cache)
+		cache->report(std::cerr);
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	Args args;
+	try {
+		args = Args::parse(argc, argv);
 	} catch (const std::exception &e) {
 		std::cerr << "error: " << e.what() << std::endl;
 		return 19;
 	}
 
-	return 0;
+	std::unique_ptr<Cache> cache;
+	if (!args.cacheDirectory.empty() && !args.verbose) {
+		try {
+			cache = std::make_unique<Cache>(args.cacheDirectory, args.cacheLimit, configuration(args, argv[0]));
+		} catch (...) {
+			return reportError(std::cerr);
+		}
+	}
+
+	if (args.batch)
+		return compileBatch(args, cache.get());
+
+	if (!args.socketPath.empty()) {
+		try {
+			Server server(args.socketPath, [&args, &cache](const std::string& source, std::ostream& code, std::ostream& errors) {
+				return compileSource(args, cache.get(), source, code, errors);
+			}, args.jobs, []() {
+				// interned names are never released
+				return ir::Name::interned() > ServerNameLimit;
+			});
+			server.run();
+		} catch (...) {
+			return reportError(std::cerr);
+		}
+		return 0;
+	}
+
+	// phases of batch and server compilations overlap, so the report
+	// is available only for single file
+	TimeReport timeReport;
+	auto report = args.timeReport != Args::ReportFormat::None ? &timeReport : nullptr;
+	auto result = compileFile(args, cache.get(), args.inputFile, args.outputFile, 0, std::cout, std::cerr, report);
+	if (cache && args.cacheStats)
+		cache->report(std::cerr);
+	if (args.timeReport == Args::ReportFormat::Text)
+		timeReport.print(std::cerr);
+	else if (args.timeReport == Args::ReportFormat::Json)
+		timeReport.printJson(std::cerr);
+	return result;
 }
@@ -0,0 +1,76 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "vypcomp/interpreter/interpreter.h"
+#include "vypcomp/interpreter/program.h"
+
+using namespace vypcomp::vypcode;
+
+struct Args {
+	std::string inputFile = "";
+	bool stats = false;
+
+        static std::string usage(const std::string& name) {
+		return name+": [-s|--stats] FILE";
+	}
+
+        static Args parse(int argc, char** argv) {
+		Args args;
+		int base = 1;
+		for (; base < argc; base++) {
+			std::string opt(argv[base]);
+			if (opt == "-s" || opt == "--stats")
+				args.stats = true;
+			else
+				break;
+		}
+
+		if (argc != base+1)
+			throw std::runtime_error("invalid arguments\n"+Args::usage(std::string(argv[0])));
+
+		args.inputFile = argv[base];
+		return args;
+	}
+};
+
+int main(int argc, char** argv)
+{
+	std::ios::sync_with_stdio(false);
+
+	try {
+		auto args = Args::parse(argc, argv);
+		auto program = Program::load(args.inputFile);
+
+		Interpreter interpreter(program, std::cin, std::cout);
+		auto start = std::chrono::steady_clock::now();
+		interpreter.run();
+		auto end = std::chrono::steady_clock::now();
+
+		// Statistics go to stderr so that output of the program
+		// is not affected.
+		if (args.stats) {
+			std::chrono::duration<double, std::milli> elapsed = end - start;
+			std::cerr << "instructions: " << program.code().size()-1 << std::endl
+				<< "executed: " << interpreter.executed() << std::endl
+				<< "time: " << elapsed.count() << " ms" << std::endl;
+		}
+	} catch (const LoadError &le) {
+		std::cerr << "load error: " << le.what() << std::endl;
+		return 20;
+	} catch (const RuntimeError &re) {
+		std::cout.flush();
+		std::cerr << "runtime error: " << re.what() << std::endl;
+		return 28;
+	} catch (const std::exception &e) {
+		std::cerr << "error: " << e.what() << std::endl;
+		return 29;
+	}
+
+	return 0;
+}
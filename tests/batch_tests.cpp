@@ -0,0 +1,100 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "vypcomp/driver/batch.h"
+
+using namespace ::testing;
+
+using namespace vypcomp;
+
+class BatchTests : public Test {
+protected:
+	// compiles inputs of the batch by fake compiler returning exit codes of inputs
+	int compile(const std::vector<std::string>& inputs, std::size_t jobs)
+	{
+		return compileBatch(inputs, jobs, [this](const std::string& input, std::ostream& out, std::ostream& err) {
+			// inputs may finish in other order than they are listed
+			std::this_thread::sleep_for(std::chrono::milliseconds(10*value(delays, input)));
+			out << "code of " << input << "\n";
+			auto code = value(codes, input);
+			if (code != 0)
+				err << "error of " << input << "\nsecond line\n";
+			return code;
+		}, out, err);
+	}
+
+	// workers only read the maps
+	static int value(const std::map<std::string, int>& values, const std::string& input)
+	{
+		auto result = values.find(input);
+		return result == values.end() ? 0 : result->second;
+	}
+
+	std::map<std::string, int> codes;
+	std::map<std::string, int> delays;
+	std::ostringstream out;
+	std::ostringstream err;
+};
+
+TEST_F(BatchTests, readsManifestSkippingCommentsAndBlankLines)
+{
+	auto path = std::filesystem::temp_directory_path() / "vypcomp_batch_test.manifest";
+	std::ofstream(path) << "a.vl\n\n  # comment\n\t dir/b.vl \r\n#c.vl\n   \nd.vl";
+	auto inputs = readManifest(path.string());
+	std::remove(path.string().c_str());
+
+	EXPECT_EQ(inputs, std::vector<std::string>({"a.vl", "dir/b.vl", "d.vl"}));
+	EXPECT_THROW(readManifest("/nonexistent/inputs.manifest"), std::runtime_error);
+}
+
+TEST_F(BatchTests, printsOutputInOrderOfInputs)
+{
+	delays = {{"a.vl", 3}, {"b.vl", 2}, {"c.vl", 1}};
+
+	EXPECT_EQ(compile({"a.vl", "b.vl", "c.vl"}, 3), 0);
+	EXPECT_EQ(out.str(),
+		"code of a.vl\na.vl: 0\n"
+		"code of b.vl\nb.vl: 0\n"
+		"code of c.vl\nc.vl: 0\n"
+	);
+	EXPECT_NE(err.str().find("compiled 3 files (0 failed)"), std::string::npos);
+}
+
+TEST_F(BatchTests, prefixesErrorsWithInput)
+{
+	codes = {{"b.vl", 12}};
+
+	EXPECT_EQ(compile({"a.vl", "b.vl"}, 2), 12);
+	EXPECT_EQ(err.str().find("b.vl: error of b.vl\nb.vl: second line\n"), 0);
+	EXPECT_EQ(err.str().find("a.vl:"), std::string::npos);
+	EXPECT_NE(out.str().find("a.vl: 0\n"), std::string::npos);
+	EXPECT_NE(out.str().find("b.vl: 12\n"), std::string::npos);
+}
+
+TEST_F(BatchTests, returnsExitCodeOfFirstFailedInput)
+{
+	codes = {{"b.vl", 14}, {"c.vl", 11}};
+	delays = {{"a.vl", 3}, {"b.vl", 2}, {"c.vl", 0}};
+
+	EXPECT_EQ(compile({"a.vl", "b.vl", "c.vl"}, 3), 14);
+	EXPECT_NE(out.str().find("a.vl: 0\n"), std::string::npos);
+	EXPECT_NE(out.str().find("b.vl: 14\n"), std::string::npos);
+	EXPECT_NE(out.str().find("c.vl: 11\n"), std::string::npos);
+	EXPECT_NE(err.str().find("compiled 3 files (2 failed)"), std::string::npos);
+
+	// single worker compiles the same
+	out.str("");
+	EXPECT_EQ(compile({"a.vl", "c.vl", "b.vl"}, 1), 11);
+}
@@ -0,0 +1,108 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "vypcomp/driver/cache.h"
+
+using namespace ::testing;
+
+using namespace vypcomp;
+
+namespace fs = std::filesystem;
+
+class CacheTests : public Test {
+protected:
+	void SetUp() override
+	{
+		directory = fs::temp_directory_path()/("vypcomp-cache-tests-"+std::to_string(std::random_device()()));
+	}
+
+	void TearDown() override
+	{
+		std::error_code ignored;
+		fs::remove_all(directory, ignored);
+	}
+
+	// sets time when the file was last used
+	static void setUsed(const fs::path& path, std::chrono::minutes ago)
+	{
+		fs::last_write_time(path, fs::file_time_type::clock::now() - ago);
+	}
+
+	fs::path directory;
+};
+
+TEST_F(CacheTests, keyIdentifiesSourceAndConfiguration)
+{
+	Cache cache(directory, 1024, "compiler");
+
+	auto key = cache.key("void main(void) {}");
+	EXPECT_EQ(key.size(), 32);
+	EXPECT_EQ(key.find_first_not_of("0123456789abcdef"), std::string::npos);
+	EXPECT_EQ(key, cache.key("void main(void) {}"));
+	EXPECT_NE(key, cache.key("void main(void) { }"));
+	EXPECT_NE(key, Cache(directory, 1024, "compiler -O").key("void main(void) {}"));
+	// configuration and source are not simply concatenated
+	EXPECT_NE(Cache(directory, 1024, "ab").key("c"), Cache(directory, 1024, "a").key("bc"));
+}
+
+TEST_F(CacheTests, loadsStoredCode)
+{
+	Cache cache(directory, 1024, "compiler");
+	auto key = cache.key("source");
+
+	EXPECT_FALSE(cache.load(key));
+	cache.store(key, "WRITES \"a\"\n");
+	EXPECT_EQ(cache.load(key), "WRITES \"a\"\n");
+
+	// entries are shared by all compilers using the directory
+	EXPECT_EQ(Cache(directory, 1024, "compiler").load(key), "WRITES \"a\"\n");
+
+	EXPECT_EQ(cache.hits(), 1);
+	EXPECT_EQ(cache.misses(), 1);
+	EXPECT_EQ(cache.bytes(), 11);
+}
+
+TEST_F(CacheTests, evictsLeastRecentlyUsedEntries)
+{
+	Cache cache(directory, 10, "compiler");
+	auto a = cache.key("a"), b = cache.key("b"), c = cache.key("c");
+
+	cache.store(a, "aaaa");
+	cache.store(b, "bbbb");
+	setUsed(directory/(a+".vc"), std::chrono::minutes(2));
+	setUsed(directory/(b+".vc"), std::chrono::minutes(1));
+
+	// a is now used more recently than b
+	EXPECT_TRUE(cache.load(a));
+	cache.store(c, "cccc");
+
+	EXPECT_TRUE(cache.load(a));
+	EXPECT_FALSE(cache.load(b));
+	EXPECT_TRUE(cache.load(c));
+	EXPECT_EQ(cache.bytes(), 8);
+}
+
+TEST_F(CacheTests, removesStaleTemporaries)
+{
+	Cache cache(directory, 1024, "compiler");
+	auto stale = directory/(cache.key("a")+".vc.tmp.1.1.0");
+	auto written = directory/(cache.key("b")+".vc.tmp.2.1.0");
+	std::ofstream(stale) << "partial";
+	std::ofstream(written) << "partial";
+	setUsed(stale, std::chrono::minutes(60));
+
+	cache.store(cache.key("c"), "code");
+
+	EXPECT_FALSE(fs::exists(stale));
+	EXPECT_TRUE(fs::exists(written));
+	EXPECT_EQ(cache.bytes(), 4);
+}
@@ -42,7 +42,11 @@ class VYPaTestCase(unittest.TestCase):
             super().run(result)
             return
 
-        run_command = ["java", "-jar", self.interpret_path, self.output_file_path]
+        # reference vypint is a jar, in-tree interpreter is run directly
+        if self.interpret_path.endswith(".jar"):
+            run_command = ["java", "-jar", self.interpret_path, self.output_file_path]
+        else:
+            run_command = [self.interpret_path, self.output_file_path]
         interpret_subproc = subprocess.Popen(run_command, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
         try:
             (stdout, stderr) = interpret_subproc.communicate(self.test_stdin, timeout=2)
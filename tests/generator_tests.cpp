@@ -8,12 +8,31 @@
 #include <sstream>
 
 #include <vypcomp/generator/generator.h>
+#include <vypcomp/parser/indexdriver.h>
+#include <vypcomp/parser/parser.h>
 
 using namespace ::testing;
 
 using namespace vypcomp;
 
-class GeneratorTests : public Test {};
+class GeneratorTests : public Test {
+protected:
+    // compiles the program and returns code generated for its main function
+    static std::string generate_main(const std::string& program, bool verbose, bool optimize)
+    {
+        std::stringstream index_input(program), input(program);
+        IndexParserDriver index_run;
+        index_run.parse(index_input);
+        ParserDriver parser(index_run.table());
+        parser.parse(input);
+
+        Generator gen(std::make_unique<std::ostringstream>(), verbose, optimize);
+        gen.generate(parser.table());
+        auto code = static_cast<const std::ostringstream&>(gen.get_output()).str();
+        auto main_start = code.find("LABEL vl_main");
+        return code.substr(main_start, code.find("RETURN", main_start) - main_start);
+    }
+};
 
 TEST_F(GeneratorTests, firstTest)
 {
@@ -21,3 +40,122 @@ TEST_F(GeneratorTests, firstTest)
     const auto& result_out = gen.get_output();
     ASSERT_NO_THROW(gen.generate(vypcomp::SymbolTable()));
 }
+
+TEST_F(GeneratorTests, optimizedLoopKeepsVariablesInRegisters)
+{
+    std::string program = R"(
+        void main(void) {
+            int i, sum;
+            i = 0; sum = 0;
+            while (i < 10) { sum = sum + i; i = i + 1; }
+            print(sum);
+        }
+    )";
+
+    auto optimized = generate_main(program, true, true);
+    EXPECT_NE(optimized.find("# $3 i\n"), std::string::npos);
+    EXPECT_NE(optimized.find("# $4 sum\n"), std::string::npos);
+    EXPECT_NE(optimized.find("ADDI $4, $4, $3\n"), std::string::npos);
+    EXPECT_EQ(optimized.find("[$SP-"), std::string::npos);
+
+    auto plain = generate_main(program, false, false);
+    EXPECT_NE(plain.find("[$SP-"), std::string::npos);
+}
+
+TEST_F(GeneratorTests, optimizedVariableLiveAcrossCallStaysOnStack)
+{
+    std::string program = R"(
+        int f(int a) { return a; }
+        void main(void) {
+            int x;
+            x = readInt();
+            x = x + f(x);
+            print(x);
+        }
+    )";
+
+    auto optimized = generate_main(program, true, true);
+    EXPECT_NE(optimized.find("# [$SP-0] x\n"), std::string::npos);
+    auto call = optimized.find("CALL [$SP], vl_f\n");
+    ASSERT_NE(call, std::string::npos);
+    EXPECT_NE(optimized.find("[$SP-0]", call), std::string::npos);
+}
+
+TEST_F(GeneratorTests, optimizedCallOfNotOverriddenMethodIsDirect)
+{
+    std::string program = R"(
+        class A : Object {
+            int f(void) { return 1; }
+            int g(void) { return 2; }
+        }
+        class B : A {
+            int g(void) { return 3; }
+        }
+        void main(void) {
+            A a;
+            a = new B;
+            print(a.f(), a.g());
+        }
+    )";
+
+    auto optimized = generate_main(program, false, true);
+    EXPECT_NE(optimized.find("CALL [$SP], vl_A_f\n"), std::string::npos);
+    EXPECT_NE(optimized.find("CALL [$SP], [$SP]\n"), std::string::npos);
+    EXPECT_EQ(optimized.find("vl_A_g"), std::string::npos);
+
+    auto plain = generate_main(program, false, false);
+    EXPECT_EQ(plain.find("vl_A_f"), std::string::npos);
+}
+
+TEST_F(GeneratorTests, optimizedBuiltinsAreExpandedAtCallSite)
+{
+    std::string program = R"(
+        void main(void) {
+            string s = readString();
+            print(length(s), readInt());
+        }
+    )";
+
+    auto optimized = generate_main(program, false, true);
+    EXPECT_NE(optimized.find("READS "), std::string::npos);
+    EXPECT_NE(optimized.find("GETSIZE "), std::string::npos);
+    EXPECT_NE(optimized.find("READI "), std::string::npos);
+    EXPECT_EQ(optimized.find("CALL"), std::string::npos);
+
+    auto plain = generate_main(program, false, false);
+    EXPECT_NE(plain.find("CALL [$SP], vl_length\n"), std::string::npos);
+}
+
+TEST_F(GeneratorTests, controlFlowLabelsArePerFunction)
+{
+    std::string program = R"(
+        int f(int a) { if (a < 0) { return 0; } else { return a; } }
+        void main(void) {
+            int i = 0;
+            while (i < f(3)) { i = i + 1; }
+            print(i);
+        }
+    )";
+
+    auto first = generate_main(program, false, false);
+    EXPECT_NE(first.find("LABEL while_cond_vl_main_0\n"), std::string::npos);
+    EXPECT_EQ(first.find("if_branch_"), std::string::npos);
+    // labels don't depend on functions generated before
+    EXPECT_EQ(generate_main(program, false, false), first);
+}
+
+TEST_F(GeneratorTests, temporariesOfStatementsShareStackSlots)
+{
+    std::string program = R"(
+        void main(void) {
+            int x = 1;
+            x = ((x + 1) * (x + 2) + 3) * 4 + 5;
+            x = x * x + x * x;
+            print(x);
+        }
+    )";
+
+    // x and 3 slots of the first assignment, which has the most temporaries live at once
+    auto code = generate_main(program, false, false);
+    EXPECT_NE(code.find("LABEL vl_main\nADDI $SP, $SP, 4\n"), std::string::npos);
+}
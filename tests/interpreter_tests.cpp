@@ -0,0 +1,345 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "vypcomp/generator/generator.h"
+#include "vypcomp/interpreter/interpreter.h"
+#include "vypcomp/interpreter/program.h"
+#include "vypcomp/optimizer/optimizer.h"
+#include "vypcomp/parser/indexdriver.h"
+#include "vypcomp/parser/parser.h"
+
+using namespace ::testing;
+
+using namespace vypcomp;
+using namespace vypcomp::vypcode;
+
+class InterpreterTests : public Test {
+protected:
+	// runs VYPcode and returns its output
+	static std::string run(const std::string& code, const std::string& input = "")
+	{
+		std::istringstream codeInput(code), programInput(input);
+		std::ostringstream output;
+		auto program = Program::load(codeInput);
+		Interpreter(program, programInput, output).run();
+		return output.str();
+	}
+
+	// compiles VYPlanguage program into VYPcode, optimized as by -O
+	static std::string compile(const std::string& source, bool optimize)
+	{
+		std::istringstream indexInput(source), parserInput(source);
+		IndexParserDriver index;
+		index.parse(indexInput);
+		ParserDriver parser(index.table());
+		parser.parse(parserInput);
+
+		auto table = parser.table();
+		if (optimize)
+			Optimizer().run(table);
+
+		Generator gen(std::make_unique<std::ostringstream>(), false, optimize);
+		gen.generate(table);
+		return static_cast<const std::ostringstream&>(gen.get_output()).str();
+	}
+
+	// compiles VYPlanguage program and returns output of its execution
+	static std::string compileAndRun(const std::string& source, bool optimize, const std::string& input = "")
+	{
+		return run(compile(source, optimize), input);
+	}
+};
+
+TEST_F(InterpreterTests, arithmeticAndJumps)
+{
+	std::string code = R"(
+		SET $1, 0 # i
+		SET $2, 0 # sum
+		LABEL loop
+		LTI $3, $1, 10
+		JUMPZ end, $3
+		ADDI $2, $2, $1
+		ADDI $1, $1, 1
+		JUMP loop
+		LABEL end
+		WRITEI $2
+		WRITES "\n"
+		MULF $4, 0x1.8p+1, 0x1p+1
+		WRITEF $4
+	)";
+
+	EXPECT_EQ("45\n0x1.8p2", run(code));
+}
+
+TEST_F(InterpreterTests, integerArithmeticWrapsAround)
+{
+	std::string code = R"(
+		SET $1, 9223372036854775807
+		ADDI $1, $1, 1
+		WRITEI $1
+		WRITES " "
+		DIVI $2, $1, -1
+		WRITEI $2
+		WRITES " "
+		SUBI $2, $1, 1
+		WRITEI $2
+		WRITES " "
+		MULI $2, $1, 2
+		WRITEI $2
+		WRITES " "
+		DIVI $2, -7, -1
+		WRITEI $2
+	)";
+
+	EXPECT_EQ("-9223372036854775808 -9223372036854775808 9223372036854775807 0 7", run(code));
+
+	std::string program = R"(
+		void main(void) {
+			int a = 9223372036854775807;
+			int m = 0 - 1;
+			a = a + 1;
+			print(a, " ");
+			a = a / m;
+			print(a, "\n");
+		}
+	)";
+	EXPECT_EQ("-9223372036854775808 -9223372036854775808\n", compileAndRun(program, false));
+	EXPECT_EQ("-9223372036854775808 -9223372036854775808\n", compileAndRun(program, true));
+}
+
+TEST_F(InterpreterTests, callsThroughStackAndLabelNames)
+{
+	std::string code = R"(
+		ADDI $SP, $SP, 1
+		CREATE $0, 1
+		SETWORD $0, 0, "greet"
+		SET [0], $0
+		CALL [$SP] main
+		JUMP END
+		LABEL greet
+		WRITES [$SP-1]
+		SET $1, [$SP]
+		SUBI $SP, $SP, 2
+		RETURN $1
+		LABEL main
+		ADDI $SP, $SP, 2
+		SET [$SP-1], "Hello, world!"
+		GETWORD $1, [0], 0
+		SET [$SP], $1
+		CALL [$SP], [$SP]
+		SET $1, [$SP]
+		SUBI $SP, $SP, 1
+		RETURN $1
+		LABEL END
+	)";
+
+	EXPECT_EQ("Hello, world!", run(code));
+}
+
+TEST_F(InterpreterTests, stringsAccessedByWords)
+{
+	std::string code = R"(
+		SET $1, "ab"
+		COPY $2, $1
+		RESIZE $2, 3
+		SETWORD $2, 2, "c"
+		GETSIZE $3, $2
+		WRITES $1
+		WRITES $2
+		WRITEI $3
+		CREATE $4, 2
+		SETWORD $4, 0, "x"
+		SETWORD $4, 1, "y"
+		WRITES $4
+	)";
+
+	EXPECT_EQ("ababc3xy", run(code));
+}
+
+TEST_F(InterpreterTests, readsInput)
+{
+	EXPECT_EQ("42name", run("READI $0\nREADS $1\nWRITEI $0\nWRITES $1\n", "42\nname"));
+}
+
+TEST_F(InterpreterTests, invalidChunkAccessIsRuntimeError)
+{
+	EXPECT_THROW(run("SETWORD 0, 0, 0\n"), RuntimeError);
+	EXPECT_THROW(run("DIVI $0, 1, 0\n"), RuntimeError);
+}
+
+TEST_F(InterpreterTests, invalidProgramIsLoadError)
+{
+	EXPECT_THROW(run("JUMP nowhere\n"), LoadError);
+	EXPECT_THROW(run("FOO $0\n"), LoadError);
+	EXPECT_THROW(run("SET 1, $0\n"), LoadError);
+}
+
+TEST_F(InterpreterTests, executesGeneratedCode)
+{
+	std::string program = R"(
+		class A : Object {
+			int x;
+			string name(void) { return "A"; }
+		}
+		class B : A {
+			string name(void) { return "B" + (string)(this.x); }
+		}
+		int fact(int n) {
+			if (n < 2) { return 1; } else { return n * fact(n - 1); }
+		}
+		void main(void) {
+			A a;
+			a = new B;
+			a.x = 7;
+			print(a.name(), " ", fact(readInt()), " ", subStr("Hello, world!", 2, 6), "\n");
+		}
+	)";
+
+	EXPECT_EQ("B7 720 llo, w\n", compileAndRun(program, false, "6"));
+	EXPECT_EQ("B7 720 llo, w\n", compileAndRun(program, true, "6"));
+}
+
+TEST_F(InterpreterTests, castsCheckClassIdRanges)
+{
+	std::string program = R"(
+		class A : Object {}
+		class B : A {}
+		class C : B {}
+		void main(void) {
+			Object o = new C;
+			B b = (B)o;
+			A a = (A)b;
+			print(a.getClass(), " ", ((C)a).getClass(), "\n");
+			a = new A;
+			b = (B)a;
+		}
+	)";
+
+	for (bool optimize: {false, true}) {
+		std::istringstream code(compile(program, optimize)), input;
+		std::ostringstream output;
+		auto compiled = Program::load(code);
+		Interpreter interpreter(compiled, input, output);
+		EXPECT_THROW(interpreter.run(), RuntimeError);
+		EXPECT_EQ("C C\n", output.str());
+	}
+}
+
+TEST_F(InterpreterTests, downcastToClassWithoutInstancesFails)
+{
+	std::string program = R"(
+		class A : Object {}
+		class B : A {}
+		void main(void) {
+			Object o = new Object;
+			B b = (B)o;
+			print("after\n");
+		}
+	)";
+
+	for (bool optimize: {false, true}) {
+		std::istringstream code(compile(program, optimize)), input;
+		std::ostringstream output;
+		auto compiled = Program::load(code);
+		Interpreter interpreter(compiled, input, output);
+		EXPECT_THROW(interpreter.run(), RuntimeError);
+		EXPECT_EQ("", output.str());
+	}
+}
+
+TEST_F(InterpreterTests, upcastsObjectOfClassWithoutInstances)
+{
+	std::string program = R"(
+		class C : Object { int k; }
+		void main(void) {
+			C c;
+			Object o = (Object)c;
+			if (o) { print("nonnull\n"); } else { print("null\n"); }
+		}
+	)";
+
+	EXPECT_EQ("null\n", compileAndRun(program, false));
+	EXPECT_EQ("null\n", compileAndRun(program, true));
+}
+
+TEST_F(InterpreterTests, methodCallOnNullFails)
+{
+	// methods are never overridden, so -O calls them without vtable lookup
+	std::string program = R"(
+		class A : Object {
+			void hi(void) { print("hi\n"); }
+		}
+		void main(void) {
+			A a;
+			Object o;
+			print("before\n");
+			if (readInt()) {
+				a.hi();
+			}
+			print(o.toString());
+			print("done\n");
+		}
+	)";
+
+	for (bool optimize: {false, true}) {
+		for (auto input: {"1\n", "0\n"}) {
+			std::istringstream code(compile(program, optimize)), programInput(input);
+			std::ostringstream output;
+			auto compiled = Program::load(code);
+			Interpreter interpreter(compiled, programInput, output);
+			EXPECT_THROW(interpreter.run(), RuntimeError);
+			EXPECT_EQ("before\n", output.str());
+		}
+	}
+}
+
+TEST_F(InterpreterTests, concatenatesAndSlicesStringsOfAnyLength)
+{
+	std::string program = R"(
+		void main(void) {
+			string s, e;
+			s = "abcdefghij";
+			print(s + e, "|", e + s, "|", e + e, "|", s + s, "|", "x" + s, "\n");
+			print(subStr(s, 1, 9), "|", subStr(s, 3, 4), "|", subStr(s, 7, 6), "|", subStr(s, 1, 0), "|", subStr(s, 0, 3), "\n");
+		}
+	)";
+
+	std::string expected = "abcdefghij|abcdefghij||abcdefghijabcdefghij|xabcdefghij\n"
+		"bcdefghij|defg|hijhhh||\n";
+	EXPECT_EQ(expected, compileAndRun(program, false));
+	EXPECT_EQ(expected, compileAndRun(program, true));
+}
+
+TEST_F(InterpreterTests, concatenatesChainsOfStringsAtOnce)
+{
+	std::string program = R"(
+		string wrap(string s) { return "<" + s + ">"; }
+		void main(void) {
+			string a, e, r;
+			int i;
+			a = readString();
+			r = a + e + "-" + "-" + a;
+			i = 0;
+			while (i < 3) {
+				r = r + (string)i + e + r;
+				i = i + 1;
+			}
+			print(r, "|", wrap(a + a + e) + e + wrap(e) + "|" + a, "\n");
+		}
+	)";
+
+	std::string expected = "ab--ab0ab--ab1ab--ab0ab--ab2ab--ab0ab--ab1ab--ab0ab--ab|<abab><>|ab\n";
+	EXPECT_EQ(expected, compileAndRun(program, false, "ab\n"));
+	EXPECT_EQ(expected, compileAndRun(program, true, "ab\n"));
+	EXPECT_NE(std::string::npos, compile(program, true).find("CALL [$SP], concatStr"));
+
+	// VYPcode has only registers $SP and $0-$7
+	std::istringstream code(compile(program, true));
+	EXPECT_LE(Program::load(code).registers(), 9u);
+}
@@ -0,0 +1,211 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "vypcomp/ir/arena.h"
+#include "vypcomp/ir/expression.h"
+#include "vypcomp/ir/name.h"
+#include "vypcomp/ir/name_map.h"
+
+using namespace ::testing;
+
+using namespace vypcomp;
+
+class IrTests : public Test {};
+
+namespace {
+
+struct Tracked {
+	Tracked(std::vector<int>& log, int id) : log(log), id(id) {}
+	~Tracked() { log.push_back(id); }
+
+	std::vector<int>& log;
+	int id;
+};
+
+}
+
+TEST_F(IrTests, arenaDestroysObjectsInReverseOrder)
+{
+	std::vector<int> log;
+	{
+		ir::Arena arena(64);
+		for (int i = 0; i < 10; i++)
+			arena.create<Tracked>(log, i);
+
+		ASSERT_EQ(arena.objects(), 10);
+		ASSERT_GT(arena.chunks(), 1);
+		ASSERT_TRUE(log.empty());
+	}
+
+	std::vector<int> expected = {9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+	ASSERT_EQ(log, expected);
+}
+
+TEST_F(IrTests, makePlacesNodesIntoCurrentArena)
+{
+	auto arena = std::make_shared<ir::Arena>();
+	ir::Expression::ValueType literal;
+	{
+		ir::Arena::Scope scope(arena.get());
+		literal = ir::make<ir::LiteralExpression>(ir::Literal(1ull));
+	}
+
+	ASSERT_EQ(arena->objects(), 1);
+	// Handle does not own node.
+	ASSERT_EQ(literal.use_count(), 0);
+	ASSERT_EQ(literal->to_string(), "1");
+}
+
+TEST_F(IrTests, makeWithoutArenaAllocatesOnHeap)
+{
+	auto literal = ir::make<ir::LiteralExpression>(ir::Literal(1ull));
+	ASSERT_EQ(literal.use_count(), 1);
+}
+
+TEST_F(IrTests, expressionKindDispatch)
+{
+	ir::Expression::ValueType literal = ir::make<ir::LiteralExpression>(ir::Literal(1ull));
+	ir::Expression::ValueType nullObject = ir::make<ir::NullObject>("Object");
+	ir::Expression::ValueType add = ir::make<ir::AddExpression>(literal, literal);
+
+	ASSERT_EQ(literal->kind(), ir::Expression::Kind::Literal);
+	ASSERT_EQ(nullObject->kind(), ir::Expression::Kind::NullObject);
+	ASSERT_EQ(add->kind(), ir::Expression::Kind::Add);
+
+	// Derived expressions are part of their base family.
+	ASSERT_TRUE(ir::is<ir::LiteralExpression>(nullObject));
+	ASSERT_FALSE(ir::is<ir::NullObject>(literal));
+	ASSERT_TRUE(ir::is<ir::BinaryOpExpression>(add));
+	ASSERT_FALSE(ir::is<ir::BinaryOpExpression>(literal));
+
+	ASSERT_EQ(ir::as<ir::BinaryOpExpression>(add)->getOp1(), literal);
+	ASSERT_EQ(ir::as<ir::FunctionExpression>(add), nullptr);
+	ASSERT_FALSE(ir::is<ir::LiteralExpression>(ir::Expression::ValueType()));
+}
+
+TEST_F(IrTests, instructionKindDispatch)
+{
+	ir::Instruction::Ptr decl = ir::make<ir::AllocaInstruction>(ir::Declaration{ir::PrimitiveDatatype::Int, "a"});
+	ir::Instruction::Ptr ret = ir::make<ir::Return>();
+
+	ASSERT_EQ(decl->kind(), ir::Instruction::Kind::Alloca);
+	ASSERT_EQ(ret->kind(), ir::Instruction::Kind::Return);
+	ASSERT_TRUE(ir::is<ir::AllocaInstruction>(decl));
+	ASSERT_EQ(ir::as<ir::Return>(decl), nullptr);
+	ASSERT_EQ(ir::as<ir::AllocaInstruction>(decl.get())->name(), "a");
+}
+
+TEST_F(IrTests, namesAreInterned)
+{
+	std::string dynamic = "inter";
+	dynamic += "nedName";
+
+	ir::Name first("internedName");
+	ir::Name second(dynamic);
+	ir::Name other("otherName");
+
+	ASSERT_EQ(first, second);
+	ASSERT_EQ(&first.str(), &second.str());
+	ASSERT_NE(first, other);
+	ASSERT_EQ(first, "internedName");
+	ASSERT_EQ(ir::Name(), "");
+	ASSERT_EQ(std::hash<ir::Name>()(first), std::hash<ir::Name>()(second));
+}
+
+TEST_F(IrTests, namesAreOrderedAlphabetically)
+{
+	ir::Name b("bName"), a("aName"), c("cName");
+
+	ASSERT_TRUE(a < b);
+	ASSERT_TRUE(b < c);
+	ASSERT_FALSE(b < a);
+	ASSERT_FALSE(a < a);
+}
+
+TEST_F(IrTests, nameMapFindsInsertedNames)
+{
+	ir::NameMap<int> map;
+	for (int i = 0; i < 100; i++) {
+		map["n" + std::to_string(i)] = i;
+	}
+	map["n7"] = -7;
+
+	ASSERT_EQ(map.size(), 100u);
+	ASSERT_EQ(*map.find("n42"), 42);
+	ASSERT_EQ(*map.find("n7"), -7);
+	ASSERT_EQ(map.find("n100"), nullptr);
+
+	int sum = 0;
+	map.forEach([&sum](const ir::Name&, int value) { sum += value; });
+	ASSERT_EQ(sum, 99 * 100 / 2 - 14);
+}
+
+TEST_F(IrTests, nameMapErasesNames)
+{
+	ir::NameMap<int> map;
+	for (int i = 0; i < 100; i++) {
+		map["n" + std::to_string(i)] = i;
+	}
+
+	for (int i = 0; i < 100; i += 3) {
+		ASSERT_TRUE(map.erase("n" + std::to_string(i)));
+	}
+	ASSERT_FALSE(map.erase("n0"));
+
+	ASSERT_EQ(map.size(), 66u);
+	for (int i = 0; i < 100; i++) {
+		auto value = map.find("n" + std::to_string(i));
+		if (i % 3 == 0) {
+			ASSERT_EQ(value, nullptr);
+		}
+		else {
+			ASSERT_NE(value, nullptr);
+			ASSERT_EQ(*value, i);
+		}
+	}
+}
+
+TEST_F(IrTests, resolvedMethodsFollowVisibilityAndInheritance)
+{
+	auto method = [](const std::string& name, const ir::Datatype& self) {
+		return ir::make<ir::Function>(ir::Function::Signature{
+			std::nullopt, name, {{self, "this"}}
+		});
+	};
+
+	auto base = ir::make<ir::Class>("Base", nullptr);
+	auto derived = ir::make<ir::Class>("Derived", base);
+	auto basePrivate = method("hidden", ir::Datatype("Base"));
+	auto baseProtected = method("shared", ir::Datatype("Base"));
+	auto basePublic = method("run", ir::Datatype("Base"));
+	auto derivedPrivate = method("own", ir::Datatype("Derived"));
+	base->add(basePrivate, ir::Class::Visibility::Private);
+	base->add(baseProtected, ir::Class::Visibility::Protected);
+	base->add(basePublic, ir::Class::Visibility::Public);
+	derived->add(derivedPrivate, ir::Class::Visibility::Private);
+
+	base->resolveMethods();
+	derived->resolveMethods();
+
+	using V = ir::Class::Visibility;
+	ASSERT_EQ(derived->getMethod("run"), basePublic);
+	ASSERT_EQ(derived->getMethod("shared"), nullptr);
+	ASSERT_EQ(derived->getMethod("shared", V::Protected), baseProtected);
+	ASSERT_EQ(derived->getMethod("own"), nullptr);
+	ASSERT_EQ(derived->getMethod("own", V::Private), derivedPrivate);
+	ASSERT_EQ(derived->getMethod("hidden", V::Private), nullptr);
+	ASSERT_EQ(base->getMethod("hidden", V::Private), basePrivate);
+	ASSERT_EQ(derived->getMethod("run", {ir::Datatype("Base")}), basePublic);
+	ASSERT_EQ(derived->getMethod("run", std::vector<ir::Datatype>{}), nullptr);
+
+	// Adding method to base invalidates table of derived class.
+	auto later = method("later", ir::Datatype("Base"));
+	base->add(later, ir::Class::Visibility::Public);
+	ASSERT_EQ(derived->getMethod("later"), later);
+}
@@ -0,0 +1,334 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "vypcomp/optimizer/optimizer.h"
+#include "vypcomp/optimizer/walk.h"
+#include "vypcomp/parser/indexdriver.h"
+#include "vypcomp/parser/parser.h"
+
+using namespace ::testing;
+
+using namespace vypcomp;
+
+class OptimizerTests : public Test {
+protected:
+	// parses and optimizes the program, returns its main function
+	ir::Function::Ptr optimizeMain(const std::string& program)
+	{
+		std::stringstream indexInput(program), input(program);
+		IndexParserDriver indexRun;
+		indexRun.parse(indexInput);
+		parser = std::make_unique<ParserDriver>(indexRun.table());
+		parser->parse(input);
+
+		table = parser->table();
+		Optimizer().run(table);
+		return std::get<ir::Function::Ptr>(table.get("main"));
+	}
+
+	// arguments of print calls in the top level block of function
+	static std::vector<ir::Expression::ValueType> printed(const ir::Function::Ptr& function)
+	{
+		std::vector<ir::Expression::ValueType> result;
+		for (auto instr = function->first()->first(); instr != nullptr; instr = instr->next()) {
+			auto assignment = ir::as<ir::Assignment>(instr);
+			if (!assignment || assignment->getAlloca())
+				continue;
+
+			auto call = ir::as<ir::FunctionExpression>(assignment->getExpr());
+			if (call && call->getFunction()->name() == "print") {
+				auto args = call->getArgs();
+				result.insert(result.end(), args.begin(), args.end());
+			}
+		}
+
+		return result;
+	}
+
+	// number of calls of function with given name in body of function
+	static std::size_t calls(const ir::Function::Ptr& function, const std::string& name)
+	{
+		std::size_t result = 0;
+		forEachInstruction(function->first(), [&](const ir::Instruction::Ptr& instr) {
+			forEachExpression(instr, [&](const ir::Expression::ValueType& expr) {
+				auto call = ir::as<ir::FunctionExpression>(expr);
+				result += call && call->getFunction() && call->getFunction()->name() == name;
+			});
+		});
+
+		return result;
+	}
+
+	static std::string literal(const ir::Expression::ValueType& expr)
+	{
+		auto lit = ir::as<ir::LiteralExpression>(expr);
+		return lit ? lit->getValue().vypcode_representation() : "not literal";
+	}
+
+	std::unique_ptr<ParserDriver> parser;
+	SymbolTable table;
+};
+
+TEST_F(OptimizerTests, foldsLiteralSubtrees)
+{
+	auto main = optimizeMain(R"(
+		void main(void) {
+			print(2 * 3 + 4, 7 / 2 - 10, 1.5 * 2.0, "ab" + "cd", (string)42, 3 < 4, !0, "a" == "b");
+		}
+	)");
+
+	auto args = printed(main);
+	ASSERT_EQ(args.size(), 8);
+	EXPECT_EQ(literal(args[0]), "10");
+	EXPECT_EQ(literal(args[1]), "-7");
+	EXPECT_EQ(literal(args[2]), "0x1.8p+1");
+	EXPECT_EQ(literal(args[3]), "\"abcd\"");
+	EXPECT_EQ(literal(args[4]), "\"42\"");
+	EXPECT_EQ(literal(args[5]), "1");
+	EXPECT_EQ(literal(args[6]), "1");
+	EXPECT_EQ(literal(args[7]), "0");
+}
+
+TEST_F(OptimizerTests, keepsExpressionsThatCannotBeFolded)
+{
+	auto main = optimizeMain(R"(
+		void main(void) {
+			print(1 / 0, "\n" == "a", 2147483647 + 1);
+		}
+	)");
+
+	auto args = printed(main);
+	ASSERT_EQ(args.size(), 3);
+	EXPECT_TRUE(ir::is<ir::DivideExpression>(args[0]));
+	EXPECT_TRUE(ir::is<ir::ComparisonExpression>(args[1]));
+	EXPECT_TRUE(ir::is<ir::AddExpression>(args[2]));
+}
+
+TEST_F(OptimizerTests, propagatesVariablesAssignedOnce)
+{
+	auto main = optimizeMain(R"(
+		void main(void) {
+			int a = 4;
+			int b = a * 2;
+			int c = 1;
+			c = c + 1;
+			print(a + b, c);
+		}
+	)");
+
+	auto args = printed(main);
+	ASSERT_EQ(args.size(), 2);
+	EXPECT_EQ(literal(args[0]), "12");
+	EXPECT_TRUE(ir::is<ir::SymbolExpression>(args[1]));
+}
+
+TEST_F(OptimizerTests, replacesBranchesWithConstantCondition)
+{
+	auto main = optimizeMain(R"(
+		void main(void) {
+			int debug = 0;
+			if (debug) { print("debug"); } else { print("release"); }
+			while (debug) { print("never"); }
+			if (debug == 0) { print("taken"); }
+		}
+	)");
+
+	for (auto instr = main->first()->first(); instr != nullptr; instr = instr->next()) {
+		EXPECT_FALSE(ir::is<ir::BranchInstruction>(instr));
+		EXPECT_FALSE(ir::is<ir::LoopInstruction>(instr));
+	}
+
+	auto args = printed(main);
+	ASSERT_EQ(args.size(), 2);
+	EXPECT_EQ(literal(args[0]), "\"release\"");
+	EXPECT_EQ(literal(args[1]), "\"taken\"");
+}
+
+TEST_F(OptimizerTests, doesNotPropagateArguments)
+{
+	optimizeMain(R"(
+		int f(int x) { return x + 1; }
+		void main(void) { print(f(readInt())); }
+	)");
+
+	auto f = std::get<ir::Function::Ptr>(table.get("f"));
+	auto ret = ir::as<ir::Return>(f->first()->first());
+	ASSERT_NE(ret, nullptr);
+	EXPECT_TRUE(ir::is<ir::AddExpression>(ret->getExpr()));
+}
+
+TEST_F(OptimizerTests, removesSymbolsUnreachableFromMain)
+{
+	optimizeMain(R"(
+		class Used : Object {
+			void called(void) { print("called"); }
+			void unused(void) { this.called(); }
+		}
+		class Derived : Used {
+			void called(void) { print("derived"); }
+		}
+		class Unused : Object {
+			void called(void) { return; }
+		}
+		void unusedFunction(void) { Unused u; u = new Unused; }
+		void main(void) {
+			Used u;
+			u = new Derived;
+			u.called();
+		}
+	)");
+
+	EXPECT_FALSE(table.has("unusedFunction"));
+	EXPECT_FALSE(table.has("Unused"));
+	EXPECT_FALSE(table.has("readInt"));
+	ASSERT_TRUE(table.has("Used"));
+	ASSERT_TRUE(table.has("Derived"));
+	ASSERT_TRUE(table.has("Object"));
+
+	auto used = std::get<ir::Class::Ptr>(table.get("Used"));
+	EXPECT_NE(used->getMethod("called"), nullptr);
+	EXPECT_EQ(used->getMethod("unused"), nullptr);
+	auto object = std::get<ir::Class::Ptr>(table.get("Object"));
+	EXPECT_EQ(object->getMethod("toString"), nullptr);
+}
+
+TEST_F(OptimizerTests, keepsClassesUsedOnlyAsCastTargets)
+{
+	optimizeMain(R"(
+		class A : Object {}
+		class B : A {}
+		void main(void) {
+			Object o = new Object;
+			B b = (B)o;
+		}
+	)");
+
+	EXPECT_TRUE(table.has("A"));
+	EXPECT_TRUE(table.has("B"));
+}
+
+TEST_F(OptimizerTests, removesDeadStoresAndCodeAfterReturn)
+{
+	optimizeMain(R"(
+		int g(void) { print("side effect"); return 1; }
+		int f(int x) {
+			int y = x * 2;
+			int unused = g();
+			y = x + 3;
+			return y;
+			print("unreachable");
+		}
+		void main(void) { print(f(1)); }
+	)");
+
+	auto f = std::get<ir::Function::Ptr>(table.get("f"));
+	std::vector<ir::Instruction::Ptr> instructions;
+	for (auto instr = f->first()->first(); instr != nullptr; instr = instr->next())
+		instructions.push_back(instr);
+
+	ASSERT_EQ(instructions.size(), 4);
+	auto y = ir::as<ir::AllocaInstruction>(instructions[0]);
+	ASSERT_NE(y, nullptr);
+	EXPECT_EQ(y->name(), "y");
+
+	// result of the call is discarded, but call stays
+	auto call = ir::as<ir::Assignment>(instructions[1]);
+	ASSERT_NE(call, nullptr);
+	EXPECT_EQ(call->getAlloca(), nullptr);
+	EXPECT_TRUE(ir::is<ir::FunctionExpression>(call->getExpr()));
+
+	auto store = ir::as<ir::Assignment>(instructions[2]);
+	ASSERT_NE(store, nullptr);
+	EXPECT_TRUE(ir::is<ir::AddExpression>(store->getExpr()));
+	EXPECT_TRUE(ir::is<ir::Return>(instructions[3]));
+}
+
+TEST_F(OptimizerTests, keepsStoresReadInLaterIterations)
+{
+	auto main = optimizeMain(R"(
+		void main(void) {
+			int i = 0;
+			int last = 0;
+			while (i < 3) {
+				print(last);
+				last = i;
+				i = i + 1;
+			}
+		}
+	)");
+
+	auto loop = ir::as<ir::LoopInstruction>(main->first()->last());
+	ASSERT_NE(loop, nullptr);
+	std::size_t stores = 0;
+	for (auto instr = loop->getBody()->first(); instr != nullptr; instr = instr->next()) {
+		if (auto assignment = ir::as<ir::Assignment>(instr))
+			stores += assignment->getAlloca() != nullptr;
+	}
+	EXPECT_EQ(stores, 2);
+}
+
+TEST_F(OptimizerTests, inlinesSmallNonRecursiveFunctions)
+{
+	auto main = optimizeMain(R"(
+		int sq(int v) { return v * v; }
+		int add(int a, int b) { int r = a + b; return r; }
+		int fact(int n) { if (n < 2) { return 1; } return n * fact(n - 1); }
+		void main(void) {
+			int x = readInt();
+			int y = add(x, 1);
+			print(sq(x), y, fact(x));
+		}
+	)");
+
+	EXPECT_FALSE(table.has("sq"));
+	EXPECT_FALSE(table.has("add"));
+	EXPECT_TRUE(table.has("fact"));
+	EXPECT_EQ(calls(main, "fact"), 1);
+
+	auto args = printed(main);
+	ASSERT_EQ(args.size(), 3);
+	EXPECT_TRUE(ir::is<ir::MultiplyExpression>(args[0]));
+}
+
+TEST_F(OptimizerTests, evaluatesInlinedArgumentsOnce)
+{
+	auto main = optimizeMain(R"(
+		int sq(int v) { return v * v; }
+		void main(void) {
+			int y = sq(readInt());
+			print(y, sq(readInt()));
+		}
+	)");
+
+	// only call nested in expression cannot be expanded
+	EXPECT_EQ(calls(main, "sq"), 1);
+	EXPECT_EQ(calls(main, "readInt"), 2);
+}
+
+TEST_F(OptimizerTests, flattensStringConcatenationChains)
+{
+	auto main = optimizeMain(R"(
+		void main(void) {
+			string a = readString(), b = readString();
+			print(a + b + "x" + "y" + a, a + b, "x" + (a + ("y" + b)));
+		}
+	)");
+
+	auto args = printed(main);
+	ASSERT_EQ(args.size(), 3);
+	auto chain = ir::as<ir::ConcatExpression>(args[0]);
+	ASSERT_NE(chain, nullptr);
+	ASSERT_EQ(chain->getOperands().size(), 4);
+	EXPECT_EQ(literal(chain->getOperands()[2]), "\"xy\"");
+	// single addition is left to addStr
+	EXPECT_TRUE(ir::is<ir::AddExpression>(args[1]));
+	auto nested = ir::as<ir::ConcatExpression>(args[2]);
+	ASSERT_NE(nested, nullptr);
+	EXPECT_EQ(nested->getOperands().size(), 4);
+}
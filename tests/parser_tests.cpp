@@ -7,6 +7,7 @@
 
 #include <sstream>
 
+#include "vypcomp/parser/indexdriver.h"
 #include "vypcomp/parser/parser.h"
 
 using namespace ::testing;
@@ -991,3 +992,42 @@ TEST_F(ParserTests, invalidBinaryOpExpressions)
 		ASSERT_THROW(parser.parseExpression(input, 0), IncompabilityError);
 	}
 }
+
+TEST_F(ParserTests, parseScannedTokensInBothRuns)
+{
+	std::stringstream input(R"(
+		int twice(int a) {
+			return helper(a) * 2;
+		}
+		int helper(int a) {
+			return a;
+		}
+		void main(void) {
+			print(twice(21));
+		}
+	)");
+
+	auto tokens = Scanner::scanAll(input);
+
+	IndexParserDriver index;
+	ASSERT_NO_THROW(index.parse(tokens));
+
+	ParserDriver parser(index.table());
+	ASSERT_NO_THROW(parser.parse(tokens));
+	ASSERT_TRUE(parser.table().has("main"));
+}
+
+TEST_F(ParserTests, parseScannedTokensLexicalError)
+{
+	std::stringstream input(R"(
+		void main(void) {
+			int a;
+			a = 12x;
+		}
+	)");
+
+	auto tokens = Scanner::scanAll(input);
+
+	IndexParserDriver index;
+	ASSERT_THROW(index.parse(tokens), LexicalError);
+}
@@ -0,0 +1,163 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "vypcomp/generator/peephole.h"
+
+using namespace ::testing;
+
+using namespace vypcomp;
+
+class PeepholeTests : public Test {
+protected:
+	// runs peephole over the code, returns printed result
+	std::string optimize(const std::string& text)
+	{
+		std::istringstream input(text);
+		auto code = Code::parse(input);
+		peephole.run(code);
+
+		std::ostringstream output;
+		code.print(output);
+		return output.str();
+	}
+
+	Peephole peephole;
+};
+
+TEST_F(PeepholeTests, parsesOperandsAndComments)
+{
+	std::istringstream input("WRITES \"a, \\\"b\\\" # c\" # comment\n");
+	auto code = Code::parse(input);
+
+	ASSERT_EQ(code.lines().size(), 1);
+	auto& line = code.lines()[0];
+	EXPECT_EQ(line.opcode, "WRITES");
+	ASSERT_EQ(line.operands.size(), 1);
+	EXPECT_EQ(line.operands[0], "\"a, \\\"b\\\" # c\"");
+	EXPECT_EQ(line.comment, "# comment");
+}
+
+TEST_F(PeepholeTests, printsEmittedInstructions)
+{
+	Code code;
+	code.label("vl_main");
+	code.emit("ADDI", "$SP", "$SP", std::size_t(2)).comment = "# locals";
+	code.emit("SETWORD", "$0", 1, "\"vl_A_f\"");
+	code.comment("done");
+	code.blank();
+
+	std::ostringstream output;
+	code.print(output);
+	EXPECT_EQ(output.str(),
+		"LABEL vl_main\n"
+		"ADDI $SP, $SP, 2 # locals\n"
+		"SETWORD $0, 1, \"vl_A_f\"\n"
+		"# done\n"
+		"\n"
+	);
+}
+
+TEST_F(PeepholeTests, forwardsCopiesToDeadRegisters)
+{
+	auto result = optimize(
+		"LABEL f\n"
+		"SET $1, [$SP-1]\n"
+		"SET $2, 3\n"
+		"ADDI $0, $1, $2\n"
+		"SET $1, [$SP]\n"
+		"RETURN $1\n"
+	);
+
+	EXPECT_NE(result.find("ADDI $0, [$SP-1], 3\n"), std::string::npos);
+	EXPECT_EQ(result.find("SET $2"), std::string::npos);
+	EXPECT_GE(peephole.hits(Peephole::Rule::CopyForwarding), 2);
+}
+
+TEST_F(PeepholeTests, keepsRegistersLiveAfterCopy)
+{
+	auto result = optimize(
+		"LABEL f\n"
+		"SET $3, [$SP-1]\n"
+		"WRITEI $3\n"
+		"WRITEI $3\n"
+		"SET $0, 0\n"
+		"SET $1, [$SP]\n"
+		"RETURN $1\n"
+	);
+
+	EXPECT_NE(result.find("SET $3, [$SP-1]\nWRITEI $3\nWRITEI $3\n"), std::string::npos);
+}
+
+TEST_F(PeepholeTests, threadsJumpsAndRemovesUnusedLabels)
+{
+	auto result = optimize(
+		"LABEL f\n"
+		"JUMPZ a, $0\n"
+		"JUMP c\n"
+		"WRITEI $0\n"
+		"LABEL a\n"
+		"JUMP b\n"
+		"LABEL b\n"
+		"JUMP d\n"
+		"LABEL c\n"
+		"WRITEI 1\n"
+		"LABEL d\n"
+		"SET $1, [$SP]\n"
+		"RETURN $1\n"
+	);
+
+	EXPECT_NE(result.find("JUMPZ d, $0\n"), std::string::npos);
+	EXPECT_EQ(result.find("WRITEI $0"), std::string::npos);
+	EXPECT_EQ(result.find("LABEL a"), std::string::npos);
+	EXPECT_EQ(result.find("LABEL b"), std::string::npos);
+	EXPECT_EQ(result.find("LABEL f"), std::string::npos);
+	EXPECT_NE(result.find("LABEL d\n"), std::string::npos);
+	EXPECT_GT(peephole.hits(Peephole::Rule::JumpThreading), 0);
+	EXPECT_GT(peephole.hits(Peephole::Rule::RedundantLabels), 0);
+}
+
+TEST_F(PeepholeTests, removesCodeReachableOnlyFromItself)
+{
+	auto result = optimize(
+		"CALL [$SP], f\n"
+		"JUMP end\n"
+		"LABEL unused\n"
+		"SET $2, 0\n"
+		"LABEL unused_loop\n"
+		"WRITEI $2\n"
+		"JUMP unused_loop\n"
+		"LABEL f\n"
+		"WRITEI 1\n"
+		"SET $1, [$SP]\n"
+		"RETURN $1\n"
+		"LABEL end\n"
+	);
+
+	EXPECT_EQ(result.find("unused"), std::string::npos);
+	EXPECT_EQ(result.find("WRITEI $2"), std::string::npos);
+	EXPECT_NE(result.find("LABEL f\nWRITEI 1\n"), std::string::npos);
+}
+
+TEST_F(PeepholeTests, mergesStackAdjustments)
+{
+	auto result = optimize(
+		"LABEL f\n"
+		"ADDI $SP, $SP, 2\n"
+		"ADDI $SP, $SP, 1\n"
+		"SUBI $SP, $SP, 1\n"
+		"CALL [$SP], f\n"
+		"SUBI $SP, $SP, 2\n"
+		"ADDI $SP, $SP, 2\n"
+		"SET $1, [$SP]\n"
+		"RETURN $1\n"
+	);
+
+	EXPECT_NE(result.find("ADDI $SP, $SP, 2\nCALL [$SP], f\nRETURN [$SP]\n"), std::string::npos);
+	EXPECT_EQ(peephole.hits(Peephole::Rule::StackAdjustMerging), 3);
+}
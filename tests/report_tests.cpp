@@ -0,0 +1,212 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <gtest/gtest.h>
+
+#include <cctype>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "vypcomp/driver/report.h"
+
+using namespace ::testing;
+
+using namespace vypcomp;
+
+class ReportTests : public Test {
+protected:
+	/**
+	 * Parsed JSON value, enough of JSON to read the report back.
+	 */
+	struct Json {
+		std::string string;
+		double number = 0.0;
+		bool isNumber = false;
+		std::vector<Json> items;
+		std::map<std::string, Json> fields;
+		bool isObject = false;
+	};
+
+	static Json parseJson(const std::string& text)
+	{
+		std::size_t pos = 0;
+		auto result = parseValue(text, pos);
+		skipSpace(text, pos);
+		EXPECT_EQ(pos, text.size()) << "trailing characters in " << text;
+		return result;
+	}
+
+	// measures phase allocating at least the given amount of bytes
+	static void measure(TimeReport& report, const std::string& name, std::size_t bytes)
+	{
+		TimeReport::Phase phase(&report, name);
+		auto data = std::make_unique<char[]>(bytes);
+		data[bytes-1] = 1;
+	}
+
+	static std::vector<std::string> fields(const std::string& line)
+	{
+		std::istringstream in(line);
+		return {std::istream_iterator<std::string>(in), std::istream_iterator<std::string>()};
+	}
+
+private:
+	static void skipSpace(const std::string& text, std::size_t& pos)
+	{
+		while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+			pos++;
+	}
+
+	static std::string parseString(const std::string& text, std::size_t& pos)
+	{
+		std::string result;
+		for (pos++; pos < text.size() && text[pos] != '"'; pos++) {
+			if (text[pos] == '\\')
+				pos++;
+			result += text[pos];
+		}
+		pos++;
+		return result;
+	}
+
+	static Json parseValue(const std::string& text, std::size_t& pos)
+	{
+		Json result;
+		skipSpace(text, pos);
+		if (pos >= text.size()) {
+			ADD_FAILURE() << "unexpected end of " << text;
+			return result;
+		}
+
+		if (text[pos] == '{') {
+			result.isObject = true;
+			for (pos++, skipSpace(text, pos); pos < text.size() && text[pos] != '}'; skipSpace(text, pos)) {
+				auto key = parseString(text, pos);
+				skipSpace(text, pos);
+				EXPECT_EQ(text[pos], ':');
+				result.fields[key] = parseValue(text, ++pos);
+				skipSpace(text, pos);
+				if (text[pos] == ',')
+					pos++;
+			}
+			pos++;
+		}
+		else if (text[pos] == '[') {
+			for (pos++, skipSpace(text, pos); pos < text.size() && text[pos] != ']'; skipSpace(text, pos)) {
+				result.items.push_back(parseValue(text, pos));
+				skipSpace(text, pos);
+				if (text[pos] == ',')
+					pos++;
+			}
+			pos++;
+		}
+		else if (text[pos] == '"') {
+			result.string = parseString(text, pos);
+		}
+		else {
+			std::size_t length = 0;
+			result.number = std::stod(text.substr(pos), &length);
+			result.isNumber = true;
+			pos += length;
+		}
+
+		return result;
+	}
+};
+
+TEST_F(ReportTests, measuresPhases)
+{
+	TimeReport report;
+	measure(report, "parse", 4096);
+	measure(report, "generate", 1024);
+	// phases without report are not measured
+	TimeReport::Phase(nullptr, "ignored");
+
+	ASSERT_EQ(report.phases().size(), 2);
+	auto& parse = report.phases()[0];
+	EXPECT_EQ(parse.name, "parse");
+	EXPECT_GE(parse.wall, 0.0);
+	EXPECT_GE(parse.cpu, 0.0);
+	EXPECT_GE(parse.allocations, 1);
+	EXPECT_GE(parse.allocatedBytes, 4096);
+#ifndef _WIN32
+	EXPECT_GT(parse.peakRss, 0);
+#endif
+
+	auto total = report.total();
+	EXPECT_EQ(total.name, "total");
+	EXPECT_EQ(total.allocations, report.phases()[0].allocations + report.phases()[1].allocations);
+	EXPECT_EQ(total.allocatedBytes, report.phases()[0].allocatedBytes + report.phases()[1].allocatedBytes);
+	EXPECT_EQ(total.peakRss, std::max(report.phases()[0].peakRss, report.phases()[1].peakRss));
+}
+
+TEST_F(ReportTests, printsTableOfPhasesAndTotal)
+{
+	TimeReport report;
+	measure(report, "parse", 4096);
+	measure(report, "generate", 1024);
+
+	std::ostringstream out;
+	report.print(out);
+	std::istringstream table(out.str());
+	std::vector<std::string> lines;
+	for (std::string line; std::getline(table, line);)
+		lines.push_back(line);
+
+	ASSERT_EQ(lines.size(), 4);
+	EXPECT_EQ(fields(lines[0]), std::vector<std::string>({"phase", "wall", "ms", "cpu", "ms", "allocs", "alloc", "KiB", "peak", "RSS", "KiB"}));
+	std::vector<std::string> names = {"parse", "generate", "total"};
+	std::vector<TimeReport::Measurement> measurements = {report.phases()[0], report.phases()[1], report.total()};
+	for (std::size_t i = 0; i < names.size(); i++) {
+		auto row = fields(lines[i+1]);
+		ASSERT_EQ(row.size(), 6) << lines[i+1];
+		EXPECT_EQ(row[0], names[i]);
+		// times are in milliseconds, allocated memory in KiB
+		EXPECT_NEAR(std::stod(row[1]), measurements[i].wall*1000, 0.001);
+		EXPECT_NEAR(std::stod(row[2]), measurements[i].cpu*1000, 0.001);
+		EXPECT_EQ(row[3], std::to_string(measurements[i].allocations));
+		EXPECT_EQ(row[4], std::to_string(measurements[i].allocatedBytes/1024));
+		EXPECT_EQ(row[5], std::to_string(measurements[i].peakRss));
+	}
+}
+
+TEST_F(ReportTests, printsJsonOfPhasesAndTotal)
+{
+	TimeReport report;
+	measure(report, "parse", 4096);
+	measure(report, "generate", 1024);
+
+	std::ostringstream out;
+	report.printJson(out);
+	auto json = parseJson(out.str());
+
+	ASSERT_TRUE(json.isObject);
+	EXPECT_EQ(json.fields.size(), 2);
+	ASSERT_TRUE(json.fields.count("phases"));
+	ASSERT_TRUE(json.fields.count("total"));
+
+	auto& phases = json.fields["phases"].items;
+	ASSERT_EQ(phases.size(), 2);
+	std::vector<std::pair<Json, TimeReport::Measurement>> objects = {
+		{phases[0], report.phases()[0]},
+		{phases[1], report.phases()[1]},
+		{json.fields["total"], report.total()}
+	};
+	for (auto& [object, measurement]: objects) {
+		ASSERT_TRUE(object.isObject);
+		EXPECT_EQ(object.fields.size(), 6);
+		EXPECT_EQ(object.fields["name"].string, measurement.name);
+		for (auto key: {"wall_s", "cpu_s", "allocations", "allocated_bytes", "peak_rss_kib"})
+			EXPECT_TRUE(object.fields[key].isNumber) << key;
+		EXPECT_NEAR(object.fields["wall_s"].number, measurement.wall, 0.000001);
+		EXPECT_NEAR(object.fields["cpu_s"].number, measurement.cpu, 0.000001);
+		EXPECT_EQ(object.fields["allocations"].number, measurement.allocations);
+		EXPECT_EQ(object.fields["allocated_bytes"].number, measurement.allocatedBytes);
+		EXPECT_EQ(object.fields["peak_rss_kib"].number, measurement.peakRss);
+	}
+}
@@ -5,7 +5,11 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
+#include <thread>
 
 #include "vypcomp/parser/parser.h"
 
@@ -143,9 +147,10 @@ TEST_F(ScannerTests, suppotIdentifiers)
 			)
 		);
 		ASSERT_EQ(token, Parser::token::IDENTIFIER);
-		ASSERT_TRUE(std::holds_alternative<std::string>(type.value));
-		std::string holds = std::get<std::string>(type.value);
+		ASSERT_TRUE(std::holds_alternative<ir::Name>(type.value));
+		ir::Name holds = std::get<ir::Name>(type.value);
 		ASSERT_EQ(id, holds);
+		ASSERT_EQ(ir::Name(id), holds);
 	}
 }
 
@@ -186,8 +191,8 @@ TEST_F(ScannerTests, suppotStringLiterals)
 			)
 		);
 		ASSERT_EQ(token, Parser::token::STRING_LITERAL);
-		ASSERT_TRUE(std::holds_alternative<std::string>(type.value));
-		std::string holds = std::get<std::string>(type.value);
+		ASSERT_TRUE(std::holds_alternative<std::string_view>(type.value));
+		std::string holds(std::get<std::string_view>(type.value));
 		ASSERT_EQ(exp, holds);
 	}
 }
@@ -243,6 +248,161 @@ TEST_F(ScannerTests, lexicalErrorInvalidLiterals)
 			LexicalError
 		);
 	}
+
+	for (std::string in: {"\"a\nb\"", "\"a\tb\"", "\"a\\qb\""}) {
+		std::stringstream str(in);
+		Scanner scanner(str);
+
+		ASSERT_THROW(scanner.yylex(&type, &location), LexicalError) << in;
+	}
+}
+
+TEST_F(ScannerTests, tokenBufferReplaysScannedTokens)
+{
+	std::stringstream input("int main ( void ) { return 42 ; }");
+	auto buffer = Scanner::scanAll(input);
+	ASSERT_EQ(buffer.error(), nullptr);
+
+	std::stringstream again("int main ( void ) { return 42 ; }");
+	Scanner direct(again);
+	Scanner replay(buffer, Parser::token::PROGRAM_START);
+
+	Parser::semantic_type type;
+	Parser::location_type location;
+	ASSERT_EQ(replay.yylex(&type, &location), Parser::token::PROGRAM_START);
+
+	int expected;
+	do {
+		expected = direct.yylex(&type, &location);
+		ASSERT_EQ(replay.yylex(&type, &location), expected);
+	}
+	while (expected != Parser::token::END);
+}
+
+TEST_F(ScannerTests, tokenBufferRethrowsLexicalError)
+{
+	std::stringstream input("int a = 123q;");
+	auto buffer = Scanner::scanAll(input);
+	ASSERT_NE(buffer.error(), nullptr);
+
+	Scanner replay(buffer, Parser::token::PROGRAM_START);
+	Parser::semantic_type type;
+	Parser::location_type location;
+	ASSERT_THROW(
+		while (replay.yylex(&type, &location) != Parser::token::END);,
+		LexicalError
+	);
+}
+
+TEST_F(ScannerTests, stringLiteralsOfMappedFileReferToIt)
+{
+	auto path = std::filesystem::temp_directory_path() / "vypcomp_scanner_test.vl";
+	std::ofstream(path) << "print(\"first\", \"tab\\there\");";
+	auto source = Source::map(path.string());
+	std::remove(path.string().c_str());
+
+	auto buffer = Scanner::scanAll(source);
+	ASSERT_EQ(buffer.error(), nullptr);
+
+	auto text = source->text();
+	std::vector<std::string_view> literals;
+	for (auto& entry: buffer.tokens()) {
+		if (entry.kind != Parser::token::STRING_LITERAL)
+			continue;
+
+		auto literal = std::get<std::string_view>(entry.value.value);
+		EXPECT_GE(literal.data(), text.data());
+		EXPECT_LE(literal.data() + literal.size(), text.data() + text.size());
+		literals.push_back(literal);
+	}
+
+	ASSERT_EQ(literals.size(), 2);
+	EXPECT_EQ(literals[0], "first");
+	EXPECT_EQ(literals[1], "tab\\there");
+}
+
+TEST_F(ScannerTests, lexerInputProvidesSourceInChunks)
+{
+	// exposes input of flex
+	struct InputScanner : Scanner {
+		using Scanner::Scanner;
+		using Scanner::LexerInput;
+	};
+
+	std::string text(20000, 'a');
+	for (std::size_t i = 0; i < text.size(); i++)
+		text[i] = static_cast<char>('a' + i % 26);
+
+	for (int chunk: {1, 7, 8192, 16384, 40000}) {
+		InputScanner scanner(Source::copy(text));
+		std::string read;
+		std::vector<char> buffer(chunk);
+		for (int size; (size = scanner.LexerInput(buffer.data(), chunk)) > 0;) {
+			ASSERT_LE(size, chunk);
+			read.append(buffer.data(), size);
+		}
+		EXPECT_EQ(read, text);
+		EXPECT_EQ(scanner.LexerInput(buffer.data(), chunk), 0);
+	}
+}
+
+TEST_F(ScannerTests, stringLiteralsSpanningInputChunks)
+{
+	// Flex refills its buffer every few kilobytes, literals of different
+	// lengths start and end at all positions relative to the refills.
+	std::ostringstream program;
+	std::vector<std::string> expected;
+	for (int i = 0; i < 3000; i++) {
+		std::string literal(i % 37, 'x');
+		literal += "\\t\\\"" + std::to_string(i) + "\\x00002a";
+		expected.push_back(literal);
+		program << "// comment with \"quotes\"\n\"" << literal << "\" /* \"not\" */ ;\n";
+	}
+
+	std::istringstream input(program.str());
+	auto buffer = Scanner::scanAll(input);
+	ASSERT_EQ(buffer.error(), nullptr);
+
+	std::vector<std::string> literals;
+	for (auto& entry: buffer.tokens()) {
+		if (entry.kind == Parser::token::STRING_LITERAL)
+			literals.emplace_back(std::get<std::string_view>(entry.value.value));
+	}
+	EXPECT_EQ(literals, expected);
+}
+
+TEST_F(ScannerTests, scannersOnOtherThreadsDoNotShareLiterals)
+{
+	// batch mode scans inputs on worker threads
+	std::vector<std::vector<std::string>> literals(4);
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < literals.size(); i++) {
+		threads.emplace_back([i, &literals]() {
+			std::ostringstream program;
+			for (int k = 0; k < 1000; k++)
+				program << "\"" << i << " lit\\n" << k << "\" ";
+
+			std::istringstream input(program.str());
+			auto buffer = Scanner::scanAll(input);
+			for (auto& entry: buffer.tokens()) {
+				if (entry.kind == Parser::token::STRING_LITERAL)
+					literals[i].emplace_back(std::get<std::string_view>(entry.value.value));
+			}
+		});
+	}
+	for (auto& thread: threads)
+		thread.join();
+
+	for (std::size_t i = 0; i < literals.size(); i++) {
+		ASSERT_EQ(literals[i].size(), 1000);
+		for (int k = 0; k < 1000; k++)
+			ASSERT_EQ(literals[i][k], std::to_string(i) + " lit\\n" + std::to_string(k));
+	}
+}
+
+TEST_F(ScannerTests, mappingMissingFileFails)
+{
+	ASSERT_THROW(Source::map("/nonexistent/input.vl"), std::runtime_error);
 }
 
 // TODO:
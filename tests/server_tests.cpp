@@ -0,0 +1,230 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <gtest/gtest.h>
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "vypcomp/driver/server.h"
+
+using namespace ::testing;
+
+using namespace vypcomp;
+
+class ServerTests : public Test {
+protected:
+	void SetUp() override
+	{
+		path = (std::filesystem::temp_directory_path()/("vypcomp-server-"+std::to_string(std::random_device()()))).string();
+	}
+
+	void TearDown() override
+	{
+		if (!server)
+			return;
+
+		server->stop();
+		runner.join();
+		server.reset();
+	}
+
+	void start(std::size_t threads = 0, Server::Exhausted exhausted = nullptr)
+	{
+		// fake compiler, sources starting with "error" fail and
+		// sources starting with "sleep" take a while
+		server = std::make_unique<Server>(path, [this](const std::string& source, std::ostream& code, std::ostream& errors) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				received = source;
+				served++;
+				maxActive = std::max(maxActive, ++active);
+			}
+			if (source.rfind("sleep", 0) == 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				active--;
+			}
+
+			code << "WRITES \"" << source.size() << "\" # " << getpid() << "\n";
+			if (source.rfind("error", 0) != 0)
+				return 0;
+
+			errors << "syntax error: " << source << "\n";
+			return 12;
+		}, threads, std::move(exhausted));
+		runner = std::thread([this]() { server->run(); });
+	}
+
+	// connects to the server, sends source in parts and reads the whole reply
+	std::string request(const std::vector<std::string>& parts)
+	{
+		int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+		sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+		std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path)-1);
+		if (connection < 0 || connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+			ADD_FAILURE() << "unable to connect to " << path;
+			return "";
+		}
+
+		for (auto& part: parts) {
+			for (std::size_t sent = 0; sent < part.size();) {
+				auto written = send(connection, part.data()+sent, part.size()-sent, 0);
+				if (written <= 0)
+					break;
+				sent += written;
+			}
+			// server must wait for the end of the source
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		// end of the source
+		shutdown(connection, SHUT_WR);
+
+		std::string reply;
+		char buffer[4096];
+		for (ssize_t size; (size = recv(connection, buffer, sizeof(buffer), 0)) > 0;)
+			reply.append(buffer, size);
+		close(connection);
+		return reply;
+	}
+
+	std::string lastSource()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return received;
+	}
+
+	// sends requests from concurrent clients
+	std::vector<std::string> requestConcurrently(const std::vector<std::string>& sources)
+	{
+		std::vector<std::string> replies(sources.size());
+		std::vector<std::thread> clients;
+		for (std::size_t i = 0; i < sources.size(); i++) {
+			clients.emplace_back([this, i, &sources, &replies]() {
+				replies[i] = request({sources[i]});
+			});
+		}
+		for (auto& client: clients)
+			client.join();
+		return replies;
+	}
+
+	static std::string code(std::size_t size)
+	{
+		return "WRITES \"" + std::to_string(size) + "\" # " + std::to_string(getpid()) + "\n";
+	}
+
+	// process that served the request
+	static std::string worker(const std::string& reply)
+	{
+		return reply.substr(reply.find('#'));
+	}
+
+	std::string path;
+	std::mutex mutex;
+	// source of the last request
+	std::string received;
+	std::size_t served = 0;
+	std::size_t active = 0;
+	std::size_t maxActive = 0;
+	std::unique_ptr<Server> server;
+	std::thread runner;
+};
+
+TEST_F(ServerTests, repliesWithExitCodeAndCode)
+{
+	start();
+	EXPECT_EQ(request({"void main(void) {}"}), "0\n" + code(18));
+	EXPECT_EQ(lastSource(), "void main(void) {}");
+}
+
+TEST_F(ServerTests, repliesWithExitCodeAndErrorOnFailure)
+{
+	start();
+	EXPECT_EQ(request({"error here"}), "12\nsyntax error: error here\n");
+}
+
+TEST_F(ServerTests, sourceEndsWhenClientShutsDownSending)
+{
+	start();
+	std::string large(200*1024, 'x');
+	EXPECT_EQ(request({"void ", "main", large}), "0\n" + code(large.size()+9));
+	EXPECT_EQ(lastSource(), "void main" + large);
+
+	EXPECT_EQ(request({}), "0\n" + code(0));
+	EXPECT_EQ(lastSource(), "");
+}
+
+TEST_F(ServerTests, servesConnectionsConcurrently)
+{
+	start(4);
+	auto replies = requestConcurrently({"error 0", "error 1", "error 2", "error 3"});
+
+	for (std::size_t i = 0; i < replies.size(); i++)
+		EXPECT_EQ(replies[i], "12\nsyntax error: error " + std::to_string(i) + "\n");
+}
+
+TEST_F(ServerTests, servesAtMostGivenNumberOfConnectionsAtOnce)
+{
+	start(2);
+	auto replies = requestConcurrently(std::vector<std::string>(6, "sleep"));
+
+	for (auto& reply: replies)
+		EXPECT_EQ(reply, "0\n" + code(5));
+	EXPECT_EQ(served, 6);
+	EXPECT_LE(maxActive, 2);
+}
+
+TEST_F(ServerTests, stopWaitsForAcceptedConnections)
+{
+	start();
+	std::string reply;
+	std::thread client([this, &reply]() { reply = request({"sleep"}); });
+	while (lastSource().empty())
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	server->stop();
+	runner.join();
+	server.reset();
+	client.join();
+	EXPECT_EQ(reply, "0\n" + code(5));
+	EXPECT_EQ(active, 0);
+}
+
+TEST_F(ServerTests, replacesExhaustedWorkerProcess)
+{
+	// served connections are counted by the worker process
+	start(2, [this]() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return served >= 2;
+	});
+
+	auto first = request({"a"}), second = request({"b"}), third = request({"c"});
+	ASSERT_NE(first.find('#'), std::string::npos);
+	ASSERT_NE(third.find('#'), std::string::npos);
+	EXPECT_EQ(worker(first), worker(second));
+	EXPECT_NE(worker(first), worker(third));
+	EXPECT_NE(worker(first), worker(code(0)));
+	EXPECT_EQ(served, 0);
+
+	auto replies = requestConcurrently({"error 0", "error 1", "error 2"});
+	for (std::size_t i = 0; i < replies.size(); i++)
+		EXPECT_EQ(replies[i], "12\nsyntax error: error " + std::to_string(i) + "\n");
+}
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * VYPa compiler project.
+ * Authors: Peter Kubov (xkubov06), Richard Micka (xmicka11)
+ */
+
+#include <gtest/gtest.h>
+
+#include "vypcomp/parser/symbol_table.h"
+
+using namespace ::testing;
+
+using namespace vypcomp;
+
+class SymbolTableTests : public Test {
+protected:
+	static ir::AllocaInstruction::Ptr variable(const std::string& name)
+	{
+		return ir::make<ir::AllocaInstruction>(ir::Declaration{ir::PrimitiveDatatype::Int, name});
+	}
+
+	static ir::Function::Ptr function(const std::string& name)
+	{
+		return ir::make<ir::Function>(ir::Function::Signature{std::nullopt, name, {}});
+	}
+
+	static ir::AllocaInstruction::Ptr alloca(const SymbolTable::Symbol* symbol)
+	{
+		return symbol ? std::get<ir::AllocaInstruction::Ptr>(*symbol) : nullptr;
+	}
+};
+
+TEST_F(SymbolTableTests, dataIsSortedByName)
+{
+	SymbolTable table(true);
+	for (auto name: {"main", "b", "zz", "a", "Object"}) {
+		table.insert({name, function(name)});
+	}
+
+	std::vector<std::string> names;
+	for (auto& [key, _]: table.data()) {
+		names.push_back(key);
+	}
+
+	ASSERT_EQ(names, std::vector<std::string>({"Object", "a", "b", "main", "zz"}));
+}
+
+TEST_F(SymbolTableTests, tableWithoutFunctionsRejectsThem)
+{
+	SymbolTable table;
+
+	ASSERT_FALSE(table.insert({"f", function("f")}));
+	ASSERT_TRUE(table.insert({"a", variable("a")}));
+	ASSERT_FALSE(table.has("f"));
+	ASSERT_TRUE(table.has("a"));
+	ASSERT_THROW(table.get("f"), std::runtime_error);
+}
+
+TEST_F(SymbolTableTests, tableGrowsBeyondInitialCapacity)
+{
+	SymbolTable table;
+	for (int i = 0; i < 1000; i++) {
+		table.insert({"v" + std::to_string(i), variable("v" + std::to_string(i))});
+	}
+
+	ASSERT_EQ(table.data().size(), 1000u);
+	for (int i = 0; i < 1000; i++) {
+		auto name = "v" + std::to_string(i);
+		ASSERT_EQ(alloca(table.find(name))->name(), name);
+	}
+}
+
+TEST_F(SymbolTableTests, innerScopeShadowsAndPopRestores)
+{
+	auto global = variable("a");
+	auto inner = variable("a");
+	auto innermost = variable("a");
+
+	SymbolTable table(true);
+	table.insert({"a", global});
+	ScopedSymbolTable scopes(table);
+
+	scopes.push();
+	ASSERT_EQ(alloca(scopes.find("a")), global);
+	ASSERT_EQ(scopes.findCurrent("a"), nullptr);
+
+	scopes.insert({"a", inner});
+	scopes.insert({"b", variable("b")});
+	scopes.push();
+	scopes.insert({"a", innermost});
+	ASSERT_EQ(scopes.depth(), 2u);
+	ASSERT_EQ(alloca(scopes.find("a")), innermost);
+	ASSERT_EQ(alloca(scopes.findGlobal("a")), global);
+
+	scopes.pop();
+	ASSERT_EQ(alloca(scopes.find("a")), inner);
+	ASSERT_EQ(alloca(scopes.findCurrent("a")), inner);
+
+	scopes.pop();
+	ASSERT_EQ(alloca(scopes.find("a")), global);
+	ASSERT_EQ(scopes.find("b"), nullptr);
+	ASSERT_THROW(scopes.pop(), std::runtime_error);
+}
+
+TEST_F(SymbolTableTests, globalScopeInsertsGoToGlobalTable)
+{
+	ScopedSymbolTable scopes(SymbolTable(true));
+	scopes.insert({"main", function("main")});
+	scopes.push();
+	ASSERT_FALSE(scopes.insert({"f", function("f")}));
+	scopes.insert({"local", variable("local")});
+
+	ASSERT_TRUE(scopes.global().has("main"));
+	ASSERT_FALSE(scopes.global().has("local"));
+	ASSERT_EQ(scopes.find("f"), nullptr);
+}